@@ -34,13 +34,24 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "LittleFS.h"
+#include <memory>
 
+#include "ticker_state.h"
 #include "display_handler.h"
 #include "api_handler.h"
+#include "price_table.h"
+#include "history_store.h"
 #include "led_handler.h"
 #include "button_handler.h"
 #include "websocket_handler.h"
+#include "asset_handler.h"
+#include "symbol_index.h"
+#include "boot_store.h"
 #include "wifi_handler.h"
+#include "power_scheduler.h"
+#include "poll_scheduler.h"
+#include "benchmark.h"
+#include "telemetry.h"
 
 // Network Credentials
 #define ssid "YOUR_SSID"
@@ -56,95 +67,497 @@
 #define SCREEN_HEIGHT 32
 #define OLED_ADDR 0x3C
 
-// Available cryptocurrencies
-const int NUM_CRYPTOCURRENCIES = 4;
-const String CRYPTOCURRENCIES[NUM_CRYPTOCURRENCIES] = {"DOGE", "BTC", "LTC", "XMR"};
-int currentCryptoIndex = 0;
+// Available cryptocurrencies and fiat currencies are listed in coin_registry.h
 
-// Available fiat currencies
-const int NUM_FIAT_CURRENCIES = 4;
-const String FIAT_CURRENCIES[NUM_FIAT_CURRENCIES] = {"USD", "EUR", "GBP", "RUB"};
-int currentFiatIndex = 0;
+// Shown pair, splash and view flags, shared by every handler
+TickerStateStore tickerState("DOGE", "USD");
 
 // Global variables
-String currentCrypto = "DOGE";
-String currentCurrency = "USD";
 unsigned long previousFetch = 0;
-const long fetchInterval = 30000;
-bool isPreviewMode = false;
+const unsigned long priceMaxAge = 90000;  // Cached prices older than this show as stale
 unsigned long previewStartTime = 0;
 const unsigned long PREVIEW_DURATION = 2000;
 
-// Splash state for bootup
-bool isBootSplash = true;
+// Time to the next fetch, from price movement and server feedback
+PollScheduler pollScheduler;
+
+// Loop timing, reported once per fetch
+unsigned long loopMaxMicros = 0;
+
+// Runtime counters served on /telemetry and pushed to web clients
+Telemetry telemetry;
+const unsigned long TELEMETRY_PUSH_INTERVAL = 10000;
+unsigned long previousTelemetryPush = 0;
+
+// Boot fetch is started once while the boot splash is up
 bool splashFetchDone = false;
-bool isSplashActive = true;
+
+// Boot timing, logged when the first price arrives
+unsigned long firstPriceAt = 0;
 
 // Create display instance
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
+// Latest prices for every configured pair, read back on coin switches
+PriceTable<COIN_COUNT, FIAT_COUNT> priceTable;
+
+// Recent price history per pair for the sparkline and chart view
+SparklineStore<COIN_COUNT, FIAT_COUNT> sparklines;
+
+// Persistent log of the shown pair, served to the web UI
+HistoryStore historyStore;
+const int HISTORY_QUERY_POINTS = 200;  // Long ranges are thinned to about this many records
+
+// Access point, pair and last price for the next boot
+BootStore bootStore;
+
 // Create handlers
 DisplayHandler displayHandler(&display);
 LedHandler ledHandler(ONBOARDLED, posLed, negLed, infoLed);
-ApiHandler apiHandler(&displayHandler);
+ApiHandler apiHandler(&displayHandler, &tickerState);
 ButtonHandler buttonHandler;
 WebSocketHandler webSocketHandler;
+AssetHandler assetHandler;
+SymbolIndex symbolIndex;
+WiFiHandler wifiHandler(ssid, password, &displayHandler, &ledHandler, &bootStore);
+PowerScheduler powerScheduler(&buttonHandler);
+BenchmarkHandler benchmarkHandler(&displayHandler, &webSocketHandler, &telemetry, &apiHandler, &tickerState);
 
 // Create AsyncWebServer object on port 80
 AsyncWebServer server(80);
+WebActivity webActivity;
 
 // Button callbacks
 void onShortPress() {
     // Calculate next crypto index but don't change current yet
-    int nextCryptoIndex = (currentCryptoIndex + 1) % NUM_CRYPTOCURRENCIES;
-    String nextCrypto = CRYPTOCURRENCIES[nextCryptoIndex];
+    int nextCryptoIndex = (tickerState.get().cryptoIndex + 1) % COIN_COUNT;
     
     // Show preview
-    displayHandler.showCoinSplash(nextCrypto);
+    displayHandler.showCoinSplash(coinInfo(nextCryptoIndex).name);
     
     // Set preview mode
-    isPreviewMode = true;
+    tickerState.setPreviewMode(true);
     previewStartTime = millis();
     
     // Visual feedback
     ledHandler.flashInfo(1);
     // Set splash active for new coin
-    isSplashActive = true;
+    tickerState.setSplashActive(true);
 }
 
 void onLongPress() {
-    // Only allow currency changes for BTC
-    if (currentCrypto != "BTC") {
+    const TickerState& state = tickerState.get();
+
+    // Only coins with more than one pair in the registry change currency
+    int nextFiatIndex = -1;
+    if (state.cryptoIndex >= 0) {
+        int fromFiat = state.fiatIndex >= 0 ? state.fiatIndex : FIAT_COUNT - 1;
+        nextFiatIndex = nextPairFiat(state.cryptoIndex, fromFiat);
+    }
+    if (nextFiatIndex < 0 || nextFiatIndex == state.fiatIndex) {
         // Visual feedback for denied action
         ledHandler.flashInfo(3); // Flash 3 times to indicate invalid action
         return;
-      }
-
-    // Cycle to next fiat currency
-    currentFiatIndex = (currentFiatIndex + 1) % NUM_FIAT_CURRENCIES;
-    currentCurrency = FIAT_CURRENCIES[currentFiatIndex];
-    
-    // Force immediate API update
-        previousFetch = 0;
+    }
 
-    // Notify web clients
-    String states = webSocketHandler.getCurrentStates();
-    webSocketHandler.notifyClients(states);
+    // Cycle to next fiat currency, listeners redraw and notify web clients
+    tickerState.setPair(state.crypto, fiatInfo(nextFiatIndex).name, state.cryptoIndex, nextFiatIndex);
     
     // Visual feedback
     ledHandler.flashPos(1);
 }
 
+void onVeryLongPress() {
+    // Toggle between the price screen and the full-screen chart
+    tickerState.setChartView(!tickerState.get().chartView);
+
+    // Visual feedback
+    ledHandler.flashInfo(1);
+}
+
+// WebSocket callback, a web client picked a new pair
+void onWebStateChange(const String& crypto, const String& currency) {
+    tickerState.setPair(crypto.c_str(), currency.c_str(), coinByName(crypto.c_str()), fiatByName(currency.c_str()));
+}
+
+// State listeners, called once per loop() pass with everything that changed.
+// The trend LED belongs to the old pair until the new one has a price.
+void onStateLeds(const TickerState& state, uint8_t changes) {
+    if (changes & STATE_CHANGE_PAIR) {
+        ledHandler.allOff();
+    }
+}
+
+void onStateDisplay(const TickerState& state, uint8_t changes) {
+    if (changes & STATE_CHANGE_PAIR) {
+        if (!showCachedPrice()) {
+            tickerState.setSplashActive(true);
+        }
+    } else if (changes & STATE_CHANGE_VIEW) {
+        redrawPrice();
+    }
+}
+
+// Fetch right away when the new pair has no fresh cached price
+void onStateFetch(const TickerState& state, uint8_t changes) {
+    if (!(changes & STATE_CHANGE_PAIR)) return;
+
+    Price price;
+    float change;
+    unsigned long age;
+    pollScheduler.resetBackoff();
+    if (!priceTable.peek(state.cryptoIndex, state.fiatIndex, price, change, age) || age > priceMaxAge) {
+        previousFetch = 0;
+    }
+}
+
+void onStateWebSocket(const TickerState& state, uint8_t changes) {
+    if (changes & (STATE_CHANGE_PAIR | STATE_CHANGE_VIEW)) {
+        webSocketHandler.sendState();
+    }
+}
+
+// The next boot starts on the pair picked last
+void onStateBoot(const TickerState& state, uint8_t changes) {
+    if (changes & STATE_CHANGE_PAIR) {
+        bootStore.savePair(state.crypto, state.fiat);
+    }
+}
+
+void showPrice(const Price& price, float change, bool stale) {
+    const TickerState& state = tickerState.get();
+    SparklineBuffer* history = sparklines.get(state.cryptoIndex, state.fiatIndex);
+    if (state.chartView) {
+        displayHandler.showChart(state.crypto, state.fiat, price, history);
+    } else {
+        displayHandler.updatePrice(state.crypto, state.fiat, price, change, stale, history);
+    }
+    webSocketHandler.sendPrice(price, change, stale);
+    ledHandler.updateLed(change);
+}
+
 // API callback
-void onPriceUpdate(const String& price, float change) {
-    if (isBootSplash) {
-        isBootSplash = false; // Hide splash after first price update
-        splashFetchDone = false; // Reset for next splash event
+void onPriceUpdate(const Price& price, float change) {
+    const TickerState& state = tickerState.get();
+
+    // A fetch started before a pair change must not land on the new pair
+    char shownPair[2 * STATE_SYMBOL_SIZE];
+    snprintf(shownPair, sizeof(shownPair), "%s%s", state.crypto, state.fiat);
+    if (strcasecmp(shownPair, apiHandler.getPair()) != 0) return;
+
+    priceTable.store(state.cryptoIndex, state.fiatIndex, price, change);
+    SparklineBuffer* history = sparklines.get(state.cryptoIndex, state.fiatIndex);
+    if (history != nullptr) {
+        history->add(price, millis());
+    }
+    if (state.cryptoIndex >= 0 && state.fiatIndex >= 0) {
+        historyStore.append(pairCode(state.cryptoIndex, state.fiatIndex), price, change);
+    }
+    bootStore.savePair(state.crypto, state.fiat);
+    bootStore.savePrice(price, change);
+    pollScheduler.onPrice(price.toDouble(), millis());
+    showPrice(price, change, false);
+
+    if (firstPriceAt == 0) {
+        firstPriceAt = millis();
+        Serial.printf("First price %lu ms after boot, Wi-Fi up at %lu ms (%s)\n", firstPriceAt,
+                      wifiHandler.getConnectedAt(), wifiHandler.wasFastJoin() ? "cached access point" : "scan");
+    }
+
+    // Report TLS connection reuse and cache use to web clients
+    pushStats(false);
+}
+
+static_assert(WS_TELEMETRY_JSON_SIZE >= TELEMETRY_JSON_SIZE, "Telemetry JSON would be cut off");
+static_assert(WS_AGE_BUCKETS == PRICE_AGE_BUCKETS, "Websocket counter layout out of date");
+
+// Counter deltas to binary web clients, JSON stats to older ones.
+// The JSON telemetry document is only sent on the telemetry interval.
+void pushStats(bool withTelemetry) {
+    if (webSocketHandler.hasBinaryClients()) {
+        uint32_t values[CTR_COUNT];
+        telemetry.fillCounters(values, apiHandler);
+        values[CTR_CACHE_HITS] = priceTable.getHits();
+        values[CTR_CACHE_MISSES] = priceTable.getMisses();
+        for (int i = 0; i < PRICE_AGE_BUCKETS; i++) {
+            values[CTR_CACHE_AGE + i] = priceTable.getAgeCounts()[i];
+        }
+        webSocketHandler.fillCounters(values);
+        webSocketHandler.sendCounters(values);
+    }
+
+    if (webSocketHandler.hasJsonClients()) {
+        char json[TELEMETRY_JSON_SIZE];
+        webSocketHandler.formatStats(json, sizeof(json), apiHandler.getHandshakeCount(),
+                                     apiHandler.getReusedCount(), apiHandler.getReconnectCount(),
+                                     priceTable.getHits(), priceTable.getMisses(),
+                                     priceTable.getAgeCounts(), priceTable.ageBucketLabel, PRICE_AGE_BUCKETS);
+        webSocketHandler.sendStatsJson(json);
+        if (withTelemetry) {
+            telemetry.toJson(json, sizeof(json), apiHandler);
+            webSocketHandler.sendTelemetryJson(json);
+        }
+    }
+}
+
+// Batch feed callback, keeps every configured pair up to date
+void onFeedRecord(const char* pair, const Price& price, float change) {
+    symbolIndex.add(pair);
+    int crypto, fiat;
+    if (!priceTable.findPair(pair, crypto, fiat)) return;
+    priceTable.store(crypto, fiat, price, change);
+    sparklines.get(crypto, fiat)->add(price, millis());
+}
+
+// A /history response in progress. The chunked response pulls one
+// file batch per call, so no request reads every day file at once.
+struct HistoryStream {
+    HistoryCursor cursor;
+    uint32_t spacing;       // Records closer than this to the last one sent are skipped
+    uint32_t lastTime = 0;
+    bool first = true;
+    HistoryRecord batch[HISTORY_READ_BATCH];
+    uint8_t batchLen = 0;
+    uint8_t batchPos = 0;
+    char text[48];          // JSON not yet sent
+    uint8_t textLen = 0;
+    uint8_t textPos = 0;
+    bool closed = false;    // "]" is in text
+};
+
+// Formats a record into text, unless it is thinned out
+void formatHistoryRecord(HistoryStream& stream, const HistoryRecord& record) {
+    if (!stream.first && record.time - stream.lastTime < stream.spacing) return;
+
+    Price price;
+    price.mantissa = record.mantissa;
+    price.scale = record.scale;
+    char priceText[PRICE_TEXT_SIZE];
+    price.format(priceText, sizeof(priceText), PRICE_MAX_SCALE, sizeof(priceText) - 1);
+
+    int len = snprintf(stream.text, sizeof(stream.text), "%s[%lu,\"%s\",%.4f]", stream.first ? "" : ",",
+                       (unsigned long)record.time, priceText, record.change / 10000.0f);
+    stream.textLen = min(len, (int)sizeof(stream.text) - 1);
+    stream.textPos = 0;
+    stream.lastTime = record.time;
+    stream.first = false;
+}
+
+// Fills one chunk of the response, reading at most one file batch
+size_t fillHistoryChunk(HistoryStream& stream, uint8_t* buffer, size_t maxLen) {
+    size_t pos = 0;
+    bool readFile = false;
+    for (;;) {
+        size_t len = min((size_t)(stream.textLen - stream.textPos), maxLen - pos);
+        memcpy(buffer + pos, stream.text + stream.textPos, len);
+        stream.textPos += len;
+        pos += len;
+        if (stream.textPos < stream.textLen) return pos;
+
+        if (stream.batchPos < stream.batchLen) {
+            formatHistoryRecord(stream, stream.batch[stream.batchPos++]);
+            continue;
+        }
+        if (stream.closed) return pos;
+        if (stream.cursor.done) {
+            strcpy(stream.text, "]");
+            stream.textLen = 1;
+            stream.textPos = 0;
+            stream.closed = true;
+            continue;
+        }
+
+        // The next batch waits for the next call, unless nothing was sent yet
+        if (readFile && pos > 0) return pos;
+        if (readFile) return RESPONSE_TRY_AGAIN;
+        stream.batchLen = historyStore.read(stream.cursor, stream.batch, HISTORY_READ_BATCH);
+        stream.batchPos = 0;
+        readFile = true;
+    }
+}
+
+// Unix time from a query parameter, the fallback if it is missing.
+// Anything but plain digits that fit 32 bits is refused.
+bool timeParam(AsyncWebServerRequest* request, const char* name, uint32_t fallback, uint32_t& out) {
+    if (!request->hasParam(name)) {
+        out = fallback;
+        return true;
+    }
+    const String& value = request->getParam(name)->value();
+    if (value.length() == 0 || value.length() > 10) return false;
+    for (size_t i = 0; i < value.length(); i++) {
+        if (!isdigit(value[i])) return false;
+    }
+    unsigned long long parsed = strtoull(value.c_str(), nullptr, 10);
+    if (parsed > UINT32_MAX) return false;
+    out = (uint32_t)parsed;
+    return true;
+}
+
+// GET /history?crypto=DOGE&fiat=USD&from=<unix>&to=<unix>, defaults to the
+// shown pair over the last day. Returns [[time,"price",change],...].
+// Ranges start no earlier than the oldest day kept.
+void onHistoryRequest(AsyncWebServerRequest* request) {
+    String crypto = request->hasParam("crypto") ? request->getParam("crypto")->value() : String(tickerState.get().crypto);
+    String fiat = request->hasParam("fiat") ? request->getParam("fiat")->value() : String(tickerState.get().fiat);
+    int cryptoIndex = coinByName(crypto.c_str());
+    int fiatIndex = fiatByName(fiat.c_str());
+    if (cryptoIndex < 0 || fiatIndex < 0) {
+        request->send(404, "text/plain", "Unknown pair");
+        return;
+    }
+
+    uint32_t now = (uint32_t)time(nullptr);
+    uint32_t to, from;
+    if (!timeParam(request, "to", now, to) || !timeParam(request, "from", to > 86400 ? to - 86400 : 0, from)) {
+        request->send(400, "text/plain", "from and to are unix seconds");
+        return;
+    }
+    if (from > to) from = to;
+
+    std::shared_ptr<HistoryStream> stream = std::make_shared<HistoryStream>();
+    historyStore.openCursor(stream->cursor, pairCode(cryptoIndex, fiatIndex), from, to);
+    // Thin long ranges to about HISTORY_QUERY_POINTS evenly spaced records
+    stream->spacing = (to - stream->cursor.from) / HISTORY_QUERY_POINTS;
+    strcpy(stream->text, "[");
+    stream->textLen = 1;
+
+    request->send(request->beginChunkedResponse("application/json",
+        [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return fillHistoryChunk(*stream, buffer, maxLen);
+        }));
+}
+
+// Outcome of every fetch, picks the time to the next one
+void onFetchResult(FetchResult result, long retryAfterMs) {
+    // The whole feed was read, so the symbol index is complete, even
+    // when the shown pair got no price
+    if (apiHandler.isFeedComplete()) {
+        symbolIndex.endPass();
+    }
+
+    float random01 = random(1000) / 1000.0f;
+    if (result == FETCH_UNREACHABLE) {
+        pollScheduler.onUnreachable(random01);
+    } else if (result == FETCH_RATE_LIMITED) {
+        pollScheduler.onRateLimited(retryAfterMs, random01);
+    } else if (result == FETCH_FAILED) {
+        pollScheduler.onFailed();
+    }
+    Serial.printf("Next fetch in %lu ms (%s)\n", (unsigned long)pollScheduler.getInterval(),
+                  PollScheduler::reasonName(pollScheduler.getReason()));
+}
+
+// GET shows the fetch interval and its recent history. A POST with
+// min and max (seconds) sets the bounds, which are kept across reboots.
+void onPollingRequest(AsyncWebServerRequest* request) {
+    if (request->method() == HTTP_POST) {
+        uint32_t minMs = request->hasParam("min", true) ? request->getParam("min", true)->value().toInt() * 1000UL : pollScheduler.getMin();
+        uint32_t maxMs = request->hasParam("max", true) ? request->getParam("max", true)->value().toInt() * 1000UL : pollScheduler.getMax();
+        pollScheduler.setBounds(minMs, maxMs);
+        bootStore.savePollBounds(pollScheduler.getMin(), pollScheduler.getMax());
+        Serial.printf("Fetch interval bounds: %lu-%lu ms\n", (unsigned long)pollScheduler.getMin(),
+                      (unsigned long)pollScheduler.getMax());
+    }
+
+    AsyncResponseStream* stream = request->beginResponseStream("application/json");
+    stream->printf("{\"min\":%lu,\"max\":%lu,\"interval\":%lu,\"reason\":\"%s\",\"rate\":%.5f,\"recent\":[",
+                   (unsigned long)pollScheduler.getMin(), (unsigned long)pollScheduler.getMax(),
+                   (unsigned long)pollScheduler.getInterval(),
+                   PollScheduler::reasonName(pollScheduler.getReason()), pollScheduler.getRate());
+    for (int i = 0; i < pollScheduler.getLogCount(); i++) {
+        const PollDecision& decision = pollScheduler.getLog(i);
+        stream->printf("%s{\"interval\":%lu,\"reason\":\"%s\"}", i > 0 ? "," : "",
+                       (unsigned long)decision.interval, PollScheduler::reasonName(decision.reason));
+    }
+    stream->print("]}");
+    request->send(stream);
+}
+
+// Shows the pair and price of the last run while Wi-Fi connects.
+// The price is drawn stale and the first fetch replaces it in place.
+void restoreBootState() {
+    if (bootStore.has(BOOT_HAS_PAIR)) {
+        const BootRecord& record = bootStore.get();
+        tickerState.setPair(record.crypto, record.fiat, coinByName(record.crypto), fiatByName(record.fiat));
+    }
+
+    const TickerState& state = tickerState.get();
+    if (!bootStore.has(BOOT_HAS_PRICE)) {
+        displayHandler.showCoinSplash(state.crypto);
+        return;
     }
-    displayHandler.updatePrice(currentCrypto, currentCurrency, price, change);
+
+    tickerState.setSplashActive(false);  // No coin splash between the old and new price
+    float change = bootStore.getChange();
+    displayHandler.updatePrice(state.crypto, state.fiat, bootStore.getPrice(), change, true,
+                               sparklines.get(state.cryptoIndex, state.fiatIndex));
     ledHandler.updateLed(change);
 }
 
+// Redraws the current pair without counting a cache lookup
+void redrawPrice() {
+    Price price;
+    float change;
+    unsigned long age;
+    if (priceTable.peek(tickerState.get().cryptoIndex, tickerState.get().fiatIndex, price, change, age)) {
+        showPrice(price, change, age > priceMaxAge);
+    }
+}
+
+// Shows the current pair from the cache without a network round trip.
+// Returns false when the pair is missing or stale and needs a fetch.
+bool showCachedPrice() {
+    Price price;
+    float change;
+    unsigned long age;
+    if (!priceTable.lookup(tickerState.get().cryptoIndex, tickerState.get().fiatIndex, price, change, age)) {
+        return false;
+    }
+
+    bool stale = age > priceMaxAge;
+    tickerState.setSplashActive(false);
+    showPrice(price, change, stale);
+    return !stale;
+}
+
+// Collects when each handler next needs the CPU, loop() naps until the earliest
+void planPower(const TickerState& state) {
+    PowerPlanner& plan = powerScheduler.plan(millis());
+
+    // Joining, first fetch, a fetch or button press in progress
+    if (!wifiHandler.isConnected() || state.bootSplash || apiHandler.isBusy() || buttonHandler.isActive()) {
+        plan.stayAwake();
+    }
+    // Web clients get prices and counters without sleep latency
+    if (webSocketHandler.hasClients()) {
+        plan.keepRadio();
+    }
+    // Page loads and uploads only wait out short naps
+    if (webActivity.isActive()) {
+        plan.serving();
+    }
+    // Serial commands such as bench are read on the next pass
+    if (Serial.available() > 0) {
+        plan.stayAwake();
+    }
+
+    plan.wakeBy(previousFetch + pollScheduler.getInterval());
+    if (state.previewMode) {
+        plan.wakeBy(previewStartTime + PREVIEW_DURATION);
+    }
+    if (ledHandler.isBusy()) {
+        plan.wakeBy(ledHandler.nextStepAt());
+    }
+    if (ledHandler.usesPwm()) {
+        plan.noLightSleep();
+    }
+    const FrameScheduler& frames = displayHandler.getFrameStats();
+    if (frames.isRunning()) {
+        plan.wakeBy(frames.getNextFrame());
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     delay(100); // Give serial a moment to start
@@ -158,82 +571,186 @@ void setup() {
     Serial.println("I2C initialized");
     
     // Initialize display
-    if(!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
+    if (!displayHandler.begin()) {
         Serial.println("SSD1306 allocation failed");
         for(;;); // Don't proceed, loop forever
     }
     
     Serial.println("Display initialized");
     
-    // Show startup screen
-    displayHandler.showCoinSplash(currentCrypto);
-    delay(5000);
-    
     // Initialize components
-    displayHandler.begin();
     ledHandler.begin();
     
     // Initialize button and set callbacks
     buttonHandler.begin();
     buttonHandler.setCallbacks(onShortPress, onLongPress);
+    buttonHandler.setVeryLongPressCallback(onVeryLongPress);
+
+    // "bench" on the serial console runs the microbenchmarks
+    benchmarkHandler.setDoneCallback(redrawPrice);
     
-    // Set API callback
+    // Set API callbacks, one batch request to Gemini serves every configured pair
     apiHandler.setUpdateCallback(onPriceUpdate);
+    apiHandler.setBatchMode(onFeedRecord);
+    apiHandler.setResultCallback(onFetchResult);
+    Serial.printf("Price table: %u bytes, sparklines: %u bytes\n",
+                  (unsigned)priceTable.footprint(), (unsigned)sparklines.footprint());
+    Serial.printf("Logos: %u bytes in flash, %u uncoded\n",
+                  (unsigned)logoFlashBytes(), (unsigned)(COIN_COUNT * LOGO_BYTES));
     
     // Initialize filesystem
     if (!LittleFS.begin()) {
         Serial.println("An error has occurred while mounting LittleFS");
+        displayHandler.showCoinSplash(tickerState.get().crypto);
         return;
     }
-    
-    // Initialize WiFi and OTA
-    WiFiHandler wifiHandler(ssid, password, &displayHandler, &ledHandler);
-    if (!wifiHandler.begin()) {
-        ESP.restart();
-        return;
+
+    // Last pair and price on screen right away, then join the cached
+    // access point while setup continues. loop() fetches once it is up.
+    bootStore.begin();
+    if (bootStore.has(BOOT_HAS_POLL)) {
+        pollScheduler.setBounds(bootStore.get().pollMin * 1000UL, bootStore.get().pollMax * 1000UL);
     }
-    // Show coin splash after WiFi connects and after WiFi message
-    displayHandler.showCoinSplash(currentCrypto);
-    isBootSplash = true;
-    wifiHandler.setupOTA();
+    restoreBootState();
+    wifiHandler.begin();
+
+    historyStore.begin(legacyPairCode);
+
+    // Wall clock for history timestamps, records are held back until it is set
+    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
     
+    telemetry.setPowerScheduler(&powerScheduler);
+
+    // Sees every request, so it goes ahead of all other handlers
+    server.addHandler(&webActivity);
+
     // Initialize WebSocket
-    webSocketHandler.begin(&server, currentCrypto, currentCurrency, previousFetch);
+    webSocketHandler.begin(&server, &tickerState);
+    webSocketHandler.setStateCallback(onWebStateChange);
+
+    // The restored pair is already drawn, listeners only see later changes
+    tickerState.publish();
+
+    // State consumers, in the order they are notified
+    tickerState.subscribe(onStateLeds);
+    tickerState.subscribe(onStateDisplay);
+    tickerState.subscribe(onStateFetch);
+    tickerState.subscribe(onStateWebSocket);
+    tickerState.subscribe(onStateBoot);
 
-    // Route for root / web page
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        request->send(LittleFS, "/index.html", "text/html", false);
+    // Routes for the web page and its hashed assets
+    assetHandler.begin(&server);
+    symbolIndex.begin(&server);
+
+    server.on("/history", HTTP_GET, onHistoryRequest);
+    server.on("/polling", HTTP_GET, onPollingRequest);
+    server.on("/polling", HTTP_POST, onPollingRequest);
+
+    server.on("/telemetry", HTTP_GET, [](AsyncWebServerRequest *request) {
+        char json[TELEMETRY_JSON_SIZE];
+        telemetry.toJson(json, sizeof(json), apiHandler);
+        request->send(200, "application/json", json);
     });
 
-    server.serveStatic("/", LittleFS, "/");
+    assetHandler.serveFiles(&server);
     server.begin();
     
-    Serial.println("Setup complete");
+    Serial.printf("Setup complete in %lu ms\n", millis());
 }
 
 void loop() {
+    unsigned long loopStart = micros();
     unsigned long currentTime = millis();
     
+    const TickerState& state = tickerState.get();
+
+    // Connection runs alongside the splash, OTA needs the link. A failed
+    // join restarts by itself once the LED error pattern has played.
+    if (wifiHandler.handle()) {
+        wifiHandler.setupOTA();
+        powerScheduler.begin();
+    }
+    
     // Check if preview mode should end
-    if (isPreviewMode && (currentTime - previewStartTime >= PREVIEW_DURATION)) {
-        isPreviewMode = false;
-        currentCryptoIndex = (currentCryptoIndex + 1) % NUM_CRYPTOCURRENCIES;
-        currentCrypto = CRYPTOCURRENCIES[currentCryptoIndex];
-        previousFetch = 0;  // Force immediate API update
+    if (state.previewMode && (currentTime - previewStartTime >= PREVIEW_DURATION)) {
+        int nextCryptoIndex = (state.cryptoIndex + 1) % COIN_COUNT;
+        tickerState.setPreviewMode(false);
+        tickerState.setPair(coinInfo(nextCryptoIndex).name, state.fiat, nextCryptoIndex, state.fiatIndex);
     }
+
+    // Deliver this pass's state changes before deciding to fetch
+    tickerState.publish();
     
     // Only fetch API if not in preview mode and not in boot splash
-    if (!isPreviewMode && !isBootSplash && (currentTime - previousFetch >= fetchInterval)) {
+    if (!state.previewMode && !state.bootSplash && (currentTime - previousFetch >= pollScheduler.getInterval())) {
         previousFetch = currentTime;
-        apiHandler.fetchPrice(currentCrypto, currentCurrency);
+        const FrameScheduler& frames = displayHandler.getFrameStats();
+        Serial.printf("Loop max: %lu us, fetch step max: %lu us, last frame: %lu I2C bytes\n",
+                      loopMaxMicros, apiHandler.getMaxStepMicros(), displayHandler.getLastFrameBytes());
+        Serial.printf("Frames: %lu rendered, %lu dropped, render max: %lu us\n",
+                      frames.getFramesRendered(), frames.getFramesDropped(), frames.getMaxRenderMicros());
+        Serial.printf("History: %lu records in %lu flushes, last flush: %lu us, %d pending\n",
+                      historyStore.getRecordsWritten(), historyStore.getFlushCount(),
+                      historyStore.getLastFlushMicros(), historyStore.getPendingCount());
+        Serial.printf("Web UI: %lu page loads, %lu not modified, %lu bytes sent\n",
+                      assetHandler.getIndexRequests(), assetHandler.getNotModifiedCount(),
+                      assetHandler.getBytesSent());
+        const PowerStats& power = powerScheduler.getStats();
+        Serial.printf("Power: %s, %.1f%% duty, %.1f mWh/h estimated\n", PowerScheduler::modeName(powerScheduler.getMode()),
+                      power.getDutyCycle() * 100.0f, power.getMilliwattHoursPerHour());
+        loopMaxMicros = 0;
+        apiHandler.resetStepStats();
+        displayHandler.resetFrameStats();
+        symbolIndex.beginPass();
+        apiHandler.fetchPrice(state.crypto, state.fiat);
     }
-    // If in boot splash, fetch price only once
-    if (isBootSplash && !splashFetchDone) {
-        apiHandler.fetchPrice(currentCrypto, currentCurrency);
+    // If in boot splash, fetch price only once, as soon as Wi-Fi is up
+    if (state.bootSplash && !splashFetchDone && wifiHandler.isConnected()) {
+        symbolIndex.beginPass();
+        apiHandler.fetchPrice(state.crypto, state.fiat);
         splashFetchDone = true;
     }
     
-    ArduinoOTA.handle();
-    webSocketHandler.cleanupClients();
+    // Advance any fetch in flight by one step
+    unsigned long mark = micros();
+    apiHandler.handle();
+    mark = telemetry.lap(SECTION_FETCH, mark);
+
+    if (wifiHandler.isConnected()) {
+        ArduinoOTA.handle();
+    }
+    mark = telemetry.lap(SECTION_OTA, mark);
+
+    webSocketHandler.handle();
+    if (currentTime - previousTelemetryPush >= TELEMETRY_PUSH_INTERVAL) {
+        previousTelemetryPush = currentTime;
+        pushStats(true);
+    }
+    mark = telemetry.lap(SECTION_WEBSOCKET, mark);
+
     buttonHandler.handle();
+    mark = telemetry.lap(SECTION_BUTTON, mark);
+
+    historyStore.handle();
+    bootStore.handle();
+    mark = telemetry.lap(SECTION_HISTORY, mark);
+
+    ledHandler.handle();
+    mark = telemetry.lap(SECTION_LED, mark);
+
+    benchmarkHandler.handle();
+
+    // Render animation frames in whatever time this pass has left
+    mark = micros();
+    displayHandler.handle(mark - loopStart);
+    telemetry.lap(SECTION_DISPLAY, mark);
+
+    unsigned long loopTime = micros() - loopStart;
+    if (loopTime > loopMaxMicros) {
+        loopMaxMicros = loopTime;
+    }
+    telemetry.recordLoop(loopTime);
+
+    planPower(state);
+    powerScheduler.sleep();
 }
@@ -4,150 +4,765 @@
 #include <Arduino.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
+#include "http_parser.h"
+#include "price.h"
+#include "price_feed_parser.h"
+#include "price_source.h"
+#include "price_aggregator.h"
+#include "ticker_state.h"
 
-extern bool isSplashActive;
-extern bool isBootSplash;
-
-#define API_HOST "api.gemini.com"
 #define API_PORT 443
+#define API_TIMEOUT 5000        // Max time to wait for a complete response (ms)
+#define API_READ_CHUNK 128      // Max bytes consumed from the socket per handle() call
+#define API_REQUEST_SIZE 192    // Fixed buffer the GET request is formatted into
+#define API_PATH_SIZE 48
+#define API_SSL_BUFFER 1024     // BearSSL receive buffer, responses are small
+#define API_SSL_BUFFER_FULL 16709   // For servers that won't shorten TLS records to fit the one above
+#define API_SSL_HEAP_MARGIN 6144    // Send buffer, BearSSL context and room for the web server
+#define API_SOURCE_COUNT 3
+#define API_LATENCY_SMOOTHING 4     // Average latency moves 1/4 of the way to each new sample
 
-class ApiHandler {
+static_assert(API_SOURCE_COUNT <= AGG_MAX_QUOTES, "More sources than the aggregator takes");
+
+// How a fetch ended, for the poll scheduler
+enum FetchResult {
+    FETCH_OK,
+    FETCH_FAILED,           // The server answered, but not with the price
+    FETCH_UNREACHABLE,      // Connect, send or read failed, or timed out
+    FETCH_RATE_LIMITED      // 429 or 503
+};
+
+typedef void (*FetchResultCallback)(FetchResult result, long retryAfterMs);
+
+// Fetch progress, advanced one step per loop() pass
+enum FetchState {
+    FETCH_IDLE,
+    FETCH_CONNECT,
+    FETCH_SEND,
+    FETCH_WAIT,
+    FETCH_HEADERS,
+    FETCH_BODY
+};
+
+// TLS connection counters, shared by all sources
+struct ConnectionStats {
+    unsigned long handshakes = 0;
+    unsigned long reused = 0;
+    unsigned long reconnects = 0;
+    unsigned long timeouts = 0;
+    unsigned long lastHandshakeMicros = 0;
+    unsigned long maxHandshakeMicros = 0;
+};
+
+// Scoreboard entry of one source, served on /telemetry
+struct SourceStats {
+    unsigned long ok = 0;
+    unsigned long failed = 0;           // Timeouts included
+    unsigned long outliers = 0;         // Answered, but too far from the others
+    unsigned long lastMs = 0;           // Fetch start to its end, handshake included
+    unsigned long averageMs = 0;
+    const char* lastError = "";
+};
+
+// One source's keep-alive connection and fetch progress. ApiHandler
+// steps every source once per loop() pass, so their requests are in
+// flight at the same time. Every connection asks for 1 KB TLS records
+// and stays open. Servers that don't take the shorter maximum fragment
+// length send full 16 KB records. Those get the full buffer, and their
+// connection is closed after every response to give it back.
+class SourceClient {
 private:
-    DisplayHandler* display;
-    void (*onPriceUpdate)(const String& price, float change) = nullptr;
+    PriceSource* source = nullptr;
+    ConnectionStats* connection = nullptr;
+    SourceStats stats;
+
+    WiFiClientSecure client;
+    BearSSL::Session session;   // Cached for abbreviated handshakes on reconnect
+    uint16_t receiveBuffer = API_SSL_BUFFER_FULL;
+    bool reusingConnection = false;
+    bool retried = false;
+    bool fellBack = false;      // This fetch switched to the full buffer after a failed handshake
+
+    FetchState state = FETCH_IDLE;
+    char crypto[STATE_SYMBOL_SIZE];
+    char fiat[STATE_SYMBOL_SIZE];
+    unsigned long startedAt = 0;
+    unsigned long requestStart = 0;
+
+    FetchResult result = FETCH_OK;
+    long retryAfterMs = -1;
+    bool bodyComplete = false;          // The last response was read to its end
+    unsigned long heldSince = 0;        // A 429 or 503 holds the source back
+    unsigned long heldFor = 0;
+
+    // Response parsing state, no heap allocations per fetch
+    HttpResponseParser http;
 
 public:
-    ApiHandler(DisplayHandler* disp) : display(disp) {}
+    SourceClient() {
+        crypto[0] = '\0';
+        fiat[0] = '\0';
+    }
 
-    void setUpdateCallback(void (*callback)(const String& price, float change)) {
-        onPriceUpdate = callback;
+    void begin(PriceSource* priceSource, ConnectionStats* connectionStats) {
+        source = priceSource;
+        connection = connectionStats;
+        receiveBuffer = source->shortRecords() ? API_SSL_BUFFER : API_SSL_BUFFER_FULL;
+        client.setInsecure();  // Don't verify SSL certificate
+        client.setSession(&session);
+        client.setTimeout(API_TIMEOUT);
     }
 
-    bool fetchPrice(const String& crypto, const String& fiat) {
-        if (isSplashActive) {
-            display->showCoinSplash(crypto);
-            isSplashActive = false;
+    // Starts a fetch, unless the server asked for a pause that hasn't
+    // run out yet
+    bool start(const char* cryptoName, const char* fiatName) {
+        if (heldFor > 0) {
+            if (millis() - heldSince < heldFor) return false;
+            heldFor = 0;
         }
-        
-        WiFiClientSecure client;
-        client.setInsecure();  // Don't verify SSL certificate
+        if (state != FETCH_IDLE) client.stop();
+
+        snprintf(crypto, sizeof(crypto), "%s", cryptoName);
+        snprintf(fiat, sizeof(fiat), "%s", fiatName);
+        retried = false;
+        fellBack = false;
+        startedAt = millis();
+        result = FETCH_OK;
+        retryAfterMs = -1;
+        bodyComplete = false;
+        reusingConnection = client.connected();
+        state = reusingConnection ? FETCH_SEND : FETCH_CONNECT;
+        return true;
+    }
+
+    // A half-read response can't be resumed on this connection
+    void abort() {
+        if (state == FETCH_IDLE) return;
+        client.stop();
+        state = FETCH_IDLE;
+    }
 
-        Serial.print("Connecting to ");
-        Serial.println(API_HOST);
+    bool isBusy() const {
+        return state != FETCH_IDLE;
+    }
+
+    // Next step is the blocking TLS handshake
+    bool isConnecting() const {
+        return state == FETCH_CONNECT;
+    }
+
+    // A connection needs its receive buffer in one block, plus a margin
+    bool hasHeapToConnect() const {
+        return ESP.getMaxFreeBlockSize() >= (uint32_t)(receiveBuffer + API_SSL_HEAP_MARGIN);
+    }
+
+    // A 200 response was read to its end, whether or not it had the pair
+    bool isBodyComplete() const {
+        return bodyComplete;
+    }
+
+    // Time left of a server-requested pause (ms)
+    unsigned long heldBack() const {
+        if (heldFor == 0) return 0;
+        unsigned long held = millis() - heldSince;
+        return held < heldFor ? heldFor - held : 0;
+    }
+
+    FetchResult getResult() const {
+        return result;
+    }
+
+    long getRetryAfter() const {
+        return retryAfterMs;
+    }
 
-        if (!client.connect(API_HOST, API_PORT)) {
-            Serial.println("Connection failed!");
-            isBootSplash = false;
-            isSplashActive = false;
-            display->showError("API Error", "Connection failed!");
-            return false;
+    PriceSource* getSource() const {
+        return source;
+    }
+
+    const SourceStats& getStats() const {
+        return stats;
+    }
+
+    void countOutlier() {
+        stats.outliers++;
+    }
+
+    // Advances the fetch by one state
+    void handle() {
+        switch (state) {
+            case FETCH_CONNECT:
+                connect();
+                break;
+            case FETCH_SEND:
+                sendRequest();
+                break;
+            case FETCH_WAIT:
+                waitForResponse();
+                break;
+            case FETCH_HEADERS:
+            case FETCH_BODY:
+                readResponse();
+                break;
+            default:
+                break;
         }
+    }
 
-        Serial.println("Connected to API endpoint");
-        // No loading message, keep splash until data is ready
+private:
+    void connect() {
+        if (!hasHeapToConnect()) {
+            fail("Low heap", FETCH_FAILED);
+            return;
+        }
+        client.setBufferSizes(receiveBuffer, 512);
 
-        String apiUrl = "/v1/pricefeed/" + crypto + fiat;
-        String request = String("GET ") + apiUrl + " HTTP/1.1\r\n" +
-                        "Host: " + API_HOST + "\r\n" +
-                        "User-Agent: ESP8266\r\n" +
-                        "Connection: close\r\n\r\n";
+        Serial.printf("Connecting to %s\n", source->getHost());
 
-        Serial.println("Sending request...");
-        client.print(request);
+        // BearSSL completes the TLS handshake inside connect(), so this
+        // is the one step that cannot be split further. ApiHandler lets
+        // one source do it per pass. The cached session lets it resume
+        // instead of doing a full handshake.
+        reusingConnection = false;
+        connection->handshakes++;
+        unsigned long handshakeStart = micros();
+        bool connected = client.connect(source->getHost(), API_PORT);
+        connection->lastHandshakeMicros = micros() - handshakeStart;
+        if (connection->lastHandshakeMicros > connection->maxHandshakeMicros) {
+            connection->maxHandshakeMicros = connection->lastHandshakeMicros;
+        }
+        if (!connected) {
+            // The server may have sent records too large for the short
+            // buffer. The full one is kept from now on if it connects.
+            if (receiveBuffer == API_SSL_BUFFER) {
+                receiveBuffer = API_SSL_BUFFER_FULL;
+                fellBack = true;
+                Serial.printf("%s: no short TLS records, using a %u byte buffer\n", source->getName(), receiveBuffer);
+                return;
+            }
+            // Failing with either buffer means the server is unreachable
+            if (fellBack) receiveBuffer = API_SSL_BUFFER;
+            fail("Connection failed!", FETCH_UNREACHABLE);
+            return;
+        }
+        fellBack = false;
 
-        Serial.println("Reading response...");
         // No loading message, keep splash until data is ready
-        
-        // Wait for data
-        unsigned long timeout = millis();
-        while (client.available() == 0) {
-            if (millis() - timeout > 5000) {
-                Serial.println(">>> Client Timeout !");
-                client.stop();
-                isBootSplash = false;
-                isSplashActive = false;
-                display->showError("API Error", "Timeout");
-                return false;
-            }
+        state = FETCH_SEND;
+    }
+
+    void sendRequest() {
+        char path[API_PATH_SIZE];
+        source->formatPath(path, sizeof(path), crypto, fiat);
+
+        char request[API_REQUEST_SIZE];
+        int len = snprintf(request, sizeof(request),
+                           "GET %s HTTP/1.1\r\n"
+                           "Host: %s\r\n"
+                           "User-Agent: ESP8266\r\n"
+                           "Connection: %s\r\n\r\n",
+                           path, source->getHost(), keepsConnection() ? "keep-alive" : "close");
+
+        if (client.write((const uint8_t*)request, len) != (size_t)len) {
+            reconnectOrFail("Send failed!");
+            return;
+        }
+        if (reusingConnection) {
+            connection->reused++;
         }
 
-        // Skip HTTP headers and get status code
-        String line;
-        int httpCode = 0;
-        bool headersParsed = false;
-        
-        while (client.available()) {
-            line = client.readStringUntil('\n');
-            line.trim();
-            
-            // Get HTTP status code from first line
-            if (!headersParsed && line.startsWith("HTTP/1.1")) {
-                httpCode = line.substring(9, 12).toInt();
-                headersParsed = true;
+        http.reset();
+        source->begin(crypto, fiat);
+        requestStart = millis();
+        state = FETCH_WAIT;
+    }
+
+    void waitForResponse() {
+        if (client.available() > 0) {
+            state = FETCH_HEADERS;
+            return;
+        }
+
+        // The server may have dropped the idle keep-alive connection
+        if (!client.connected()) {
+            reconnectOrFail("Connection closed");
+            return;
+        }
+
+        if (timedOut()) {
+            Serial.printf(">>> %s: Client Timeout !\n", source->getName());
+            connection->timeouts++;
+            fail("Timeout", FETCH_UNREACHABLE);
+        }
+    }
+
+    void readResponse() {
+        int available = client.available();
+        if (available > 0) {
+            char buffer[API_READ_CHUNK];
+            int len = client.read((uint8_t*)buffer, min(available, API_READ_CHUNK));
+            if (len > 0) {
+                size_t bodyLen = http.feed(buffer, len);
+
+                if (http.hasError()) {
+                    fail("Bad response", FETCH_FAILED);
+                    return;
+                }
+
+                // Check HTTP status code once the headers are through
+                if (state == FETCH_HEADERS && http.headersComplete()) {
+                    int status = http.statusCode();
+                    if (status == 429 || status == 503) {
+                        long retryAfter = http.retryAfterSeconds();
+                        Serial.printf("%s: HTTP %d, retry after %ld s\n", source->getName(), status, retryAfter);
+                        fail("Rate limited", FETCH_RATE_LIMITED, retryAfter < 0 ? -1 : retryAfter * 1000);
+                        return;
+                    }
+                    if (status != 200) {
+                        Serial.printf("%s: HTTP Error: %d\n", source->getName(), status);
+                        fail("Price pair not available", FETCH_FAILED);
+                        return;
+                    }
+                    state = FETCH_BODY;
+                }
+
+                source->feed(buffer, bodyLen);
+
+                if (http.isComplete()) {
+                    finish();
+                    return;
+                }
             }
-            
-            if (line.length() == 0) {
-                break;  // Headers finished
+        } else if (!client.connected()) {
+            // Body without any framing ends when the server closes
+            if (http.endsAtClose()) {
+                finish();
+            } else {
+                fail("Connection closed", FETCH_UNREACHABLE);
             }
+            return;
         }
 
-        // Check HTTP status code
-        if (httpCode != 200) {
-            Serial.printf("HTTP Error: %d\n", httpCode);
-            display->showError("API Error", "Price pair not available");
+        if (timedOut()) {
+            Serial.printf(">>> %s: Client Timeout !\n", source->getName());
+            connection->timeouts++;
+            fail("Timeout", FETCH_UNREACHABLE);
+        }
+    }
+
+    void finish() {
+        // Only a fully delimited body leaves the connection reusable
+        if (!http.keepAlive() || !keepsConnection()) {
             client.stop();
-            isBootSplash = false;
-            isSplashActive = false;
-            return false;
-        }
-
-        // Read JSON response
-        String jsonData = "";
-        while (client.available()) {
-            line = client.readStringUntil('\n');
-            line.trim();
-            if (line.length() > 0) {
-                jsonData = line;
-                break;
+        }
+        state = FETCH_IDLE;
+        bodyComplete = true;
+        source->end();
+        recordLatency();
+        if (source->found() && source->getPrice().isPositive()) {
+            stats.ok++;
+            result = FETCH_OK;
+            return;
+        }
+
+        stats.failed++;
+        result = FETCH_FAILED;
+        stats.lastError = source->getError() != nullptr ? source->getError() : "Price pair not available";
+    }
+
+    bool keepsConnection() const {
+        return receiveBuffer == API_SSL_BUFFER;
+    }
+
+    bool timedOut() const {
+        return millis() - requestStart > API_TIMEOUT;
+    }
+
+    void recordLatency() {
+        stats.lastMs = millis() - startedAt;
+        if (stats.averageMs == 0) {
+            stats.averageMs = stats.lastMs;
+        } else {
+            stats.averageMs += ((long)stats.lastMs - (long)stats.averageMs) / API_LATENCY_SMOOTHING;
+        }
+    }
+
+    // A reused connection that turns out to be dead gets one fresh attempt
+    void reconnectOrFail(const char* error) {
+        client.stop();
+        if (reusingConnection && !retried) {
+            Serial.printf("%s: keep-alive connection lost, reconnecting\n", source->getName());
+            retried = true;
+            connection->reconnects++;
+            state = FETCH_CONNECT;
+            return;
+        }
+        fail(error, FETCH_UNREACHABLE);
+    }
+
+    void fail(const char* error, FetchResult failure, long retryAfter = -1) {
+        client.stop();
+        state = FETCH_IDLE;
+        recordLatency();
+        stats.failed++;
+        stats.lastError = error;
+        result = failure;
+        retryAfterMs = retryAfter;
+        if (failure == FETCH_RATE_LIMITED && retryAfter > 0) {
+            heldSince = millis();
+            heldFor = retryAfter;
+        }
+    }
+};
+
+// Asks every price source for the shown pair at once and combines the
+// answers with PriceAggregator, so one exchange failing or sending a
+// wrong price doesn't reach the display. Gemini comes first; its batch
+// feed also fills the price table, and its 24h change is preferred.
+// Handshakes block, so one source connects per handle() call, and a
+// source waits while the others hold the heap its buffer needs. The
+// error screen only shows when no price could be trusted.
+class ApiHandler {
+private:
+    DisplayHandler* display;
+    TickerStateStore* ticker;
+    void (*onPriceUpdate)(const Price& price, float change) = nullptr;
+    FetchResultCallback onResult = nullptr;
+
+    // Sources in order of preference
+    GeminiSource gemini;
+    CoinbaseSource coinbase;
+    BitstampSource bitstamp;
+    SourceClient clients[API_SOURCE_COUNT];
+    bool started[API_SOURCE_COUNT];
+
+    ConnectionStats connection;
+    PriceAggregator aggregator;
+
+    bool busy = false;
+    char pair[FEED_PAIR_SIZE];
+    char crypto[STATE_SYMBOL_SIZE];
+    char fiat[STATE_SYMBOL_SIZE];
+    unsigned long fetchStart = 0;
+    bool feedComplete = false;
+
+    // Kept for sources without a 24h change when Gemini has no answer
+    float lastChange = 0;
+    char lastChangePair[FEED_PAIR_SIZE];
+
+    // Fetch outcomes, over all sources
+    unsigned long successCount = 0;
+    unsigned long failureCount = 0;
+
+    // Worst-case time spent in a single handle() call (us)
+    unsigned long maxStepMicros = 0;
+
+public:
+    ApiHandler(DisplayHandler* disp, TickerStateStore* tickerState) : display(disp), ticker(tickerState) {
+        pair[0] = '\0';
+        lastChangePair[0] = '\0';
+        clients[0].begin(&gemini, &connection);
+        clients[1].begin(&coinbase, &connection);
+        clients[2].begin(&bitstamp, &connection);
+        memset(started, 0, sizeof(started));
+    }
+
+    void setUpdateCallback(void (*callback)(const Price& price, float change)) {
+        onPriceUpdate = callback;
+    }
+
+    // Switches Gemini to fetching /v1/pricefeed in one request. Every
+    // record is passed to the callback; the update callback still gets
+    // the requested pair.
+    void setBatchMode(FeedRecordCallback recordCallback) {
+        gemini.setBatchMode(recordCallback);
+    }
+
+    // Called once per fetch with its outcome. Retry-After is -1 when the
+    // server sent none.
+    void setResultCallback(FetchResultCallback callback) {
+        onResult = callback;
+    }
+
+    // Starts a new fetch from every source, aborting any request still
+    // in flight for another pair. The result is delivered through the
+    // update callback from handle().
+    bool fetchPrice(const char* cryptoName, const char* fiatName) {
+        char requested[FEED_PAIR_SIZE];
+        snprintf(requested, sizeof(requested), "%s%s", cryptoName, fiatName);
+
+        if (busy) {
+            // The same pair is already on its way
+            if (strcmp(requested, pair) == 0) return false;
+
+            Serial.println("Aborting fetch in progress");
+            for (int i = 0; i < API_SOURCE_COUNT; i++) {
+                clients[i].abort();
             }
         }
 
-        Serial.println("Raw API Response: " + jsonData);
+        if (ticker->get().splashActive) {
+            display->showCoinSplash(cryptoName);
+            ticker->setSplashActive(false);
+        }
 
-        StaticJsonDocument<192> doc;
-        DeserializationError error = deserializeJson(doc, jsonData);
+        memcpy(pair, requested, sizeof(pair));
+        snprintf(crypto, sizeof(crypto), "%s", cryptoName);
+        snprintf(fiat, sizeof(fiat), "%s", fiatName);
+        fetchStart = millis();
+        feedComplete = false;
 
-        if (error) {
-            Serial.print(F("deserializeJson() failed: "));
-            Serial.println(error.f_str());
-            isBootSplash = false;
-            isSplashActive = false;
-            display->showError("JSON Error", error.f_str());
-            return false;
+        int count = 0;
+        unsigned long wait = ULONG_MAX;
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            started[i] = false;
+            if (!clients[i].getSource()->supports(crypto, fiat)) continue;
+            started[i] = clients[i].start(crypto, fiat);
+            if (started[i]) {
+                count++;
+            } else {
+                wait = min(wait, clients[i].heldBack());
+            }
+        }
+        busy = true;
+
+        // Every source that lists the pair asked for a pause, wait for
+        // the first to end
+        if (count == 0 && wait != ULONG_MAX) {
+            fail("Rate limited", FETCH_RATE_LIMITED, wait > 0 ? (long)wait : -1);
+        } else if (count == 0) {
+            fail("Price pair not available", FETCH_FAILED);
         }
+        return true;
+    }
+
+    bool isBusy() const {
+        return busy;
+    }
+
+    // Pair of the current or last fetch, e.g. "DOGEUSD"
+    const char* getPair() const {
+        return pair;
+    }
+
+    // The last fetch read Gemini's batch feed to the end, even if the
+    // shown pair wasn't in it or the sources disagreed
+    bool isFeedComplete() const {
+        return feedComplete;
+    }
+
+    int getSourceCount() const {
+        return API_SOURCE_COUNT;
+    }
+
+    const char* getSourceName(int i) const {
+        return clients[i].getSource()->getName();
+    }
+
+    const SourceStats& getSourceStats(int i) const {
+        return clients[i].getStats();
+    }
+
+    unsigned long getMaxStepMicros() const {
+        return maxStepMicros;
+    }
+
+    void resetStepStats() {
+        maxStepMicros = 0;
+    }
+
+    unsigned long getHandshakeCount() const {
+        return connection.handshakes;
+    }
+
+    unsigned long getReusedCount() const {
+        return connection.reused;
+    }
 
-        JsonObject root_0 = doc[0];
-        
-        if (!root_0.isNull()) {
-            String price = root_0["price"].as<String>();
-            float change = root_0["percentChange24h"].as<float>();
+    unsigned long getReconnectCount() const {
+        return connection.reconnects;
+    }
+
+    unsigned long getLastHandshakeMicros() const {
+        return connection.lastHandshakeMicros;
+    }
+
+    unsigned long getMaxHandshakeMicros() const {
+        return connection.maxHandshakeMicros;
+    }
+
+    unsigned long getSuccessCount() const {
+        return successCount;
+    }
+
+    unsigned long getFailureCount() const {
+        return failureCount;
+    }
+
+    unsigned long getTimeoutCount() const {
+        return connection.timeouts;
+    }
+
+    void printConnectionStats() {
+        Serial.printf("API connection: %lu handshakes, %lu reused requests, %lu reconnects\n",
+                      connection.handshakes, connection.reused, connection.reconnects);
+    }
 
-            // Check if price is valid (not empty and not "0" or "0.00")
-            if (price != "" && price.toFloat() > 0.0) {
-                if (onPriceUpdate != nullptr) {
-                    onPriceUpdate(price, change);
+    // Advances every source's fetch by one state, and combines the
+    // answers once the last one is in. Call from every loop() pass.
+    void handle() {
+        if (!busy) return;
+
+        unsigned long stepStart = micros();
+
+        bool pending = false;
+        bool handshake = false;
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            if (!clients[i].isBusy()) continue;
+            if (clients[i].isConnecting()) {
+                if (handshake || (!clients[i].hasHeapToConnect() && holdingConnection(i))) {
+                    pending = true;
+                    continue;
                 }
-                isBootSplash = false;
-                isSplashActive = false;
-                return true;
+                handshake = true;
             }
+            clients[i].handle();
+            pending = pending || clients[i].isBusy();
+        }
+        if (!pending) {
+            finish();
         }
 
-        display->showError("API ERROR", "Price pair not available");
-        isBootSplash = false;
-        isSplashActive = false;
+        unsigned long stepTime = micros() - stepStart;
+        if (stepTime > maxStepMicros) {
+            maxStepMicros = stepTime;
+        }
+    }
+
+private:
+    // Another source is mid-fetch on an open connection, and gives its
+    // buffer back when done
+    bool holdingConnection(int except) const {
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            if (i != except && clients[i].isBusy() && !clients[i].isConnecting()) return true;
+        }
         return false;
     }
+
+    void finish() {
+        busy = false;
+
+        // The first source is Gemini, its batch feed is the one read whole
+        feedComplete = started[0] && clients[0].isBodyComplete() && gemini.isBatch();
+        if (started[0] && gemini.getSkippedCount() > 0) {
+            Serial.printf("Pricefeed: %u records too large, skipped\n", gemini.getSkippedCount());
+        }
+
+        aggregator.reset();
+        unsigned long slowest = 0;
+        unsigned long summed = 0;
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            if (!started[i]) continue;
+            const SourceStats& stats = clients[i].getStats();
+            slowest = max(slowest, stats.lastMs);
+            summed += stats.lastMs;
+            if (clients[i].getResult() != FETCH_OK) continue;
+            PriceSource* source = clients[i].getSource();
+            aggregator.add(source->getPrice(), source->getChange(), source->hasChange(), i);
+        }
+
+        bool agreed = aggregator.aggregate();
+        for (int i = 0; i < aggregator.getCount(); i++) {
+            if (aggregator.isOutlier(i)) clients[aggregator.getQuote(i).source].countOutlier();
+        }
+        if (!agreed) {
+            failAll();
+            return;
+        }
+        printScoreboard();
+
+        float change = 0;
+        if (aggregator.hasChange()) {
+            change = aggregator.getChange();
+            lastChange = change;
+            memcpy(lastChangePair, pair, sizeof(lastChangePair));
+        } else if (strcmp(lastChangePair, pair) == 0) {
+            change = lastChange;
+        }
+
+        ticker->setBootSplash(false);
+        ticker->setSplashActive(false);
+        if (onPriceUpdate != nullptr) {
+            onPriceUpdate(aggregator.getPrice(), change);
+        }
+        successCount++;
+        report(FETCH_OK);
+        Serial.printf("Fetch done in %lu ms, slowest source %lu ms, sum %lu ms, max step %lu us\n",
+                      millis() - fetchStart, slowest, summed, maxStepMicros);
+        printConnectionStats();
+    }
+
+    // One line per fetch, the price each source sent and how long it took
+    void printScoreboard() {
+        Serial.printf("Price %s:", pair);
+        for (int i = 0; i < aggregator.getCount(); i++) {
+            const Quote& quote = aggregator.getQuote(i);
+            char text[24];
+            quote.price.format(text, sizeof(text), PRICE_MAX_SCALE, sizeof(text));
+            Serial.printf(" %s %s (%lu ms)%s", getSourceName(quote.source), text,
+                          clients[quote.source].getStats().lastMs, aggregator.isOutlier(i) ? " outlier" : "");
+        }
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            if (started[i] && clients[i].getResult() != FETCH_OK) {
+                Serial.printf(" %s failed: %s", getSourceName(i), clients[i].getStats().lastError);
+            }
+        }
+        if (aggregator.getCount() - aggregator.getOutlierCount() > 0) {
+            Serial.printf(", using %s\n", getSourceName(aggregator.getSource()));
+        } else {
+            Serial.println(", none used");
+        }
+    }
+
+    // No source had a price, or the two that did disagreed. A pause
+    // asked for by any server wins, then connection trouble, so the poll
+    // scheduler backs off accordingly.
+    void failAll() {
+        FetchResult result = FETCH_FAILED;
+        long retryAfter = -1;
+        bool disagreed = aggregator.getCount() > 0;
+        const char* error = disagreed ? "Sources disagree" : nullptr;
+        if (disagreed) printScoreboard();
+        for (int i = 0; i < API_SOURCE_COUNT; i++) {
+            if (!started[i] || clients[i].getResult() == FETCH_OK) continue;
+            FetchResult sourceResult = clients[i].getResult();
+            if (sourceResult == FETCH_RATE_LIMITED) {
+                result = FETCH_RATE_LIMITED;
+                retryAfter = max(retryAfter, clients[i].getRetryAfter());
+            } else if (sourceResult == FETCH_UNREACHABLE && result == FETCH_FAILED) {
+                result = FETCH_UNREACHABLE;
+            }
+            // The preferred source's error is shown
+            if (error == nullptr) error = clients[i].getStats().lastError;
+            if (!disagreed) Serial.printf("%s failed: %s\n", getSourceName(i), clients[i].getStats().lastError);
+        }
+        fail(error != nullptr ? error : "Price pair not available", result, retryAfter);
+    }
+
+    void report(FetchResult result, long retryAfterMs = -1) {
+        if (onResult != nullptr) {
+            onResult(result, retryAfterMs);
+        }
+    }
+
+    void fail(const char* error, FetchResult result, long retryAfterMs = -1) {
+        busy = false;
+        failureCount++;
+        ticker->setBootSplash(false);
+        ticker->setSplashActive(false);
+        display->showError("API Error", error);
+        report(result, retryAfterMs);
+    }
 };
 
-#endif // API_HANDLER_H 
\ No newline at end of file
+#endif // API_HANDLER_H
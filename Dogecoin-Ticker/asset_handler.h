@@ -0,0 +1,181 @@
+#ifndef ASSET_HANDLER_H
+#define ASSET_HANDLER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "LittleFS.h"
+
+#define ASSET_INDEX "/index.html"
+#define ASSET_INDEX_GZ "/index.html.gz"
+#define ASSET_ETAG_FILE "/index.etag"       // Written by build_assets.py
+#define ASSET_MANIFEST_FILE "/build.manifest" // Build ETag, then the paths the build shipped
+#define ASSET_DIR "/assets/"                // Content-hashed files
+#define ASSET_ETAG_SIZE 40
+#define ASSET_PATH_SIZE 64
+#define ASSET_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define ASSET_CACHE_REVALIDATE "no-cache"
+
+// Every other file on LittleFS, the catch-all route. A file the build
+// shipped is only replaced by uploading another build, so it carries the
+// build's content hash as its ETag and a returning browser gets a 304.
+// Files written at runtime, like /boot.bin, are sent in full every time.
+class AssetFileHandler : public AsyncWebHandler {
+private:
+    char buildEtag[ASSET_ETAG_SIZE];
+    unsigned long notModified = 0;
+
+public:
+    AssetFileHandler() {
+        buildEtag[0] = '\0';
+    }
+
+    // The first line of the manifest
+    void loadEtag() {
+        buildEtag[0] = '\0';
+        File manifest = LittleFS.open(ASSET_MANIFEST_FILE, "r");
+        if (!manifest) return;
+        readLine(manifest, buildEtag, sizeof(buildEtag));
+    }
+
+    const char* getEtag() const { return buildEtag; }
+    unsigned long getNotModifiedCount() const { return notModified; }
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (request->method() != HTTP_GET) return false;
+        String path = filePath(request);
+        return LittleFS.exists(path.c_str()) || LittleFS.exists((path + ".gz").c_str());
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) override {
+        String path = filePath(request);
+        bool shipped = buildEtag[0] != '\0' && isShipped(path.c_str());
+        if (shipped && request->hasHeader("If-None-Match") &&
+            strstr(request->getHeader("If-None-Match")->value().c_str(), buildEtag) != nullptr) {
+            notModified++;
+            request->send(304);
+            return;
+        }
+
+        AsyncWebServerResponse* response = request->beginResponse(LittleFS, path);
+        response->addHeader("Cache-Control", ASSET_CACHE_REVALIDATE);
+        if (shipped) {
+            response->addHeader("ETag", buildEtag);
+        }
+        request->send(response);
+    }
+
+private:
+    static String filePath(AsyncWebServerRequest* request) {
+        String path = request->url();
+        if (path.endsWith("/")) path += "index.htm";
+        return path;
+    }
+
+    // Reads the manifest a line at a time, the list can be longer than
+    // is worth keeping in RAM
+    bool isShipped(const char* path) {
+        File manifest = LittleFS.open(ASSET_MANIFEST_FILE, "r");
+        if (!manifest) return false;
+        char line[ASSET_PATH_SIZE];
+        readLine(manifest, line, sizeof(line));     // The ETag
+        while (readLine(manifest, line, sizeof(line))) {
+            if (strcmp(line, path) == 0) return true;
+        }
+        return false;
+    }
+
+    // False at the end of the file. Longer lines are cut short.
+    static bool readLine(File& file, char* out, size_t size) {
+        size_t len = 0;
+        int c = file.read();
+        if (c < 0) return false;
+        while (c >= 0 && c != '\n') {
+            if (c != '\r' && len + 1 < size) out[len++] = c;
+            c = file.read();
+        }
+        out[len] = '\0';
+        return true;
+    }
+};
+
+// Serves the web UI as built by "LittleFS Data/build_assets.py". The
+// gzipped index page carries an ETag, so a returning browser gets a 304
+// and no body. The content-hashed files under /assets/ are cached for a
+// year and never revalidated, since a change gives them a new name.
+// Everything else goes through AssetFileHandler. An upload of the plain
+// data folder still works, just without ETags.
+class AssetHandler {
+private:
+    AssetFileHandler files;
+    char indexEtag[ASSET_ETAG_SIZE];
+    size_t indexSize = 0;           // Bytes on the wire for a full index response
+
+    unsigned long indexRequests = 0;
+    unsigned long notModified = 0;
+    unsigned long bytesSent = 0;
+
+public:
+    AssetHandler() {
+        indexEtag[0] = '\0';
+    }
+
+    // Call after LittleFS is mounted
+    void begin(AsyncWebServer* server) {
+        loadEtag();
+        files.loadEtag();
+        const char* indexPath = LittleFS.exists(ASSET_INDEX_GZ) ? ASSET_INDEX_GZ : ASSET_INDEX;
+        File index = LittleFS.open(indexPath, "r");
+        if (index) {
+            indexSize = index.size();
+            index.close();
+        }
+        Serial.printf("Web UI: %s, %u bytes, ETag %s, build %s\n", indexPath, (unsigned)indexSize,
+                      indexEtag[0] != '\0' ? indexEtag : "none", files.getEtag()[0] != '\0' ? files.getEtag() : "none");
+
+        ArRequestHandlerFunction onIndex = std::bind(&AssetHandler::handleIndex, this, std::placeholders::_1);
+        server->on("/", HTTP_GET, onIndex);
+        server->on(ASSET_INDEX, HTTP_GET, onIndex);
+        server->serveStatic(ASSET_DIR, LittleFS, ASSET_DIR, ASSET_CACHE_IMMUTABLE);
+    }
+
+    // The catch-all for the rest of LittleFS, added after every other
+    // route since handlers are tried in the order they were added
+    void serveFiles(AsyncWebServer* server) {
+        server->addHandler(&files);
+    }
+
+    unsigned long getIndexRequests() const { return indexRequests; }
+    unsigned long getNotModifiedCount() const { return notModified + files.getNotModifiedCount(); }
+    unsigned long getBytesSent() const { return bytesSent; }
+
+private:
+    void loadEtag() {
+        File file = LittleFS.open(ASSET_ETAG_FILE, "r");
+        if (!file) return;
+        size_t len = file.readBytes(indexEtag, ASSET_ETAG_SIZE - 1);
+        file.close();
+        while (len > 0 && (indexEtag[len - 1] == '\n' || indexEtag[len - 1] == '\r')) len--;
+        indexEtag[len] = '\0';
+    }
+
+    void handleIndex(AsyncWebServerRequest* request) {
+        indexRequests++;
+        if (indexEtag[0] != '\0' && request->hasHeader("If-None-Match") &&
+            strstr(request->getHeader("If-None-Match")->value().c_str(), indexEtag) != nullptr) {
+            notModified++;
+            request->send(304);
+            return;
+        }
+
+        // Picks up index.html.gz and sets Content-Encoding by itself
+        AsyncWebServerResponse* response = request->beginResponse(LittleFS, ASSET_INDEX, "text/html");
+        response->addHeader("Cache-Control", ASSET_CACHE_REVALIDATE);
+        if (indexEtag[0] != '\0') {
+            response->addHeader("ETag", indexEtag);
+        }
+        request->send(response);
+        bytesSent += indexSize;
+    }
+};
+
+#endif // ASSET_HANDLER_H
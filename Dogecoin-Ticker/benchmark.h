@@ -0,0 +1,305 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include "http_parser.h"
+#include "price_feed_parser.h"
+#include "display_handler.h"
+#include "websocket_handler.h"
+#include "ws_protocol.h"
+#include "telemetry.h"
+
+#define BENCH_RUNS 100
+#define BENCH_COMMAND "bench"
+#define BENCH_LINE_SIZE 16
+#define BENCH_READ_CHUNK 128        // Same slice size ApiHandler reads from the socket
+
+// A /v1/pricefeed body the size of the real one, 16 records
+static const char BENCH_FEED_BODY[] PROGMEM =
+    "[{\"pair\":\"DOGEUSD\",\"price\":\"0.06123\",\"percentChange24h\":\"-0.0123\"},"
+    "{\"pair\":\"DOGEEUR\",\"price\":\"0.05710\",\"percentChange24h\":\"-0.0119\"},"
+    "{\"pair\":\"DOGEGBP\",\"price\":\"0.04902\",\"percentChange24h\":\"-0.0131\"},"
+    "{\"pair\":\"DOGERUB\",\"price\":\"5.6120\",\"percentChange24h\":\"-0.0101\"},"
+    "{\"pair\":\"BTCUSD\",\"price\":\"29012.55\",\"percentChange24h\":\"0.0211\"},"
+    "{\"pair\":\"BTCEUR\",\"price\":\"27044.10\",\"percentChange24h\":\"0.0198\"},"
+    "{\"pair\":\"BTCGBP\",\"price\":\"23177.92\",\"percentChange24h\":\"0.0205\"},"
+    "{\"pair\":\"BTCRUB\",\"price\":\"2654010.00\",\"percentChange24h\":\"0.0240\"},"
+    "{\"pair\":\"LTCUSD\",\"price\":\"88.41\",\"percentChange24h\":\"0.0050\"},"
+    "{\"pair\":\"LTCEUR\",\"price\":\"82.40\",\"percentChange24h\":\"0.0047\"},"
+    "{\"pair\":\"LTCGBP\",\"price\":\"70.63\",\"percentChange24h\":\"0.0052\"},"
+    "{\"pair\":\"LTCRUB\",\"price\":\"8088.70\",\"percentChange24h\":\"0.0061\"},"
+    "{\"pair\":\"XMRUSD\",\"price\":\"158.20\",\"percentChange24h\":\"-0.0030\"},"
+    "{\"pair\":\"XMREUR\",\"price\":\"147.45\",\"percentChange24h\":\"-0.0028\"},"
+    "{\"pair\":\"XMRGBP\",\"price\":\"126.38\",\"percentChange24h\":\"-0.0033\"},"
+    "{\"pair\":\"XMRRUB\",\"price\":\"14473.00\",\"percentChange24h\":\"-0.0021\"}]";
+
+static const char BENCH_WS_MESSAGE[] PROGMEM =
+    "{\"states\":[{\"sender\":\"client\",\"currentCurrency\":\"EUR\",\"currentCrypto\":\"BTC\"}]}";
+
+typedef void (*BenchBody)(void* context);
+
+// On-device microbenchmarks for the hot paths of a ticker cycle.
+// Typing "bench" on the serial console runs every case and prints one
+// JSON line per case: timing percentiles in microseconds, the free heap
+// lost per run, which shows allocations that outlive a run, and for the
+// websocket cases the bytes one update puts on the wire.
+class BenchmarkHandler {
+private:
+    DisplayHandler* display;
+    WebSocketHandler* webSocket;
+    Telemetry* telemetry;
+    ApiHandler* api;
+    const TickerStateStore* ticker;
+    void (*onDone)() = nullptr;
+
+    char line[BENCH_LINE_SIZE];
+    size_t lineLen = 0;
+
+    unsigned long samples[BENCH_RUNS];
+
+    // Working state for the cases, only allocated while they run
+    struct Context {
+        BenchmarkHandler* self;
+        char* response;         // Canned chunked HTTP response
+        size_t responseLen;
+        char* scratch;          // Copy the HTTP parser compacts in place
+        char* body;             // Body as the socket would deliver it
+        size_t bodyLen;
+        HttpResponseParser http;
+        PriceFeedParser feed;
+        int iteration;
+        size_t bytes;           // Message size produced by the last run
+        uint32_t counters[CTR_COUNT];
+        uint32_t lastSent[CTR_COUNT];
+        uint8_t* logoRows;      // BTC logo uncoded, row-major as drawBitmap takes it
+    };
+
+public:
+    BenchmarkHandler(DisplayHandler* displayHandler, WebSocketHandler* webSocketHandler,
+                     Telemetry* telemetryCounters, ApiHandler* apiHandler, const TickerStateStore* tickerState)
+        : display(displayHandler), webSocket(webSocketHandler), telemetry(telemetryCounters),
+          api(apiHandler), ticker(tickerState) {}
+
+    // Called after a run so the sketch can redraw the current price
+    void setDoneCallback(void (*callback)()) {
+        onDone = callback;
+    }
+
+    // Reads serial input without blocking, runs on a "bench" line
+    void handle() {
+        while (Serial.available() > 0) {
+            char c = Serial.read();
+            if (c == '\r') continue;
+            if (c != '\n') {
+                if (lineLen < BENCH_LINE_SIZE - 1) line[lineLen++] = c;
+                continue;
+            }
+            line[lineLen] = '\0';
+            lineLen = 0;
+            if (strcmp(line, BENCH_COMMAND) == 0) {
+                runAll();
+            }
+        }
+    }
+
+    void runAll() {
+        Context* ctx = new Context();
+        ctx->self = this;
+        if (!prepare(ctx)) {
+            Serial.println("{\"bench\":\"error\",\"reason\":\"out of memory\"}");
+            release(ctx);
+            return;
+        }
+
+        run("http_response", benchHttpResponse, ctx);
+        run("feed_parse", benchFeedParse, ctx);
+        run("update_price", benchUpdatePrice, ctx);
+        run("coin_splash", benchCoinSplash, ctx);
+        run("logo_draw_bitmap", benchLogoBitmap, ctx);
+        run("logo_rle_decode", benchLogoDecode, ctx);
+        run("ws_states_json", benchWebSocketStates, ctx);
+        run("ws_state_binary", benchWebSocketStateBinary, ctx);
+        run("ws_telemetry_json", benchTelemetryJson, ctx);
+        run("ws_counters_delta", benchCountersDelta, ctx);
+        run("ws_message", benchWebSocketMessage, ctx);
+
+        release(ctx);
+        if (onDone != nullptr) {
+            onDone();
+        }
+    }
+
+private:
+    bool prepare(Context* ctx) {
+        ctx->bodyLen = strlen_P(BENCH_FEED_BODY);
+        ctx->body = (char*)malloc(ctx->bodyLen + 1);
+        size_t responseSize = ctx->bodyLen + 160;
+        ctx->response = (char*)malloc(responseSize);
+        ctx->scratch = (char*)malloc(responseSize);
+        ctx->logoRows = (uint8_t*)malloc(LOGO_BYTES);
+        if (ctx->body == nullptr || ctx->response == nullptr || ctx->scratch == nullptr ||
+            ctx->logoRows == nullptr) {
+            return false;
+        }
+        memcpy_P(ctx->body, BENCH_FEED_BODY, ctx->bodyLen + 1);
+
+        int headerLen = snprintf(ctx->response, responseSize,
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+            "Transfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n%x\r\n",
+            (unsigned)ctx->bodyLen);
+        memcpy(ctx->response + headerLen, ctx->body, ctx->bodyLen);
+        memcpy(ctx->response + headerLen + ctx->bodyLen, "\r\n0\r\n\r\n", 7);
+        ctx->responseLen = headerLen + ctx->bodyLen + 7;
+
+        // The logo the way it was stored before it was run-length coded
+        uint8_t pages[LOGO_BYTES];
+        drawRleLogo(pages, BTC_LOGO, sizeof(BTC_LOGO));
+        memset(ctx->logoRows, 0, LOGO_BYTES);
+        for (int y = 0; y < 32; y++) {
+            for (int x = 0; x < LOGO_WIDTH; x++) {
+                if (pages[(y / 8) * LOGO_WIDTH + x] & (1 << (y & 7))) {
+                    ctx->logoRows[y * 16 + x / 8] |= 0x80 >> (x & 7);
+                }
+            }
+        }
+        return true;
+    }
+
+    void release(Context* ctx) {
+        free(ctx->body);
+        free(ctx->response);
+        free(ctx->scratch);
+        free(ctx->logoRows);
+        delete ctx;
+    }
+
+    // Runs body BENCH_RUNS times and prints its percentiles as JSON
+    void run(const char* name, BenchBody body, Context* ctx) {
+        ctx->iteration = 0;
+        ctx->bytes = 0;
+        body(ctx);                  // Warm up caches and lazily built state
+
+        uint32_t heapBefore = ESP.getFreeHeap();
+        for (int i = 0; i < BENCH_RUNS; i++) {
+            ctx->iteration = i;
+            unsigned long start = micros();
+            body(ctx);
+            samples[i] = micros() - start;
+            yield();
+        }
+        long heapLost = (long)heapBefore - (long)ESP.getFreeHeap();
+
+        // Insertion sort, the sample count is small
+        for (int i = 1; i < BENCH_RUNS; i++) {
+            unsigned long value = samples[i];
+            int j = i - 1;
+            while (j >= 0 && samples[j] > value) {
+                samples[j + 1] = samples[j];
+                j--;
+            }
+            samples[j + 1] = value;
+        }
+
+        Serial.printf("{\"bench\":\"%s\",\"runs\":%d,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu,"
+                      "\"heap_lost_per_run\":%ld,\"bytes\":%u}\n",
+                      name, BENCH_RUNS, percentile(50), percentile(90), percentile(99),
+                      samples[BENCH_RUNS - 1], heapLost / BENCH_RUNS, (unsigned)ctx->bytes);
+    }
+
+    unsigned long percentile(int p) const {
+        int index = (BENCH_RUNS * p + 99) / 100 - 1;
+        return samples[index < 0 ? 0 : index];
+    }
+
+    // Header and chunk handling over the whole response, in socket-sized slices
+    static void benchHttpResponse(void* context) {
+        Context* ctx = (Context*)context;
+        memcpy(ctx->scratch, ctx->response, ctx->responseLen);
+        ctx->http.reset();
+        for (size_t offset = 0; offset < ctx->responseLen; offset += BENCH_READ_CHUNK) {
+            size_t len = ctx->responseLen - offset;
+            if (len > BENCH_READ_CHUNK) len = BENCH_READ_CHUNK;
+            ctx->http.feed(ctx->scratch + offset, len);
+        }
+    }
+
+    // Record splitting and filtered ArduinoJson deserialization of every record
+    static void benchFeedParse(void* context) {
+        Context* ctx = (Context*)context;
+        ctx->feed.begin("XMRRUB");
+        for (size_t offset = 0; offset < ctx->bodyLen; offset += BENCH_READ_CHUNK) {
+            size_t len = ctx->bodyLen - offset;
+            if (len > BENCH_READ_CHUNK) len = BENCH_READ_CHUNK;
+            ctx->feed.feed(ctx->body + offset, len);
+        }
+    }
+
+    // Static redraw and flush of the price screen for a changing price
+    static void benchUpdatePrice(void* context) {
+        Context* ctx = (Context*)context;
+        Price price;
+        price.parse(ctx->iteration % 2 == 0 ? "29012.55" : "29013.10");
+        ctx->self->display->updatePrice("BTC", "USD", price, 0.02f);
+    }
+
+    static void benchCoinSplash(void* context) {
+        Context* ctx = (Context*)context;
+        ctx->self->display->showCoinSplash(ctx->iteration % 2 == 0 ? "DOGE" : "BTC");
+    }
+
+    // Logo drawing without the flush: the uncoded logo through drawBitmap,
+    // then the coded one decoded into the buffer. bytes is what it takes in flash.
+    static void benchLogoBitmap(void* context) {
+        Context* ctx = (Context*)context;
+        Adafruit_SSD1306* panel = ctx->self->display->getPanel();
+        panel->clearDisplay();
+        panel->drawBitmap(0, 0, ctx->logoRows, 128, 32, WHITE);
+        ctx->bytes = LOGO_BYTES;
+    }
+
+    static void benchLogoDecode(void* context) {
+        Context* ctx = (Context*)context;
+        drawRleLogo(ctx->self->display->getPanel()->getBuffer(), BTC_LOGO, sizeof(BTC_LOGO));
+        ctx->bytes = sizeof(BTC_LOGO);
+    }
+
+    static void benchWebSocketStates(void* context) {
+        Context* ctx = (Context*)context;
+        char json[WS_JSON_SIZE];
+        ctx->bytes = ctx->self->webSocket->formatStates(json, sizeof(json));
+    }
+
+    static void benchWebSocketStateBinary(void* context) {
+        Context* ctx = (Context*)context;
+        uint8_t frame[8 + 2 * STATE_SYMBOL_SIZE];
+        ctx->bytes = WsProtocol::encodeState(frame, sizeof(frame), ctx->self->ticker->get());
+    }
+
+    // What a JSON client receives every telemetry interval
+    static void benchTelemetryJson(void* context) {
+        Context* ctx = (Context*)context;
+        char json[TELEMETRY_JSON_SIZE];
+        ctx->bytes = ctx->self->telemetry->toJson(json, sizeof(json), *ctx->self->api);
+    }
+
+    // What a binary client receives for the same interval: the counters
+    // are refreshed and only the ones that moved are encoded
+    static void benchCountersDelta(void* context) {
+        Context* ctx = (Context*)context;
+        ctx->self->telemetry->fillCounters(ctx->counters, *ctx->self->api);
+        uint8_t frame[WS_MAX_FRAME];
+        uint64_t changed = WsProtocol::changedCounters(ctx->counters, ctx->lastSent);
+        ctx->bytes = WsProtocol::encodeCounters(frame, sizeof(frame), ctx->counters, changed);
+    }
+
+    static void benchWebSocketMessage(void* context) {
+        Context* ctx = (Context*)context;
+        char message[sizeof(BENCH_WS_MESSAGE)];
+        memcpy_P(message, BENCH_WS_MESSAGE, sizeof(message));
+        String crypto;
+        String currency;
+        ctx->self->webSocket->parseClientState(message, crypto, currency);
+    }
+};
+
+#endif // BENCHMARK_H
@@ -3,149 +3,111 @@
 
 #include <Arduino.h>
 
-// Coin Logo Bitmaps (128x32px)
+// Coin logos (128x32px), run-length coded in display page order, see
+// logo_rle.h. Regenerate with "LittleFS Data/make_logo.py --c NAME".
+
 // DOGE Logo
-const unsigned char DOGE_LOGO [] PROGMEM = {
-  0xff, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe3, 0xff, 0xff,
-  0xff, 0x0f, 0xfe, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe1, 0xff, 0x8f,
-  0xff, 0x07, 0xfc, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe9, 0xff, 0x0f,
-  0xff, 0x27, 0xf8, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xec, 0xfe, 0x2f,
-  0xff, 0x23, 0xf1, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xec, 0xfc, 0x6f,
-  0xff, 0x30, 0x23, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xee, 0x00, 0xef,
-  0xff, 0x38, 0x07, 0x3c, 0xc6, 0x43, 0x31, 0x9f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xcf, 0xc1, 0xef,
-  0xfc, 0x3f, 0xff, 0x3c, 0xc6, 0x03, 0x31, 0x9f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x0f, 0xff, 0xcf,
-  0xf8, 0xff, 0xff, 0x3c, 0x84, 0x01, 0x21, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xfc, 0x3f, 0xff, 0xcf,
-  0xe1, 0xff, 0xff, 0x3c, 0x80, 0x11, 0x20, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xfc, 0xff, 0xff, 0xcf,
-  0xe7, 0xff, 0xff, 0x3c, 0x00, 0x11, 0x00, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xf9, 0xff, 0xff, 0xe7,
-  0xcc, 0xff, 0xff, 0x9c, 0x31, 0x01, 0x0c, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xf9, 0x1f, 0xff, 0xe3,
-  0xc8, 0x7c, 0xff, 0x9e, 0x31, 0x83, 0x8c, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xf3, 0x1f, 0x1f, 0xf3,
-  0x98, 0xf8, 0x3f, 0xce, 0x7b, 0xc7, 0x9e, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf3, 0x1e, 0x0f, 0xf3,
-  0x9c, 0xf8, 0x3f, 0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe7, 0xfe, 0x0f, 0xf9,
-  0x9f, 0xf8, 0x7f, 0xcf, 0xff, 0xff, 0xff, 0xef, 0xff, 0xff, 0xff, 0xff, 0xe7, 0xfe, 0x1f, 0xf9,
-  0xb0, 0x7f, 0xff, 0xef, 0xff, 0xff, 0xff, 0xef, 0xff, 0xff, 0xff, 0xff, 0xe4, 0x1f, 0xff, 0xf9,
-  0xb0, 0x7f, 0xff, 0xef, 0xff, 0xff, 0xff, 0xef, 0xff, 0xff, 0xff, 0xff, 0xe4, 0x0f, 0xff, 0xf9,
-  0xb0, 0x7f, 0xff, 0xef, 0xfe, 0x02, 0xdc, 0x61, 0xfc, 0x40, 0x62, 0x0c, 0x64, 0x0f, 0xff, 0xf9,
-  0xb0, 0x7f, 0xff, 0xef, 0xfe, 0x5a, 0xd9, 0xe5, 0xf9, 0x4b, 0x4b, 0xdb, 0x26, 0x1f, 0xff, 0xf9,
-  0xb9, 0xff, 0xff, 0xef, 0xfe, 0xda, 0xdb, 0xed, 0xfb, 0x5b, 0x5b, 0xb8, 0xe7, 0xff, 0xff, 0xf9,
-  0x91, 0xff, 0xff, 0xcf, 0xfe, 0xda, 0xdb, 0x6d, 0xfb, 0x5b, 0x5b, 0x7b, 0xa4, 0x1f, 0xff, 0xf9,
-  0x90, 0x03, 0xff, 0xcf, 0xfe, 0xdb, 0x1c, 0xed, 0xfc, 0x5b, 0x62, 0x0c, 0x70, 0x00, 0xff, 0xf3,
-  0x90, 0x03, 0xff, 0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf3, 0x00, 0xff, 0xf3,
-  0xcf, 0xff, 0xff, 0x9f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf1, 0xff, 0xff, 0xe3,
-  0xc7, 0xff, 0xff, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf9, 0xff, 0xff, 0xe7,
-  0xe3, 0xff, 0xff, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc, 0xff, 0xff, 0xcf,
-  0xf1, 0xff, 0xfc, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x7f, 0xff, 0x1f,
-  0xf8, 0xff, 0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f, 0xfe, 0x3f,
-  0xfc, 0x3f, 0xe1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x87, 0xf8, 0x7f,
-  0xff, 0x06, 0x03, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0, 0x01, 0xff,
-  0xff, 0xc0, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc, 0x0f, 0xff
+constexpr unsigned char DOGE_LOGO[] PROGMEM = {
+	0x84, 0xff, 0x80, 0x7f, 0x80, 0x00, 0x03, 0xf8, 0xe1, 0xc3, 0x8f, 0x82, 0x9f, 0x07, 0xbf, 0x9f,
+	0x8f, 0xc7, 0xe3, 0xf1, 0x01, 0x03, 0x82, 0xff, 0x80, 0x3f, 0x80, 0xff, 0x81, 0x3f, 0x80, 0xff,
+	0x80, 0x3f, 0x00, 0x7f, 0x82, 0x3f, 0x80, 0xff, 0x80, 0x3f, 0x80, 0xff, 0x81, 0x3f, 0x80, 0xff,
+	0x80, 0x3f, 0xab, 0xff, 0x80, 0x7f, 0x05, 0x3f, 0x00, 0xfc, 0xf8, 0xe1, 0xc7, 0x80, 0xdf, 0x82,
+	0x9f, 0x05, 0x8f, 0xc7, 0xe3, 0xf1, 0x79, 0x01, 0x83, 0xff, 0x07, 0x1f, 0x07, 0xe1, 0xf9, 0xcc,
+	0x84, 0x86, 0xef, 0x82, 0xff, 0x00, 0x1f, 0x80, 0x0f, 0x01, 0x1f, 0x9f, 0x84, 0xff, 0x03, 0xf8,
+	0xe0, 0x07, 0x1f, 0x80, 0xff, 0x03, 0xf0, 0xc0, 0xc3, 0xe0, 0x80, 0xf8, 0x0f, 0xe0, 0xc1, 0xe0,
+	0xf8, 0xf0, 0xe0, 0xc0, 0xc6, 0xc0, 0xe0, 0xf0, 0xff, 0xf0, 0xc0, 0xc3, 0xe0, 0x80, 0xf8, 0x05,
+	0xe0, 0xc1, 0xe0, 0xf8, 0xff, 0x7f, 0xa5, 0xff, 0x04, 0x3f, 0x0f, 0xc3, 0xf0, 0xfc, 0x80, 0xc6,
+	0x00, 0xc7, 0x82, 0xff, 0x00, 0x1f, 0x81, 0x0f, 0x00, 0x9f, 0x84, 0xff, 0x04, 0xfc, 0xf0, 0xc3,
+	0x07, 0x3f, 0x80, 0xff, 0x03, 0x00, 0x1f, 0xff, 0x10, 0x80, 0x00, 0x80, 0x30, 0x83, 0x3f, 0x8a,
+	0xff, 0x01, 0x1f, 0x00, 0x89, 0xff, 0x03, 0x83, 0xf3, 0xfb, 0x83, 0x80, 0xfb, 0x02, 0x83, 0xff,
+	0xc3, 0x80, 0xbf, 0x00, 0x83, 0x80, 0xff, 0x03, 0xc7, 0xb3, 0xbb, 0xdb, 0x80, 0xff, 0x03, 0x80,
+	0xf3, 0xfb, 0x83, 0x84, 0xff, 0x08, 0xc7, 0xb3, 0xbb, 0x83, 0xff, 0x83, 0xf3, 0xfb, 0x83, 0x80,
+	0xfb, 0x0d, 0x83, 0xff, 0xc7, 0xb3, 0xbb, 0x83, 0xff, 0xbb, 0x9b, 0xab, 0xb3, 0xbb, 0xff, 0xc7,
+	0x80, 0xab, 0x07, 0xb3, 0xd7, 0xff, 0xc0, 0x00, 0x3f, 0x98, 0x90, 0x81, 0x10, 0x00, 0x39, 0x82,
+	0x3f, 0x8a, 0xff, 0x02, 0x3f, 0x00, 0xc0, 0x81, 0xff, 0x05, 0xfc, 0xf8, 0xf1, 0xe3, 0xc7, 0xcf,
+	0x80, 0x9f, 0x81, 0x3f, 0x80, 0x7f, 0x82, 0x3f, 0x80, 0x9f, 0x05, 0x8f, 0xc7, 0xe7, 0xf1, 0xf8,
+	0xfc, 0xc7, 0xff, 0x04, 0xfe, 0xfc, 0xf8, 0xf3, 0xe7, 0x80, 0xcf, 0x80, 0x9f, 0x00, 0xbf, 0x84,
+	0x3f, 0x00, 0xbf, 0x80, 0x9f, 0x06, 0xcf, 0xc7, 0xe7, 0xf3, 0xf8, 0xfc, 0xfe, 0x80, 0xff
 };
 
-// Bitcoin Logo (128x32px)
-const unsigned char BTC_LOGO [] PROGMEM = {
-0x00, 0x0a, 0x80, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 
-	0x00, 0x44, 0x40, 0x00, 0x5c, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 
-	0x02, 0xaa, 0xa0, 0x00, 0x28, 0x00, 0x0a, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x80, 0x00, 
-	0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 
-	0x0a, 0xaa, 0xa8, 0x00, 0xa8, 0x00, 0x2a, 0x8a, 0x80, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x80, 0x00, 
-	0x04, 0x40, 0x44, 0x00, 0x58, 0x00, 0x1d, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x00, 
-	0x2a, 0xa2, 0x2a, 0x00, 0xa8, 0x00, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 
-	0x00, 0x10, 0x00, 0x00, 0x70, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x2a, 0x82, 0xaa, 0x80, 0xa8, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x04, 0x00, 0x44, 0x00, 0xd0, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x2a, 0xa0, 0x2a, 0x80, 0xaa, 0xa0, 0x2a, 0x2a, 0xa8, 0x0a, 0xa0, 0x2a, 0x80, 0x2a, 0x0a, 0xa8, 
-	0x00, 0x00, 0x10, 0x01, 0xff, 0xe0, 0x3c, 0x1f, 0xf0, 0x3f, 0xf0, 0x7f, 0xc0, 0x3c, 0x1f, 0xfc, 
-	0xaa, 0x82, 0x0a, 0x80, 0xaa, 0xa8, 0x2a, 0x2a, 0xa8, 0xaa, 0xa0, 0xaa, 0xa0, 0x2a, 0x2a, 0xaa, 
-	0x44, 0x44, 0x04, 0x41, 0xdd, 0xd0, 0x5c, 0x1d, 0xd0, 0xdd, 0xc1, 0xdd, 0xd0, 0x5c, 0x1d, 0xdc, 
-	0xaa, 0x82, 0x0a, 0xa2, 0xaa, 0xa8, 0x2a, 0x2a, 0xa0, 0xaa, 0xa2, 0xaa, 0xa8, 0x28, 0x2a, 0xaa, 
-	0x00, 0x00, 0x10, 0x01, 0xf0, 0xf8, 0x7c, 0x3c, 0x01, 0xf0, 0x03, 0xf1, 0xf0, 0x7c, 0x3c, 0x1f, 
-	0xaa, 0x88, 0x2a, 0x82, 0xa0, 0xa8, 0xa8, 0x28, 0x02, 0xa0, 0x02, 0xa0, 0xa8, 0xa8, 0x2a, 0x0a, 
-	0x44, 0x04, 0x04, 0x41, 0xc0, 0x58, 0x5c, 0x5c, 0x01, 0xc0, 0x05, 0xc0, 0xd8, 0x58, 0x5c, 0x1d, 
-	0xaa, 0x8a, 0x0a, 0xa2, 0xa0, 0xa8, 0xa8, 0x28, 0x02, 0xa0, 0x0a, 0x80, 0xa8, 0xa8, 0x28, 0x2a, 
-	0x00, 0x00, 0x00, 0x03, 0xc0, 0x78, 0x78, 0x78, 0x07, 0xc0, 0x07, 0x80, 0x70, 0x70, 0x7c, 0x1f, 
-	0xa8, 0x08, 0x0a, 0x82, 0x80, 0xa8, 0xa8, 0xa8, 0x02, 0x80, 0x0a, 0x80, 0xa8, 0xa8, 0xa8, 0x2a, 
-	0x44, 0x00, 0x04, 0x05, 0xc0, 0xd8, 0xd8, 0x58, 0x05, 0xc0, 0x05, 0x80, 0xd8, 0xd0, 0x58, 0x1c, 
-	0x2a, 0x80, 0x2a, 0x82, 0x80, 0xa8, 0xa8, 0xa8, 0x02, 0x80, 0x0a, 0x80, 0xa8, 0xa8, 0xa8, 0x2a, 
-	0x01, 0x00, 0x00, 0x07, 0xc1, 0xf1, 0xf0, 0x70, 0x07, 0xc0, 0x07, 0x81, 0xf1, 0xf0, 0x70, 0x3c, 
-	0x2a, 0x82, 0xaa, 0x8a, 0x80, 0xa8, 0xa8, 0xa8, 0x02, 0x80, 0x0a, 0x80, 0xa8, 0xa0, 0xa8, 0x2a, 
-	0x04, 0x40, 0x44, 0x05, 0x81, 0xd1, 0xd0, 0xd8, 0x05, 0xc0, 0x05, 0xc1, 0xc1, 0xd0, 0xd0, 0x5c, 
-	0x0a, 0xaa, 0xaa, 0x0a, 0x8a, 0xa0, 0xa0, 0xa8, 0x22, 0xa0, 0x8a, 0xa2, 0xa2, 0xa0, 0xa8, 0x2a, 
-	0x00, 0x00, 0x00, 0x07, 0xff, 0xc1, 0xf0, 0xff, 0xc3, 0xff, 0x87, 0xff, 0xc1, 0xe1, 0xf0, 0x7c, 
-	0x02, 0xaa, 0xa8, 0x0a, 0xaa, 0x82, 0xa0, 0xaa, 0xa2, 0xaa, 0x82, 0xaa, 0x82, 0xa0, 0xa0, 0xa8, 
-	0x00, 0x44, 0x40, 0x0d, 0xdd, 0x01, 0xc0, 0x5d, 0xc1, 0xdd, 0x81, 0xdd, 0x81, 0xc1, 0xd0, 0x5c, 
-	0x00, 0xaa, 0xa0, 0x0a, 0xaa, 0x02, 0xa0, 0x2a, 0xa0, 0xaa, 0x82, 0xaa, 0x02, 0xa2, 0xa0, 0xa8, 
-	0x00, 0x00, 0x00, 0x01, 0x70, 0x00, 0x00, 0x15, 0x00, 0x1d, 0x00, 0x74, 0x00, 0x00, 0x00, 0x00
+// Bitcoin Logo
+constexpr unsigned char BTC_LOGO[] PROGMEM = {
+	0x80, 0x00, 0x14, 0x40, 0x00, 0x50, 0x20, 0x54, 0x00, 0x54, 0x22, 0x54, 0x80, 0x15, 0x02, 0x55,
+	0x00, 0x15, 0x22, 0x54, 0x00, 0x50, 0x20, 0x40, 0x87, 0x00, 0x05, 0x50, 0xaa, 0xdc, 0xaa, 0x7f,
+	0x0a, 0x8a, 0x00, 0x06, 0x10, 0x28, 0x7f, 0x2a, 0x5d, 0x2a, 0x14, 0x80, 0x00, 0x05, 0x80, 0xf0,
+	0xa0, 0xd0, 0xa0, 0x10, 0xa7, 0x00, 0x06, 0x14, 0x28, 0x7f, 0x2a, 0x5d, 0x2a, 0x14, 0x8d, 0x00,
+	0x0a, 0x50, 0x20, 0x55, 0x00, 0x55, 0x22, 0x55, 0x00, 0x55, 0x20, 0x04, 0x80, 0x00, 0x0d, 0x20,
+	0x51, 0x00, 0x01, 0x02, 0x05, 0x88, 0x55, 0x22, 0x55, 0x00, 0x55, 0x20, 0x40, 0x81, 0x00, 0x0e,
+	0x40, 0xa8, 0xff, 0xaa, 0xdd, 0xaa, 0x7d, 0x28, 0x5c, 0x28, 0xfc, 0xa8, 0xdc, 0xa0, 0xd0, 0x82,
+	0x00, 0x05, 0xa0, 0xdc, 0xa8, 0xfc, 0xa8, 0x54, 0x81, 0x00, 0x0a, 0xd4, 0xaa, 0xff, 0xaa, 0x5d,
+	0x28, 0x7c, 0x28, 0x5c, 0x28, 0x14, 0x80, 0x00, 0x0c, 0x80, 0xf0, 0xa0, 0xd8, 0xa8, 0x7c, 0x28,
+	0x5c, 0x28, 0x7c, 0x28, 0x5c, 0x08, 0x80, 0x00, 0x0e, 0xc0, 0xa0, 0xf0, 0xa8, 0xdc, 0xa8, 0x7c,
+	0x28, 0x5c, 0xa8, 0xfc, 0xa8, 0xd0, 0xa0, 0x40, 0x82, 0x00, 0x05, 0xa0, 0xdc, 0xa8, 0xfc, 0xa8,
+	0x14, 0x81, 0x00, 0x16, 0xd0, 0xa8, 0xfc, 0xa8, 0x5c, 0x28, 0x7c, 0x28, 0x5c, 0xa8, 0xfc, 0xa8,
+	0xd0, 0x80, 0x15, 0x22, 0x55, 0x00, 0x55, 0x22, 0x45, 0x80, 0x45, 0x81, 0x00, 0x02, 0x15, 0x02,
+	0x04, 0x81, 0x00, 0x08, 0x41, 0x00, 0x55, 0x22, 0x55, 0x00, 0x55, 0x02, 0x04, 0x80, 0x00, 0x05,
+	0xa0, 0xdd, 0xaa, 0xff, 0xaa, 0x05, 0x82, 0x00, 0x05, 0x80, 0xf5, 0xaa, 0xdd, 0xaa, 0x7f, 0x80,
+	0x00, 0x06, 0x80, 0xf5, 0xaa, 0xdd, 0xaa, 0x7f, 0x02, 0x80, 0x00, 0x05, 0x50, 0xaa, 0xdd, 0xaa,
+	0x7f, 0x02, 0x85, 0x00, 0x05, 0xa8, 0xdd, 0xaa, 0xff, 0xaa, 0x05, 0x87, 0x00, 0x06, 0x54, 0xaa,
+	0xdd, 0xaa, 0xff, 0x02, 0x01, 0x82, 0x00, 0x05, 0x80, 0xf7, 0xaa, 0xdd, 0xaa, 0x77, 0x80, 0x00,
+	0x05, 0x80, 0xf5, 0xaa, 0xdd, 0xaa, 0x57, 0x81, 0x00, 0x06, 0x50, 0xaa, 0xdd, 0xaa, 0x7f, 0x0a,
+	0x01, 0x81, 0x00, 0x05, 0xd4, 0xaa, 0xff, 0xaa, 0x5d, 0x0a, 0x80, 0x00, 0x16, 0x01, 0x00, 0x05,
+	0x02, 0x15, 0x00, 0x55, 0x22, 0x54, 0x00, 0x54, 0x20, 0x55, 0x00, 0x55, 0x22, 0x55, 0x00, 0x15,
+	0x02, 0x05, 0x00, 0x01, 0x81, 0x00, 0x18, 0x75, 0x2a, 0x5d, 0xaa, 0x7f, 0xa8, 0xd8, 0xa8, 0x7c,
+	0x28, 0x5c, 0x2a, 0x1f, 0x0a, 0x05, 0x02, 0x01, 0x00, 0x50, 0x2a, 0x7f, 0x2a, 0x5d, 0x0a, 0x01,
+	0x81, 0x00, 0x0a, 0x1f, 0x2a, 0x5d, 0xaa, 0x7f, 0xa8, 0x58, 0xa8, 0x78, 0x28, 0x54, 0x80, 0x00,
+	0x0b, 0x02, 0x1d, 0x2a, 0x7f, 0x2a, 0x5c, 0xa8, 0xf8, 0xa8, 0x58, 0xa8, 0x7c, 0x81, 0x00, 0x17,
+	0x05, 0x0a, 0x5d, 0x2a, 0x7f, 0xaa, 0xdc, 0xa8, 0x78, 0xa8, 0x5c, 0x2a, 0x3f, 0x0a, 0x05, 0x00,
+	0x01, 0x00, 0x54, 0x2a, 0x7f, 0x2a, 0x5d, 0x02, 0x80, 0x00, 0x06, 0x40, 0x28, 0x7f, 0x2a, 0x5d,
+	0x2a, 0x05, 0x81, 0x00, 0x07, 0x50, 0x2a, 0x5d, 0x2a, 0x7f, 0x2a, 0x05, 0x00
 };
 
-// Litecoin Logo (128x32px)
-const unsigned char LTC_LOGO[] PROGMEM = {
-  0x00, 0x01, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x1f, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x7f, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x01, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x03, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x07, 0xff, 0x83, 0xfe, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 
-	0x0f, 0xff, 0x03, 0xff, 0x00, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x00, 
-	0x1f, 0xff, 0x03, 0xff, 0x80, 0x04, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x3f, 0xff, 0x07, 0xff, 0xc0, 0x04, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x3f, 0xfe, 0x07, 0xff, 0xc0, 0x04, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x7f, 0xfe, 0x07, 0xff, 0xe0, 0x0c, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x7f, 0xfe, 0x0f, 0xff, 0xe0, 0x0c, 0x10, 0x20, 0x0f, 0xe0, 0x1f, 0xc0, 0x3f, 0x01, 0x82, 0x7c, 
-	0x7f, 0xfc, 0x0f, 0xff, 0xe0, 0x08, 0x10, 0x7c, 0x18, 0x30, 0x30, 0x60, 0x40, 0x81, 0x87, 0x06, 
-	0x7f, 0xfc, 0x0f, 0xff, 0xf0, 0x08, 0x10, 0x60, 0x30, 0x10, 0x60, 0x20, 0x80, 0x41, 0x06, 0x03, 
-	0xff, 0xfc, 0x03, 0xff, 0xf0, 0x08, 0x10, 0x40, 0x20, 0x18, 0x40, 0x31, 0x80, 0x41, 0x06, 0x03, 
-	0xff, 0xf8, 0x07, 0xff, 0xf0, 0x08, 0x30, 0x40, 0x20, 0x18, 0x40, 0x01, 0x00, 0x41, 0x04, 0x03, 
-	0xff, 0xe0, 0x1f, 0xff, 0xf0, 0x08, 0x30, 0x40, 0x60, 0x38, 0xc0, 0x01, 0x00, 0x41, 0x04, 0x03, 
-	0xff, 0xc0, 0x3f, 0xff, 0xf0, 0x18, 0x20, 0x40, 0x43, 0xc0, 0x80, 0x01, 0x00, 0x41, 0x04, 0x02, 
-	0x7f, 0xc0, 0x3f, 0xff, 0xf0, 0x18, 0x20, 0x40, 0x7e, 0x00, 0x80, 0x01, 0x00, 0xc3, 0x04, 0x02, 
-	0x7f, 0xf0, 0x3f, 0xff, 0xe0, 0x10, 0x20, 0xc0, 0x60, 0x00, 0x80, 0x03, 0x00, 0xc3, 0x0c, 0x02, 
-	0x7f, 0xf0, 0x7f, 0xff, 0xe0, 0x10, 0x20, 0xc0, 0x40, 0x00, 0x80, 0x03, 0x00, 0x82, 0x0c, 0x02, 
-	0x7f, 0xe0, 0x7f, 0xff, 0xe0, 0x10, 0x20, 0x80, 0x40, 0x00, 0x80, 0x03, 0x00, 0x82, 0x08, 0x02, 
-	0x3f, 0xe0, 0x00, 0x1f, 0xc0, 0x10, 0x60, 0x80, 0x40, 0x20, 0x80, 0x43, 0x00, 0x82, 0x08, 0x06, 
-	0x3f, 0xe0, 0x00, 0x1f, 0xc0, 0x10, 0x60, 0x80, 0x60, 0x60, 0xc0, 0xc1, 0x01, 0x02, 0x08, 0x06, 
-	0x1f, 0xc0, 0x00, 0x1f, 0x80, 0x30, 0x60, 0xc0, 0x30, 0xc0, 0x61, 0x81, 0x86, 0x02, 0x08, 0x04, 
-	0x0f, 0xc0, 0x00, 0x3f, 0x00, 0x00, 0x40, 0x70, 0x1f, 0x00, 0x3e, 0x00, 0x78, 0x02, 0x08, 0x04, 
-	0x07, 0xff, 0xff, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x03, 0xff, 0xff, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x01, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x7f, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x1f, 0xff, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x01, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+// Litecoin Logo
+constexpr unsigned char LTC_LOGO[] PROGMEM = {
+	0x81, 0x00, 0x03, 0x80, 0xc0, 0xe0, 0xf0, 0x80, 0xf8, 0x80, 0xfc, 0x82, 0xfe, 0x01, 0xff, 0x3f,
+	0x82, 0x1f, 0x00, 0x1e, 0x81, 0xfe, 0x80, 0xfc, 0x80, 0xf8, 0x03, 0xf0, 0xe0, 0xc0, 0x80, 0x8a,
+	0x00, 0x00, 0xe0, 0x84, 0x00, 0x00, 0x60, 0x83, 0x00, 0x00, 0x80, 0xb3, 0x00, 0x80, 0x60, 0x8c,
+	0x00, 0x01, 0xc0, 0xfc, 0x89, 0xff, 0x02, 0x7f, 0x0f, 0x01, 0x82, 0x00, 0x01, 0x38, 0xbf, 0x8a,
+	0xff, 0x01, 0xfc, 0xe0, 0x86, 0x00, 0x01, 0xfc, 0x0f, 0x82, 0x00, 0x01, 0x80, 0xf8, 0x83, 0x00,
+	0x01, 0xf0, 0x3f, 0x81, 0x10, 0x82, 0x00, 0x02, 0xe0, 0x30, 0x18, 0x83, 0x08, 0x02, 0x18, 0xf0,
+	0xc0, 0x82, 0x00, 0x02, 0xe0, 0x30, 0x18, 0x83, 0x08, 0x02, 0x18, 0x70, 0x40, 0x81, 0x00, 0x02,
+	0xc0, 0x60, 0x10, 0x84, 0x08, 0x01, 0x10, 0xe0, 0x83, 0x00, 0x01, 0xf8, 0x18, 0x82, 0x00, 0x03,
+	0xf0, 0x78, 0x10, 0x00, 0x82, 0x08, 0x04, 0x18, 0xf0, 0xe0, 0x03, 0x3f, 0x86, 0xff, 0x01, 0xf9,
+	0x18, 0x83, 0x00, 0x01, 0x30, 0x3e, 0x86, 0x3f, 0x85, 0xff, 0x01, 0x3f, 0x07, 0x85, 0x00, 0x01,
+	0xfe, 0x07, 0x82, 0x00, 0x02, 0xc0, 0xff, 0x01, 0x82, 0x00, 0x01, 0xf8, 0x1f, 0x85, 0x00, 0x01,
+	0xff, 0x8d, 0x81, 0x04, 0x00, 0x06, 0x80, 0x02, 0x01, 0x82, 0xc1, 0x80, 0x01, 0x81, 0x00, 0x01,
+	0xff, 0x81, 0x84, 0x00, 0x01, 0x80, 0xc0, 0x82, 0x00, 0x01, 0x78, 0xff, 0x85, 0x00, 0x02, 0x80,
+	0x7c, 0x0f, 0x82, 0x00, 0x01, 0xfc, 0x0f, 0x82, 0x00, 0x01, 0xf8, 0x1f, 0x85, 0x00, 0x02, 0xc0,
+	0xff, 0x01, 0x81, 0x00, 0x03, 0x01, 0x03, 0x07, 0x0f, 0x80, 0x1f, 0x01, 0x3f, 0x3c, 0x82, 0x7c,
+	0x84, 0xfc, 0x82, 0x7c, 0x01, 0x3c, 0x3e, 0x80, 0x1f, 0x03, 0x0f, 0x07, 0x03, 0x01, 0x87, 0x00,
+	0x80, 0x01, 0x83, 0x00, 0x01, 0x03, 0x01, 0x83, 0x00, 0x01, 0x01, 0x03, 0x80, 0x02, 0x84, 0x00,
+	0x01, 0x01, 0x03, 0x82, 0x02, 0x80, 0x01, 0x85, 0x00, 0x01, 0x01, 0x03, 0x82, 0x02, 0x80, 0x01,
+	0x84, 0x00, 0x80, 0x01, 0x82, 0x02, 0x80, 0x01, 0x85, 0x00, 0x00, 0x03, 0x83, 0x00, 0x00, 0x03,
+	0x86, 0x00, 0x00, 0x03, 0x80, 0x00
 };
 
-// Monero Logo (128x32px)
-const unsigned char XMR_LOGO[] PROGMEM = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x2a, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x51, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x02, 0xaa, 0xaa, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x04, 0x44, 0x44, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x0a, 0xaa, 0xaa, 0xa8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x01, 0x11, 0x11, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x08, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x04, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x28, 0x2a, 0xaa, 0x8a, 0x00, 0x20, 0x20, 0x02, 0x00, 0x20, 0x20, 0xaa, 0x02, 0xa0, 0x00, 0x00, 
-	0x10, 0x11, 0x10, 0x01, 0x00, 0x70, 0x38, 0x07, 0xc0, 0x70, 0x10, 0xff, 0x87, 0xf8, 0x07, 0xf0, 
-	0x28, 0x0a, 0xaa, 0x0a, 0x80, 0xa0, 0x28, 0x0a, 0xa8, 0x28, 0x28, 0xaa, 0x8a, 0xae, 0x0e, 0xa8, 
-	0x44, 0x04, 0x40, 0x04, 0x00, 0x50, 0x58, 0x30, 0x1c, 0x5c, 0x10, 0xc0, 0x04, 0x04, 0x18, 0x1c, 
-	0x28, 0x02, 0xa0, 0x0a, 0x80, 0xa8, 0x28, 0x20, 0x0a, 0x2a, 0x28, 0xa0, 0x0a, 0x0a, 0x28, 0x0a, 
-	0x50, 0x01, 0x00, 0x01, 0x00, 0xd8, 0x58, 0x60, 0x04, 0x76, 0x10, 0x40, 0x04, 0x04, 0x30, 0x06, 
-	0xa8, 0x20, 0x80, 0x8a, 0x80, 0x88, 0xe8, 0xa0, 0x0e, 0x22, 0x28, 0xaa, 0x8a, 0xac, 0x20, 0x0a, 
-	0x44, 0x20, 0x01, 0x04, 0x00, 0xcc, 0xcc, 0x40, 0x04, 0x63, 0x10, 0xdd, 0x85, 0xd0, 0x60, 0x06, 
-	0x28, 0x28, 0x02, 0x0a, 0x80, 0x8a, 0x8a, 0x20, 0x0a, 0x22, 0xa8, 0xa0, 0x0a, 0x28, 0x20, 0x02, 
-	0x54, 0x3c, 0x05, 0x05, 0x01, 0x85, 0x84, 0x70, 0x0c, 0x71, 0xd0, 0xc0, 0x04, 0x18, 0x30, 0x04, 
-	0x08, 0x2a, 0x0a, 0x88, 0x80, 0x8a, 0x8e, 0x28, 0x08, 0x20, 0xa8, 0xc0, 0x0a, 0x08, 0x28, 0x0c, 
-	0x00, 0x1d, 0x1d, 0x00, 0x01, 0x85, 0x04, 0x1c, 0x78, 0x60, 0x50, 0xc4, 0x04, 0x0c, 0x1c, 0x5c, 
-	0x00, 0x2a, 0xaa, 0x00, 0x03, 0x83, 0x8e, 0x0b, 0xe0, 0x20, 0x38, 0xbf, 0x8e, 0x0e, 0x0b, 0xe8, 
-	0x00, 0x37, 0x77, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x0a, 0xaa, 0xaa, 0xae, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x05, 0xdd, 0xdd, 0xdc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x02, 0xaa, 0xaa, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x01, 0xf7, 0x77, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0xea, 0xaa, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x1f, 0xdc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x02, 0xa8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0000, 0xFF
+// Monero Logo
+constexpr unsigned char XMR_LOGO[] PROGMEM = {
+	0x82, 0x00, 0x19, 0x40, 0x20, 0x50, 0x80, 0x50, 0x28, 0x54, 0x88, 0x54, 0x20, 0x54, 0x88, 0x54,
+	0x22, 0x54, 0x88, 0x54, 0x20, 0x54, 0x88, 0x50, 0x20, 0x50, 0x80, 0x40, 0x80, 0xe1, 0x00, 0x04,
+	0xa0, 0x54, 0x88, 0x55, 0x22, 0x80, 0x00, 0x18, 0x01, 0x02, 0x05, 0x08, 0x15, 0x22, 0x55, 0x88,
+	0x55, 0x22, 0x55, 0x08, 0x15, 0x02, 0x15, 0x00, 0x05, 0x02, 0x01, 0x00, 0x55, 0x22, 0x55, 0x88,
+	0x50, 0x85, 0x00, 0x04, 0xd0, 0xa8, 0x5c, 0xa8, 0xc0, 0x82, 0x00, 0x03, 0xa0, 0x5c, 0xa8, 0xf8,
+	0x82, 0x00, 0x0d, 0x80, 0xe0, 0x20, 0x10, 0x08, 0x1c, 0x08, 0x18, 0x08, 0x10, 0x20, 0x70, 0xa0,
+	0x40, 0x80, 0x00, 0x05, 0xa8, 0xdc, 0xa8, 0x70, 0xa0, 0xc0, 0x81, 0x00, 0x02, 0x54, 0xa8, 0x50,
+	0x81, 0x00, 0x08, 0x7c, 0xa8, 0x5c, 0x08, 0x1c, 0x08, 0x1c, 0x08, 0x18, 0x81, 0x00, 0x0a, 0x50,
+	0xa8, 0x5c, 0x08, 0x1c, 0x08, 0x1c, 0x08, 0x58, 0xb0, 0x50, 0x81, 0x00, 0x02, 0xc0, 0xa0, 0x70,
+	0x80, 0x18, 0x0e, 0x08, 0x18, 0x08, 0x18, 0x28, 0x70, 0xa0, 0xc0, 0x00, 0x01, 0x0a, 0x05, 0x08,
+	0x15, 0x0a, 0x82, 0x00, 0x0e, 0xdf, 0xa8, 0x7c, 0xa8, 0xd0, 0xa0, 0x41, 0x80, 0xc0, 0xa0, 0x70,
+	0xa8, 0xd4, 0xaa, 0x11, 0x81, 0x00, 0x04, 0x15, 0x0a, 0x05, 0x08, 0x15, 0x83, 0x00, 0x03, 0x40,
+	0xe8, 0x7f, 0x02, 0x80, 0x00, 0x11, 0x17, 0x2a, 0x54, 0x68, 0x5f, 0x03, 0x01, 0x00, 0x57, 0x7a,
+	0x54, 0x00, 0x01, 0x0a, 0x1d, 0x28, 0x70, 0x20, 0x81, 0x40, 0x80, 0x60, 0x03, 0x20, 0x3d, 0x0b,
+	0x05, 0x80, 0x00, 0x02, 0x2a, 0x7f, 0x08, 0x80, 0x00, 0x06, 0x07, 0x0a, 0x1c, 0x28, 0x55, 0xea,
+	0x55, 0x81, 0x00, 0x08, 0x7f, 0x3a, 0x45, 0x42, 0x43, 0x62, 0x41, 0x42, 0x43, 0x81, 0x00, 0x0a,
+	0x55, 0x6a, 0x55, 0x02, 0x03, 0x02, 0x05, 0x0a, 0x7d, 0x61, 0x40, 0x80, 0x00, 0x04, 0x02, 0x1f,
+	0x28, 0x70, 0x20, 0x81, 0x40, 0x05, 0x60, 0x40, 0x20, 0x71, 0x3a, 0x07, 0x83, 0x00, 0x1a, 0x01,
+	0x02, 0x05, 0x0a, 0x1f, 0x1a, 0x1d, 0x2a, 0x37, 0x2a, 0x7d, 0x2a, 0x77, 0x2a, 0x5d, 0x2a, 0x77,
+	0x2a, 0x1d, 0x0a, 0x17, 0x0a, 0x0d, 0x06, 0x07, 0x03, 0x01, 0xdf, 0x00
 };
 
-#endif // BITMAPS_H 
\ No newline at end of file
+#endif // BITMAPS_H
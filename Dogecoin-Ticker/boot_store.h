@@ -0,0 +1,172 @@
+#ifndef BOOT_STORE_H
+#define BOOT_STORE_H
+
+#include <Arduino.h>
+#include "LittleFS.h"
+#include "price.h"
+#include "ticker_state.h"
+
+#define BOOT_FILE "/boot.bin"
+#define BOOT_MAGIC 0x32544F42UL             // "BOT2", no DHCP lease
+#define BOOT_RTC_OFFSET 32                  // RTC user memory blocks; the first 128 bytes belong to OTA
+#define BOOT_SAVE_INTERVAL 600000           // Price changes reach flash at most this often (ms)
+
+// Bits in BootRecord::flags
+#define BOOT_HAS_WIFI 0x01                  // bssid and channel are set
+#define BOOT_HAS_PAIR 0x04
+#define BOOT_HAS_PRICE 0x08
+#define BOOT_HAS_POLL 0x10                  // pollMin and pollMax are set
+
+// What the next boot needs to show a price before the first fetch and
+// to skip the Wi-Fi scan. A multiple of 4 bytes for RTC memory.
+struct BootRecord {
+    uint32_t magic;
+    uint16_t pollMin;                       // Fetch interval bounds (s)
+    uint16_t pollMax;
+    int64_t mantissa;                       // Last price of the pair
+    int16_t change;                         // 24h change in basis points
+    uint8_t scale;
+    uint8_t flags;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    char crypto[STATE_SYMBOL_SIZE];
+    char fiat[STATE_SYMBOL_SIZE];
+    uint32_t hash;                          // FNV-1a of everything above
+};
+static_assert(sizeof(BootRecord) % 4 == 0, "BootRecord must fill whole RTC blocks");
+
+// Keeps the boot record in RTC memory, which survives resets and OTA
+// restarts, and in LittleFS for power cycles. RTC memory is written on
+// every change. The file is rewritten at once when the access point or
+// pair changes, and price updates are held back to BOOT_SAVE_INTERVAL.
+class BootStore {
+private:
+    BootRecord record;
+    bool fileDirty = false;
+    unsigned long lastFileSave = 0;
+
+public:
+    BootStore() {
+        memset(&record, 0, sizeof(record));
+    }
+
+    // Reads RTC memory, then the file. LittleFS must be mounted for the
+    // file; without it only a warm restart finds a record.
+    bool begin() {
+        if (ESP.rtcUserMemoryRead(BOOT_RTC_OFFSET, (uint32_t*)&record, sizeof(record)) && valid()) {
+            return true;
+        }
+
+        File file = LittleFS.open(BOOT_FILE, "r");
+        if (file) {
+            bool read = file.read((uint8_t*)&record, sizeof(record)) == sizeof(record);
+            file.close();
+            if (read && valid()) return true;
+        }
+        memset(&record, 0, sizeof(record));
+        return false;
+    }
+
+    bool has(uint8_t flag) const {
+        return (record.flags & flag) != 0;
+    }
+
+    const BootRecord& get() const {
+        return record;
+    }
+
+    Price getPrice() const {
+        Price price;
+        price.mantissa = record.mantissa;
+        price.scale = record.scale;
+        return price;
+    }
+
+    float getChange() const {
+        return record.change / 10000.0f;
+    }
+
+    void saveWiFi(const uint8_t* bssid, uint8_t channel) {
+        bool moved = !has(BOOT_HAS_WIFI) || channel != record.channel || memcmp(bssid, record.bssid, 6) != 0;
+        memcpy(record.bssid, bssid, 6);
+        record.channel = channel;
+        record.flags |= BOOT_HAS_WIFI;
+        save(moved);
+    }
+
+    void savePair(const char* crypto, const char* fiat) {
+        if (has(BOOT_HAS_PAIR) && strcmp(crypto, record.crypto) == 0 && strcmp(fiat, record.fiat) == 0) return;
+        snprintf(record.crypto, sizeof(record.crypto), "%s", crypto);
+        snprintf(record.fiat, sizeof(record.fiat), "%s", fiat);
+        record.flags |= BOOT_HAS_PAIR;
+        record.flags &= ~BOOT_HAS_PRICE;    // The old price belongs to the old pair
+        save(true);
+    }
+
+    // Price of the saved pair
+    void savePrice(const Price& price, float change) {
+        float basisPoints = change * 10000.0f;
+        if (basisPoints > INT16_MAX) basisPoints = INT16_MAX;
+        if (basisPoints < INT16_MIN) basisPoints = INT16_MIN;
+
+        record.mantissa = price.mantissa;
+        record.scale = price.scale;
+        record.change = (int16_t)lroundf(basisPoints);
+        record.flags |= BOOT_HAS_PRICE;
+        save(false);
+    }
+
+    // Fetch interval bounds set from the web UI
+    void savePollBounds(uint32_t minMs, uint32_t maxMs) {
+        record.pollMin = (uint16_t)min(minMs / 1000, (uint32_t)UINT16_MAX);
+        record.pollMax = (uint16_t)min(maxMs / 1000, (uint32_t)UINT16_MAX);
+        record.flags |= BOOT_HAS_POLL;
+        save(true);
+    }
+
+    // Writes a held-back price once the interval has passed
+    void handle() {
+        if (fileDirty && millis() - lastFileSave >= BOOT_SAVE_INTERVAL) {
+            writeFile();
+        }
+    }
+
+private:
+    void save(bool fileNow) {
+        record.magic = BOOT_MAGIC;
+        record.hash = hash();
+        ESP.rtcUserMemoryWrite(BOOT_RTC_OFFSET, (uint32_t*)&record, sizeof(record));
+        fileDirty = true;
+        if (fileNow) writeFile();
+    }
+
+    void writeFile() {
+        lastFileSave = millis();
+        File file = LittleFS.open(BOOT_FILE, "w");
+        if (!file) {
+            Serial.println("Boot: could not write " BOOT_FILE);
+            return;
+        }
+        file.write((const uint8_t*)&record, sizeof(record));
+        file.close();
+        fileDirty = false;
+    }
+
+    bool valid() const {
+        return record.magic == BOOT_MAGIC && record.hash == hash() &&
+               memchr(record.crypto, '\0', sizeof(record.crypto)) != nullptr &&
+               memchr(record.fiat, '\0', sizeof(record.fiat)) != nullptr;
+    }
+
+    uint32_t hash() const {
+        const uint8_t* data = (const uint8_t*)&record;
+        uint32_t value = 2166136261UL;
+        for (size_t i = 0; i < offsetof(BootRecord, hash); i++) {
+            value = (value ^ data[i]) * 16777619UL;
+        }
+        return value;
+    }
+};
+
+#endif // BOOT_STORE_H
@@ -2,15 +2,27 @@
 #define BUTTON_HANDLER_H
 
 #include <Arduino.h>
+#include <coredecls.h>
+
+extern "C" {
+#include "user_interface.h"
+#include "gpio.h"
+}
 
 // Button Definitions
 #define BUTTON_PIN 0  // GPIO0 (D3)
 #define LONG_PRESS_DURATION 1000  // Duration for long press in milliseconds
+#define VERY_LONG_PRESS_DURATION 3000  // Duration for very long press in milliseconds
+#define DEBOUNCE_DELAY 50  // Debounce time in milliseconds
 
+// Edges are also caught by an interrupt, so a press during a power nap
+// ends the nap and debouncing starts from the edge, not from the pass
+// that noticed it. The interrupt also times whole presses, so a short
+// press that begins and ends during one blocking step, such as a TLS
+// handshake, still counts.
 class ButtonHandler {
   private:
     unsigned long lastDebounceTime = 0;
-    unsigned long debounceDelay = 50;    // Debounce time in milliseconds
     unsigned long pressStartTime = 0;     // When the button was pressed
     bool isPressing = false;              // Track if button is being held
     int lastButtonState = HIGH;          // Previous button reading
@@ -20,12 +32,65 @@ class ButtonHandler {
     void (*onShortPress)() = nullptr;
     void (*onLongPress)() = nullptr;
     void (*onPressing)() = nullptr;      // Called while button is being held
+    void (*onVeryLongPress)() = nullptr;
+
+    // Written by the interrupt
+    static inline volatile unsigned long edgeTime = 0;
+    static inline volatile bool edgePending = false;
+    static inline volatile unsigned long downEdgeTime = 0;
+    static inline volatile bool downEdgeSeen = false;
+    static inline volatile unsigned long latchedPressMs = 0;  // A press seen from edge to edge, 0 if none
+
+    static void IRAM_ATTR onEdge() {
+      unsigned long now = millis();
+      edgeTime = now;
+      edgePending = true;
+      // Edges closer than the debounce time are contact bounce
+      if (digitalRead(BUTTON_PIN) == LOW) {
+        downEdgeTime = now;
+        downEdgeSeen = true;
+      } else if (downEdgeSeen && now - downEdgeTime > DEBOUNCE_DELAY) {
+        latchedPressMs = now - downEdgeTime;
+        downEdgeSeen = false;
+      }
+      esp_schedule();  // Ends a nap in progress
+    }
 
   public:
     ButtonHandler() {}
 
     void begin() {
       pinMode(BUTTON_PIN, INPUT_PULLUP);  // Enable internal pull-up resistor
+      attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onEdge, CHANGE);
+    }
+
+    // Held, bouncing or an edge not handled yet
+    bool isActive() const {
+      return edgePending || buttonState == LOW || lastButtonState == LOW ||
+             (millis() - lastDebounceTime) <= DEBOUNCE_DELAY;
+    }
+
+    static bool hasEdge() {
+      return edgePending;
+    }
+
+    static bool isDown() {
+      return digitalRead(BUTTON_PIN) == LOW;
+    }
+
+    // A press wakes the CPU from light sleep. Only while the button is
+    // up, see isActive(). The wake trigger is level based and, with the
+    // interrupt attached, would fire for as long as the button is held,
+    // so the interrupt is off until disarmWake() and the pin is polled
+    // instead.
+    void armWake() {
+      detachInterrupt(digitalPinToInterrupt(BUTTON_PIN));
+      wifi_enable_gpio_wakeup(BUTTON_PIN, GPIO_PIN_INTR_LOLEVEL);
+    }
+
+    void disarmWake() {
+      wifi_disable_gpio_wakeup();
+      attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onEdge, CHANGE);
     }
 
     void setCallbacks(void (*shortPress)(), void (*longPress)() = nullptr, void (*pressing)() = nullptr) {
@@ -34,17 +99,28 @@ class ButtonHandler {
       onPressing = pressing;
     }
 
+    // Without this callback a very long press counts as a long press
+    void setVeryLongPressCallback(void (*veryLongPress)()) {
+      onVeryLongPress = veryLongPress;
+    }
+
     void handle() {
+      // A press the interrupt timed, used if the polling below never saw it
+      unsigned long latched = latchedPressMs;
+      latchedPressMs = 0;
+      bool wasPressing = isPressing;
+
       // Read the current button state
       int reading = digitalRead(BUTTON_PIN);
 
       // If the button state changed, reset the debounce timer
       if (reading != lastButtonState) {
-        lastDebounceTime = millis();
+        lastDebounceTime = edgePending ? edgeTime : millis();
       }
+      edgePending = false;
 
       // Check if enough time has passed since the last state change
-      if ((millis() - lastDebounceTime) > debounceDelay) {
+      if ((millis() - lastDebounceTime) > DEBOUNCE_DELAY) {
         // If the button state has changed and is stable
         if (reading != buttonState) {
           buttonState = reading;
@@ -57,14 +133,7 @@ class ButtonHandler {
           // Button has been released
           else if (isPressing) {
             isPressing = false;
-            unsigned long pressDuration = millis() - pressStartTime;
-            
-            // Determine if it was a short or long press
-            if (pressDuration >= LONG_PRESS_DURATION) {
-              if (onLongPress != nullptr) onLongPress();
-            } else {
-              if (onShortPress != nullptr) onShortPress();
-            }
+            dispatch(millis() - pressStartTime);
           }
         }
         
@@ -75,6 +144,23 @@ class ButtonHandler {
       }
 
       lastButtonState = reading;
+
+      // Pressed and released between two passes
+      if (latched > 0 && !wasPressing && !isPressing && reading == HIGH) {
+        dispatch(latched);
+      }
+    }
+
+  private:
+    // Determine if it was a short, long or very long press
+    void dispatch(unsigned long pressDuration) {
+      if (pressDuration >= VERY_LONG_PRESS_DURATION && onVeryLongPress != nullptr) {
+        onVeryLongPress();
+      } else if (pressDuration >= LONG_PRESS_DURATION) {
+        if (onLongPress != nullptr) onLongPress();
+      } else {
+        if (onShortPress != nullptr) onShortPress();
+      }
     }
 };
 
@@ -0,0 +1,139 @@
+#ifndef COIN_REGISTRY_H
+#define COIN_REGISTRY_H
+
+#include <Arduino.h>
+#include "bitmaps.h"
+#include "logo_rle.h"
+
+// Ids are positions in the tables below and index the price table,
+// sparklines and history pair codes. Append new entries at the end.
+enum CoinId : int8_t {
+    COIN_DOGE,
+    COIN_BTC,
+    COIN_LTC,
+    COIN_XMR,
+    COIN_COUNT
+};
+
+enum FiatId : int8_t {
+    FIAT_USD,
+    FIAT_EUR,
+    FIAT_GBP,
+    FIAT_RUB,
+    FIAT_SGD,
+    FIAT_JPY,
+    FIAT_COUNT
+};
+
+#define FIAT_BIT(id) (1u << (id))
+
+struct FiatInfo {
+    FiatId id;
+    const char* name;
+    const char* glyph;          // UTF-8, drawn before the price
+    uint8_t decimals;           // Most fraction digits shown
+};
+
+struct CoinInfo {
+    CoinId id;
+    const char* name;
+    const unsigned char* logo;  // Run-length coded in PROGMEM, see logo_rle.h
+    size_t logoBytes;           // Coded size
+    uint16_t fiats;             // FIAT_BIT of every fiat the long press cycles through
+};
+
+// Adding a coin or fiat is one line here plus its id above
+constexpr FiatInfo FIATS[FIAT_COUNT] = {
+    {FIAT_USD, "USD", "$", 8},
+    {FIAT_EUR, "EUR", "\xE2\x82\xAC", 8},      // €
+    {FIAT_GBP, "GBP", "\xC2\xA3", 8},          // £
+    {FIAT_RUB, "RUB", "\xE2\x82\xBD", 8},      // ₽
+    {FIAT_SGD, "SGD", "S$", 8},
+    {FIAT_JPY, "JPY", "\xC2\xA5", 0},          // ¥
+};
+
+constexpr CoinInfo COINS[COIN_COUNT] = {
+    {COIN_DOGE, "DOGE", DOGE_LOGO, sizeof(DOGE_LOGO), FIAT_BIT(FIAT_USD)},
+    {COIN_BTC, "BTC", BTC_LOGO, sizeof(BTC_LOGO),
+     FIAT_BIT(FIAT_USD) | FIAT_BIT(FIAT_EUR) | FIAT_BIT(FIAT_GBP) | FIAT_BIT(FIAT_RUB)},
+    {COIN_LTC, "LTC", LTC_LOGO, sizeof(LTC_LOGO), FIAT_BIT(FIAT_USD)},
+    {COIN_XMR, "XMR", XMR_LOGO, sizeof(XMR_LOGO), FIAT_BIT(FIAT_USD)},
+};
+
+// Compile-time checks: ids match table positions, every coin has a logo
+// that decodes to a full screen, and every pair a coin lists has a fiat
+// with a glyph
+constexpr bool registryValid() {
+    for (int f = 0; f < FIAT_COUNT; f++) {
+        if (FIATS[f].id != f || FIATS[f].glyph == nullptr || FIATS[f].glyph[0] == '\0') return false;
+    }
+    for (int c = 0; c < COIN_COUNT; c++) {
+        if (COINS[c].id != c || COINS[c].logo == nullptr ||
+            rleDecodedSize(COINS[c].logo, COINS[c].logoBytes) != LOGO_BYTES) return false;
+        if (COINS[c].fiats == 0 || (COINS[c].fiats >> FIAT_COUNT) != 0) return false;
+    }
+    return true;
+}
+
+static_assert(registryValid(), "Coin registry: id order, logo or pair fiat missing");
+static_assert(FIAT_COUNT <= 16, "Pair fiats must fit CoinInfo::fiats");
+
+// Flash the built-in logos take, against COIN_COUNT * LOGO_BYTES raw
+constexpr size_t logoFlashBytes() {
+    size_t total = 0;
+    for (int c = 0; c < COIN_COUNT; c++) {
+        total += COINS[c].logoBytes;
+    }
+    return total;
+}
+
+inline const CoinInfo& coinInfo(int id) {
+    return COINS[id];
+}
+
+inline const FiatInfo& fiatInfo(int id) {
+    return FIATS[id];
+}
+
+// Name lookups for symbols coming from the web UI or the feed,
+// -1 for symbols not in the registry
+inline int coinByName(const char* name) {
+    for (int c = 0; c < COIN_COUNT; c++) {
+        if (strcasecmp(name, COINS[c].name) == 0) return c;
+    }
+    return -1;
+}
+
+inline int fiatByName(const char* name) {
+    for (int f = 0; f < FIAT_COUNT; f++) {
+        if (strcasecmp(name, FIATS[f].name) == 0) return f;
+    }
+    return -1;
+}
+
+// Next fiat after fiat that coin's pairs allow, fiat itself if none
+inline int nextPairFiat(int coin, int fiat) {
+    for (int step = 1; step <= FIAT_COUNT; step++) {
+        int next = (fiat + step) % FIAT_COUNT;
+        if (COINS[coin].fiats & FIAT_BIT(next)) return next;
+    }
+    return fiat;
+}
+
+// History records key pairs by one byte
+inline uint8_t pairCode(int coin, int fiat) {
+    return coin * FIAT_COUNT + fiat;
+}
+
+// Pair code of history written before the registry, with a stride of
+// 4 fiats. Those coins and fiats are the first entries of the tables
+// above, in the same order. Unknown coins give 0xFF.
+#define LEGACY_FIAT_COUNT 4
+
+inline uint8_t legacyPairCode(uint8_t code) {
+    int coin = code / LEGACY_FIAT_COUNT;
+    if (coin >= COIN_COUNT) return 0xFF;
+    return pairCode(coin, code % LEGACY_FIAT_COUNT);
+}
+
+#endif // COIN_REGISTRY_H
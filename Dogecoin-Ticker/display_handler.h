@@ -6,18 +6,83 @@
 #include <Fonts/FreeSansBold9pt7b.h>
 #include <Fonts/FreeSansBold12pt7b.h>
 #include "bitmaps.h"
-#include "currency_symbols.h"
+#include "coin_registry.h"
+#include "logo_store.h"
+#include "price.h"
+#include "frame_flusher.h"
+#include "frame_scheduler.h"
+#include "sparkline.h"
+
+#define DISPLAY_I2C_ADDR 0x3C
+
+// Price screen layout, the price font sits between these rows
+#define PRICE_BASELINE 16
+#define PRICE_TOP 4
+#define PRICE_BOTTOM 17
+#define PRICE_TEXT_SIZE 24
+#define SPARK_X 96              // Sparkline to the right of short prices
+#define CHART_TOP 9             // Full-screen chart below a one-line header
+
+// Animation lengths in frames at FRAME_INTERVAL
+#define ROLL_FRAMES 8           // Changed digits roll over ~320 ms
+#define ROLL_DISTANCE 14        // One digit height
+#define MARQUEE_HOLD 25         // Pause at each end of a long price, 1 s
+#define FADE_FRAMES 16          // One frame per 4x4 dither level
+
+enum DisplayScreen {
+    SCREEN_OTHER,
+    SCREEN_SPLASH,
+    SCREEN_PRICE,
+    SCREEN_CHART
+};
+
+enum DisplayAnimation {
+    ANIM_NONE,
+    ANIM_ROLL,
+    ANIM_MARQUEE,
+    ANIM_FADE
+};
+
+#define PRICE_MAX_CHARS 11      // Price digits that fit next to the currency symbol
 
 class DisplayHandler {
 private:
     Adafruit_SSD1306* display;
+    FrameFlusher flusher;
     bool displayInitialized;
 
+    // Animation state, advanced by handle()
+    FrameScheduler scheduler;
+    DisplayScreen screen = SCREEN_OTHER;
+    DisplayAnimation animation = ANIM_NONE;
+    int animFrame = 0;
+    LogoStore logos;
+    Logo shownLogo = {nullptr, 0};
+    Logo fadeFrom = {nullptr, 0};
+
+    // Price screen contents, kept to redraw animation frames
+    char shownBase[8] = "";
+    char shownTarget[8] = "";
+    const FiatInfo* shownFiat = &FIATS[FIAT_USD];  // Glyph and decimals of shownTarget
+    char shownPrice[PRICE_TEXT_SIZE] = "";  // Rounded to PRICE_MAX_CHARS
+    char fullPrice[PRICE_TEXT_SIZE] = "";   // Every digit, scrolled if too wide
+    char rollFrom[PRICE_TEXT_SIZE] = "";
+    float shownChange = 0;
+    bool shownStale = false;
+    const SparklineBuffer* shownHistory = nullptr;
+    uint16_t shownHistoryVersion = 0;
+    SparklinePlot plot;
+    int16_t priceTextX = 0;
+    int marqueeTravel = 0;
+    int marqueeOffset = 0;
+
 public:
-    DisplayHandler(Adafruit_SSD1306* disp) : display(disp), displayInitialized(false) {}
+    DisplayHandler(Adafruit_SSD1306* disp)
+        : display(disp), flusher(disp, &Wire, DISPLAY_I2C_ADDR), displayInitialized(false) {}
 
     bool begin() {
-        displayInitialized = display->begin(SSD1306_SWITCHCAPVCC, 0x3C);
+        displayInitialized = display->begin(SSD1306_SWITCHCAPVCC, DISPLAY_I2C_ADDR);
+        flusher.invalidate();
         if (!displayInitialized) {
             return false;
         }
@@ -25,13 +90,14 @@ public:
         display->clearDisplay();
         display->setTextColor(SSD1306_WHITE);
         display->setTextSize(1);
-        display->display();
+        flusher.flush();
         return true;
     }
 
     void showWiFiConnecting(int attempt, int maxAttempts) {
         if (!displayInitialized) return;
         
+        showStatic();
         display->clearDisplay();
         display->setTextSize(1);
         display->setTextColor(SSD1306_WHITE);
@@ -45,12 +111,13 @@ public:
         int16_t x = (128 - w) / 2;
         display->setCursor(x, 20);
         display->print(attemptMsg);
-        display->display();
+        flusher.flush();
     }
 
     void showWiFiError(const char* ssid) {
         if (!displayInitialized) return;
         
+        showStatic();
         display->clearDisplay();
         display->setCursor(0, 0);
         display->println("WiFi Failed!");
@@ -60,12 +127,13 @@ public:
         display->println("1. SSID: " + String(ssid));
         display->setCursor(0, 30);
         display->println("2. Password in code");
-        display->display();
+        flusher.flush();
     }
 
     void showWiFiSuccess(IPAddress ip) {
         if (!displayInitialized) return;
         
+        showStatic();
         display->clearDisplay();
         display->setCursor(11, 0);
         display->println("Connected to WiFi");
@@ -79,74 +147,116 @@ public:
         int16_t x = (128 - w) / 2;
         display->setCursor(x, 23);
         display->print(ipStr);
-        display->display();
+        flusher.flush();
     }
 
-    void showCoinSplash(const String& coin) {
-        display->clearDisplay();
+    void showCoinSplash(const char* coin) {
+        Logo logo = logos.get(coin, shownLogo.data);
+
+        // Dissolve from the logo already on screen
+        if (screen == SCREEN_SPLASH && shownLogo.data != nullptr && shownLogo.data != logo.data) {
+            fadeFrom = shownLogo;
+            shownLogo = logo;
+            startAnimation(ANIM_FADE);
+            return;
+        }
+
+        stopAnimation();
+        screen = SCREEN_SPLASH;
+        shownLogo = logo;
         display->setTextSize(1);
         display->setTextColor(WHITE);
-        
-        // Select appropriate logo
-        const unsigned char* logo;
-        if (coin == "BTC") {
-            logo = BTC_LOGO;
-        } else if (coin == "DOGE") {
-            logo = DOGE_LOGO;
-        } else if (coin == "LTC") {
-            logo = LTC_LOGO;
-        } else if (coin == "XMR") {
-            logo = XMR_LOGO;
-        } else {
-            logo = DOGE_LOGO;
+        drawLogo(logo);
+        flusher.flush();
+    }
+
+    void updatePrice(const char* base, const char* target, const Price& price, float change,
+                     bool stale = false, const SparklineBuffer* history = nullptr) {
+        bool samePair = strcmp(base, shownBase) == 0 && strcmp(target, shownTarget) == 0;
+        const FiatInfo& fiat = samePair ? *shownFiat : fiatFor(target);
+        char newPrice[PRICE_TEXT_SIZE];
+        price.format(newPrice, sizeof(newPrice), fiat.decimals, PRICE_MAX_CHARS);
+        uint16_t historyVersion = history != nullptr ? history->getVersion() : 0;
+
+        // Nothing to redraw, and a running marquee keeps its place
+        if (screen == SCREEN_PRICE && samePair && strcmp(newPrice, shownPrice) == 0 && change == shownChange && stale == shownStale &&
+            history == shownHistory && historyVersion == shownHistoryVersion) {
+            return;
+        }
+
+        // Roll the digits when the same pair ticks to a new price
+        bool roll = screen == SCREEN_PRICE && samePair && strcmp(newPrice, shownPrice) != 0;
+        if (roll) {
+            strlcpy(rollFrom, shownPrice, sizeof(rollFrom));
+        }
+
+        strlcpy(shownBase, base, sizeof(shownBase));
+        strlcpy(shownTarget, target, sizeof(shownTarget));
+        shownFiat = &fiat;
+        strlcpy(shownPrice, newPrice, sizeof(shownPrice));
+        price.format(fullPrice, sizeof(fullPrice), fiat.decimals, sizeof(fullPrice) - 1);
+        shownChange = change;
+        shownStale = stale;
+        shownHistory = history;
+        shownHistoryVersion = historyVersion;
+        screen = SCREEN_PRICE;
+
+        if (roll) {
+            startAnimation(ANIM_ROLL);
+            return;
         }
-        display->drawBitmap(0, 0, logo, 128, 32, WHITE);
-        display->display();
+
+        stopAnimation();
+        drawPriceScreen(shownPrice, 0, 0);
+        startMarqueeIfNeeded();
+        flusher.flush();
     }
 
-    void updatePrice(const String& base, const String& target, const String& price, float change) {
+    // Full-screen chart of the recent samples for one pair
+    void showChart(const char* base, const char* target, const Price& price, const SparklineBuffer* history) {
+        stopAnimation();
+        screen = SCREEN_CHART;
         display->clearDisplay();
 
-        // Set ticker
         display->setFont();
+        display->setTextSize(1);
         display->setTextColor(BLACK, WHITE);
         display->setCursor(1, 0);
         display->print(base);
-        display->print(" => ");
+        display->print("/");
         display->print(target);
 
-        // Set the current price
-        display->setCursor(1, 16);
+        // Latest price right-aligned on the header line
+        char priceText[PRICE_TEXT_SIZE];
+        size_t len = price.format(priceText, sizeof(priceText), fiatFor(target).decimals, 10);
         display->setTextColor(WHITE);
-        display->setFont(&FreeSansBold9pt7b);
-        
-        // Choose and display currency symbol
-        const char* currencySymbol = getCurrencySymbol(target);
-        display->setTextSize(1);  // Reset text size for symbol
-        display->print(currencySymbol);
-        display->print(" ");
-        
-        // For JPY, show without decimal places
-        if (target == "JPY") {
-            display->print(String((int)price.toFloat()));
+        display->setCursor(128 - len * 6, 0);
+        display->print(priceText);
+
+        if (history == nullptr || history->size() < 2) {
+            display->setCursor(1, 16);
+            display->print("Collecting data...");
         } else {
-            display->print(price.substring(0, 11));
+            plot.draw(display, history, 0, CHART_TOP, 128, 32 - CHART_TOP);
         }
-        display->setFont();
+        flusher.flush();
+    }
 
-        // Set the 24-hour change
-        display->setCursor(1, 24);
-        display->setTextSize(1);
-        display->setTextColor(WHITE);
-        float changePercent = change * 100.0;
-        display->print("24h-Change: ");
-        display->print(changePercent, 2);
-        display->println(" %");
+    // Advances the running animation by the frames that are due. Call
+    // from every loop() pass with the time the pass has used so far.
+    void handle(unsigned long loopElapsedMicros) {
+        int steps = scheduler.poll(loopElapsedMicros);
+        if (steps == 0) return;
 
-        display->display();
+        unsigned long renderStart = micros();
+        if (renderAnimation(steps)) {
+            flusher.flush();
+            scheduler.recordRender(micros() - renderStart);
+        }
     }
 
     void showError(const String& type, const String& error) {
+        showStatic();
         display->clearDisplay();
         
         // Set Title
@@ -166,10 +276,11 @@ public:
             display->print(error);
         }
 
-        display->display();  // Ensure full display update
+        flusher.flush();
     }
 
     void showLoading(const String& title, const String& message) {
+        showStatic();
         display->clearDisplay();
         display->setTextSize(1);
         display->setTextColor(SSD1306_WHITE);
@@ -193,17 +304,224 @@ public:
         display->print(frames[loadingFrame]);
         loadingFrame = (loadingFrame + 1) % 4;
         
-        display->display();
+        flusher.flush();
+    }
+
+    // I2C bytes sent for the most recent frame
+    unsigned long getLastFrameBytes() const {
+        return flusher.getLastFrameBytes();
+    }
+
+    const FrameScheduler& getFrameStats() const {
+        return scheduler;
+    }
+
+    void resetFrameStats() {
+        scheduler.resetStats();
+    }
+
+    // Drawing surface, for the benchmarks
+    Adafruit_SSD1306* getPanel() {
+        return display;
     }
 
 private:
-    const char* getCurrencySymbol(const String& currency) {
-        if (currency == "USD") return SYMBOL_USD;
-        if (currency == "EUR") return SYMBOL_EUR;
-        if (currency == "GBP") return SYMBOL_GBP;
-        if (currency == "RUB") return SYMBOL_RUB;
-        if (currency == "SGD") return SYMBOL_SGD;
-        return SYMBOL_USD; // Default to USD
+    void startAnimation(DisplayAnimation type) {
+        animation = type;
+        animFrame = 0;
+        scheduler.start();
+    }
+
+    void stopAnimation() {
+        animation = ANIM_NONE;
+        scheduler.stop();
+    }
+
+    // Screens without animation end whatever was running
+    void showStatic() {
+        stopAnimation();
+        screen = SCREEN_OTHER;
+    }
+
+    bool renderAnimation(int steps) {
+        animFrame += steps;
+
+        switch (animation) {
+            case ANIM_ROLL:
+                if (animFrame >= ROLL_FRAMES) {
+                    stopAnimation();
+                    drawPriceScreen(shownPrice, 0, 0);
+                    startMarqueeIfNeeded();
+                } else {
+                    drawPriceScreen(shownPrice, animFrame * ROLL_DISTANCE / ROLL_FRAMES, 0);
+                }
+                return true;
+
+            case ANIM_MARQUEE: {
+                // Hold, scroll left, hold, scroll back
+                int cycle = 2 * (MARQUEE_HOLD + marqueeTravel);
+                animFrame %= cycle;
+                int offset;
+                if (animFrame < MARQUEE_HOLD) {
+                    offset = 0;
+                } else if (animFrame < MARQUEE_HOLD + marqueeTravel) {
+                    offset = animFrame - MARQUEE_HOLD;
+                } else if (animFrame < 2 * MARQUEE_HOLD + marqueeTravel) {
+                    offset = marqueeTravel;
+                } else {
+                    offset = cycle - animFrame;
+                }
+                if (offset == marqueeOffset) return false;
+                marqueeOffset = offset;
+                drawPriceScreen(fullPrice, 0, offset);
+                return true;
+            }
+
+            case ANIM_FADE:
+                if (animFrame >= FADE_FRAMES) {
+                    stopAnimation();
+                    drawLogo(shownLogo);
+                } else {
+                    drawFadeFrame(animFrame);
+                }
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    // Draws the price screen. A rollOffset slides the digits that differ
+    // from rollFrom up and out while the new ones come in from below;
+    // a scrollOffset shifts the price left for the marquee.
+    void drawPriceScreen(const char* text, int rollOffset, int scrollOffset) {
+        display->clearDisplay();
+        display->setTextWrap(false);
+
+        // Set the current price
+        display->setCursor(1, PRICE_BASELINE);
+        display->setTextColor(WHITE);
+        display->setFont(&FreeSansBold9pt7b);
+        
+        // Choose and display currency symbol
+        const char* currencySymbol = shownFiat->glyph;
+        display->setTextSize(1);  // Reset text size for symbol
+        display->print(currencySymbol);
+        display->print(" ");
+        priceTextX = display->getCursorX();
+
+        int16_t priceEnd;
+        if (rollOffset > 0) {
+            size_t common = 0;
+            while (text[common] != '\0' && text[common] == rollFrom[common]) {
+                display->write(text[common++]);
+            }
+            int16_t rollX = display->getCursorX();
+            display->setCursor(rollX, PRICE_BASELINE - rollOffset);
+            display->print(rollFrom + common);
+            priceEnd = display->getCursorX();
+            display->setCursor(rollX, PRICE_BASELINE + ROLL_DISTANCE - rollOffset);
+            display->print(text + common);
+            priceEnd = max(priceEnd, display->getCursorX());
+        } else {
+            display->setCursor(priceTextX - scrollOffset, PRICE_BASELINE);
+            display->print(text);
+            priceEnd = display->getCursorX();
+        }
+
+        // Sparkline in the space a short price leaves free
+        if (shownHistory != nullptr && scrollOffset == 0 && priceEnd <= SPARK_X - 2) {
+            plot.draw(display, shownHistory, SPARK_X, PRICE_TOP, 128 - SPARK_X, PRICE_BOTTOM - PRICE_TOP);
+        }
+
+        // Clip the price to its band, and keep the symbol clear of the marquee
+        display->fillRect(0, 0, 128, PRICE_TOP, BLACK);
+        display->fillRect(0, PRICE_BOTTOM, 128, 32 - PRICE_BOTTOM, BLACK);
+        if (scrollOffset > 0) {
+            display->fillRect(0, PRICE_TOP, priceTextX, PRICE_BOTTOM - PRICE_TOP, BLACK);
+            display->setCursor(1, PRICE_BASELINE);
+            display->print(currencySymbol);
+        }
+        display->setFont();
+        display->setTextWrap(true);
+
+        // Set ticker
+        display->setTextColor(BLACK, WHITE);
+        display->setCursor(1, 0);
+        display->print(shownBase);
+        display->print(" => ");
+        display->print(shownTarget);
+
+        // Flag cached prices that are older than the configured age
+        if (shownStale) {
+            display->setTextColor(WHITE);
+            display->setCursor(98, 0);
+            display->print("STALE");
+        }
+
+        // Set the 24-hour change
+        display->setCursor(1, 24);
+        display->setTextSize(1);
+        display->setTextColor(WHITE);
+        float changePercent = shownChange * 100.0;
+        display->print("24h-Change: ");
+        display->print(changePercent, 2);
+        display->println(" %");
+    }
+
+    // Prices with more digits than fit get scrolled in full
+    void startMarqueeIfNeeded() {
+        if (strcmp(fullPrice, shownPrice) == 0) return;
+
+        int16_t x1, y1;
+        uint16_t w, h;
+        display->setFont(&FreeSansBold9pt7b);
+        display->getTextBounds(fullPrice, 0, PRICE_BASELINE, &x1, &y1, &w, &h);
+        display->setFont();
+
+        marqueeTravel = priceTextX + w - 127;
+        if (marqueeTravel <= 0) return;
+
+        marqueeOffset = 0;
+        drawPriceScreen(fullPrice, 0, 0);
+        startAnimation(ANIM_MARQUEE);
+    }
+
+    // Logos fill the screen, so they decode over the whole buffer
+    void drawLogo(const Logo& logo) {
+        drawRleLogo(display->getBuffer(), logo.data, logo.len);
+    }
+
+    // Ordered dither between two logos, level 0-16 of the new one shown.
+    // Both decode in step straight into the display buffer.
+    void drawFadeFrame(int level) {
+        static const uint8_t bayer[4][4] = {
+            {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}
+        };
+
+        // A buffer byte is 8 rows of one column and pages start on a
+        // multiple of 4 rows, so the mask only depends on the column
+        uint8_t masks[4];
+        for (int x = 0; x < 4; x++) {
+            masks[x] = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                if (bayer[bit & 3][x] < level) masks[x] |= 1 << bit;
+            }
+        }
+
+        RleReader from(fadeFrom.data, fadeFrom.len);
+        RleReader to(shownLogo.data, shownLogo.len);
+        uint8_t* buffer = display->getBuffer();
+        for (int i = 0; i < LOGO_BYTES; i++) {
+            uint8_t mask = masks[i & 3];
+            buffer[i] = (from.next() & ~mask) | (to.next() & mask);
+        }
+    }
+
+    // Fiats the registry doesn't know are drawn like USD
+    static const FiatInfo& fiatFor(const char* fiat) {
+        int id = fiatByName(fiat);
+        return fiatInfo(id < 0 ? FIAT_USD : id);
     }
 };
 
@@ -0,0 +1,121 @@
+#ifndef FRAME_FLUSHER_H
+#define FRAME_FLUSHER_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+
+#define FRAME_WIDTH 128
+#define FRAME_PAGES 4                   // 32 rows / 8 rows per page
+#define FRAME_BYTES (FRAME_WIDTH * FRAME_PAGES)
+#define FRAME_I2C_CLOCK 400000
+#ifdef BUFFER_LENGTH
+#define FRAME_I2C_CHUNK (BUFFER_LENGTH - 1)   // Data bytes per transmission after the control byte
+#else
+#define FRAME_I2C_CHUNK 31
+#endif
+
+// Pushes only the parts of the SSD1306 framebuffer that changed since
+// the last flush. Each page is diffed against a copy of the previous
+// frame and just the changed column range is sent, using the
+// controller's column/page address window.
+class FrameFlusher {
+private:
+    Adafruit_SSD1306* display;
+    TwoWire* wire;
+    uint8_t address;
+
+    uint8_t previous[FRAME_BYTES];
+    bool primed = false;
+
+    // I2C bytes sent, including address and control bytes
+    unsigned long lastFrameBytes = 0;
+    unsigned long totalBytes = 0;
+    unsigned long frames = 0;
+
+public:
+    FrameFlusher(Adafruit_SSD1306* disp, TwoWire* twoWire, uint8_t i2cAddress)
+        : display(disp), wire(twoWire), address(i2cAddress) {}
+
+    // Forces the next flush to send the whole frame, e.g. after display->begin()
+    void invalidate() {
+        primed = false;
+    }
+
+    void flush() {
+        uint8_t* buffer = display->getBuffer();
+        frames++;
+
+        if (!primed) {
+            display->display();
+            memcpy(previous, buffer, FRAME_BYTES);
+            primed = true;
+            // Address + control byte per chunk, plus the address window commands
+            lastFrameBytes = FRAME_BYTES + 2 * ((FRAME_BYTES + FRAME_I2C_CHUNK - 1) / FRAME_I2C_CHUNK) + 8;
+            totalBytes += lastFrameBytes;
+            return;
+        }
+
+        lastFrameBytes = 0;
+        wire->setClock(FRAME_I2C_CLOCK);
+
+        for (uint8_t page = 0; page < FRAME_PAGES; page++) {
+            const uint8_t* current = buffer + page * FRAME_WIDTH;
+            uint8_t* last = previous + page * FRAME_WIDTH;
+
+            int first = 0;
+            while (first < FRAME_WIDTH && current[first] == last[first]) first++;
+            if (first == FRAME_WIDTH) continue;
+
+            int end = FRAME_WIDTH - 1;
+            while (current[end] == last[end]) end--;
+
+            sendWindow(page, first, end);
+            sendData(current + first, end - first + 1);
+            memcpy(last + first, current + first, end - first + 1);
+        }
+
+        totalBytes += lastFrameBytes;
+    }
+
+    unsigned long getLastFrameBytes() const {
+        return lastFrameBytes;
+    }
+
+    unsigned long getTotalBytes() const {
+        return totalBytes;
+    }
+
+    unsigned long getFrameCount() const {
+        return frames;
+    }
+
+private:
+    void sendWindow(uint8_t page, uint8_t firstColumn, uint8_t lastColumn) {
+        wire->beginTransmission(address);
+        wire->write((uint8_t)0x00);             // Command stream
+        wire->write((uint8_t)SSD1306_COLUMNADDR);
+        wire->write(firstColumn);
+        wire->write(lastColumn);
+        wire->write((uint8_t)SSD1306_PAGEADDR);
+        wire->write(page);
+        wire->write(page);
+        wire->endTransmission();
+        lastFrameBytes += 8;
+    }
+
+    void sendData(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            size_t chunk = len < FRAME_I2C_CHUNK ? len : FRAME_I2C_CHUNK;
+            wire->beginTransmission(address);
+            wire->write((uint8_t)0x40);         // Data stream
+            wire->write(data, chunk);
+            wire->endTransmission();
+            lastFrameBytes += chunk + 2;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+};
+
+#endif // FRAME_FLUSHER_H
@@ -0,0 +1,87 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define FRAME_INTERVAL 40           // Target frame period (ms), 25 fps
+#define FRAME_BUSY_BUDGET 8000      // Skip rendering if the loop pass already took this long (us)
+
+// Cooperative frame timing for display animations. poll() is called
+// from every loop() pass and says how many animation steps are due.
+// Slots that pass while the loop is busy are dropped rather than
+// rendered late, so animations keep their duration.
+class FrameScheduler {
+private:
+    unsigned long nextFrame = 0;
+    bool running = false;
+
+    unsigned long framesRendered = 0;
+    unsigned long framesDropped = 0;
+    unsigned long lastRenderMicros = 0;
+    unsigned long maxRenderMicros = 0;
+
+public:
+    void start() {
+        running = true;
+        nextFrame = millis();
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    bool isRunning() const {
+        return running;
+    }
+
+    // millis() of the next frame slot, while running
+    unsigned long getNextFrame() const {
+        return nextFrame;
+    }
+
+    // Returns the number of steps to advance, 0 if no frame is due
+    int poll(unsigned long loopElapsedMicros) {
+        if (!running) return 0;
+
+        unsigned long now = millis();
+        if ((long)(now - nextFrame) < 0) return 0;
+
+        // A fetch or websocket event used this pass, try again next pass
+        if (loopElapsedMicros > FRAME_BUSY_BUDGET) return 0;
+
+        unsigned long missed = (now - nextFrame) / FRAME_INTERVAL;
+        framesDropped += missed;
+        nextFrame += (missed + 1) * FRAME_INTERVAL;
+        return missed + 1;
+    }
+
+    void recordRender(unsigned long micros) {
+        framesRendered++;
+        lastRenderMicros = micros;
+        if (micros > maxRenderMicros) {
+            maxRenderMicros = micros;
+        }
+    }
+
+    unsigned long getFramesRendered() const {
+        return framesRendered;
+    }
+
+    unsigned long getFramesDropped() const {
+        return framesDropped;
+    }
+
+    unsigned long getLastRenderMicros() const {
+        return lastRenderMicros;
+    }
+
+    unsigned long getMaxRenderMicros() const {
+        return maxRenderMicros;
+    }
+
+    void resetStats() {
+        maxRenderMicros = 0;
+    }
+};
+
+#endif // FRAME_SCHEDULER_H
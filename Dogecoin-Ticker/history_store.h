@@ -0,0 +1,387 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include <time.h>
+#include "LittleFS.h"
+#include "price.h"
+
+#define HISTORY_FORMAT 2                    // Pair codes with a stride of FIAT_COUNT
+#define HISTORY_DIR "/hist2"                // Named by format, so files of two formats never mix
+#define HISTORY_LEGACY_DIR "/hist"          // Format 1, pair codes with a stride of 4 fiats
+#define HISTORY_NO_PAIR 0xFF
+#define HISTORY_BATCH 32                    // Records held in RAM between flushes, 512 bytes
+#define HISTORY_FLUSH_INTERVAL 600000       // Longest time a record waits in RAM (ms)
+#define HISTORY_SEGMENT_SECONDS 86400       // One file per UTC day
+#define HISTORY_MAX_SEGMENTS 8              // Days kept, oldest file is removed first
+#define HISTORY_READ_BATCH 16               // Records read per file access during queries
+#define HISTORY_MIN_TIME 1600000000UL       // Clock has not been set by NTP before this
+
+// One fixed-size sample. Naturally aligned, so files can be read
+// straight into an array of records.
+struct HistoryRecord {
+    int64_t mantissa;
+    uint32_t time;          // Unix seconds
+    int16_t change;         // 24h change in basis points (fraction * 10000)
+    uint8_t pair;           // Caller's pair code, e.g. crypto * fiats + fiat
+    uint8_t scale;
+};
+static_assert(sizeof(HistoryRecord) == 16, "HistoryRecord must stay 16 bytes");
+
+// Position of a query that is read a batch at a time
+struct HistoryCursor {
+    uint8_t pair;
+    uint32_t from;
+    uint32_t to;
+    uint32_t segment;           // Day file being read
+    size_t position;            // Next record in it, SIZE_MAX until searched
+    uint8_t pendingIndex;
+    bool inPending;             // Files are done, reading the RAM batch
+    bool done;
+};
+
+typedef void (*HistoryRecordCallback)(const HistoryRecord& record, void* context);
+
+// Maps a format 1 pair code to the current one, HISTORY_NO_PAIR drops it
+typedef uint8_t (*HistoryPairMap)(uint8_t legacyPair);
+
+// Append-only price log on LittleFS. Records are batched in RAM and
+// written in one append per flush, so flash sees a write every few
+// minutes rather than every fetch. Files are split per day, which
+// keeps pruning to a single remove() and lets a query binary search
+// each file by time, since records are appended in time order.
+class HistoryStore {
+private:
+    HistoryRecord pending[HISTORY_BATCH];
+    uint8_t pendingCount = 0;
+    unsigned long lastFlush = 0;
+    bool ready = false;
+
+    unsigned long recordsWritten = 0;
+    unsigned long flushCount = 0;
+    unsigned long lastFlushMicros = 0;
+
+public:
+    // Files of an earlier format are rewritten with their pair codes
+    // mapped, or removed without a map
+    bool begin(HistoryPairMap legacyPair = nullptr) {
+        if (!LittleFS.exists(HISTORY_DIR) && !LittleFS.mkdir(HISTORY_DIR)) {
+            Serial.println("History: could not create " HISTORY_DIR);
+            return false;
+        }
+        if (LittleFS.exists(HISTORY_LEGACY_DIR)) {
+            migrate(legacyPair);
+        }
+        ready = true;
+        lastFlush = millis();
+        prune();
+        return true;
+    }
+
+    // Queues a sample, dropped until the clock has been set
+    bool append(uint8_t pair, const Price& price, float change) {
+        if (!ready) return false;
+
+        time_t now = time(nullptr);
+        if ((unsigned long)now < HISTORY_MIN_TIME) return false;
+
+        if (pendingCount == HISTORY_BATCH) {
+            flush();
+        }
+
+        // The feed reports the change as a fraction, -0.0123 for -1.23%
+        float basisPoints = change * 10000.0f;
+        if (basisPoints > INT16_MAX) basisPoints = INT16_MAX;
+        if (basisPoints < INT16_MIN) basisPoints = INT16_MIN;
+
+        HistoryRecord& record = pending[pendingCount++];
+        record.mantissa = price.mantissa;
+        record.time = (uint32_t)now;
+        record.change = (int16_t)lroundf(basisPoints);
+        record.pair = pair;
+        record.scale = price.scale;
+        return true;
+    }
+
+    // Flushes the batch once the interval has passed
+    void handle() {
+        if (pendingCount > 0 && millis() - lastFlush >= HISTORY_FLUSH_INTERVAL) {
+            flush();
+        }
+    }
+
+    void flush() {
+        lastFlush = millis();
+        if (!ready || pendingCount == 0) return;
+
+        unsigned long start = micros();
+        uint8_t first = 0;
+        while (first < pendingCount) {
+            // Run of records that belong in the same day's file
+            uint32_t segment = pending[first].time / HISTORY_SEGMENT_SECONDS;
+            uint8_t end = first + 1;
+            while (end < pendingCount && pending[end].time / HISTORY_SEGMENT_SECONDS == segment) end++;
+
+            char path[32];
+            segmentPath(segment, path, sizeof(path));
+            bool created = !LittleFS.exists(path);
+
+            File file = LittleFS.open(path, "a");
+            if (!file) {
+                Serial.printf("History: could not open %s\n", path);
+                break;
+            }
+            size_t bytes = (end - first) * sizeof(HistoryRecord);
+            size_t written = file.write((const uint8_t*)&pending[first], bytes);
+            file.close();
+
+            recordsWritten += written / sizeof(HistoryRecord);
+            if (written != bytes) {
+                Serial.printf("History: short write to %s\n", path);
+            }
+            if (created) prune();
+            first = end;
+        }
+
+        pendingCount = 0;
+        flushCount++;
+        lastFlushMicros = micros() - start;
+    }
+
+    // Starts a query for the pair's records with from <= time <= to.
+    // Ranges reaching past the days kept start at the oldest one.
+    void openCursor(HistoryCursor& cursor, uint8_t pair, uint32_t from, uint32_t to) {
+        uint32_t kept = HISTORY_MAX_SEGMENTS * HISTORY_SEGMENT_SECONDS;
+        if (to > kept && from < to - kept) from = to - kept;
+
+        cursor.pair = pair;
+        cursor.from = from;
+        cursor.to = to;
+        cursor.segment = from / HISTORY_SEGMENT_SECONDS;
+        cursor.position = SIZE_MAX;
+        cursor.pendingIndex = 0;
+        cursor.inPending = false;
+        cursor.done = !ready || from > to;
+    }
+
+    // Next records of a query, oldest first. Reads at most one file
+    // batch per call, so a web request can be served a piece at a time;
+    // that batch may hold none of the pair's records. Samples still
+    // waiting in RAM come last. cursor.done is set at the end.
+    size_t read(HistoryCursor& cursor, HistoryRecord* out, size_t max) {
+        while (!cursor.done) {
+            if (cursor.inPending) {
+                size_t got = 0;
+                while (cursor.pendingIndex < pendingCount && got < max) {
+                    const HistoryRecord& record = pending[cursor.pendingIndex++];
+                    if (record.pair == cursor.pair && record.time >= cursor.from && record.time <= cursor.to) {
+                        out[got++] = record;
+                    }
+                }
+                cursor.done = cursor.pendingIndex >= pendingCount;
+                return got;
+            }
+
+            if (cursor.segment > cursor.to / HISTORY_SEGMENT_SECONDS) {
+                cursor.inPending = true;
+                continue;
+            }
+
+            char path[32];
+            segmentPath(cursor.segment, path, sizeof(path));
+            if (!LittleFS.exists(path)) {
+                nextSegment(cursor);
+                continue;
+            }
+            return readSegment(cursor, path, out, max);
+        }
+        return 0;
+    }
+
+    // Calls back for each record of the pair with from <= time <= to,
+    // oldest first, stopping after limit records. Includes samples that
+    // are still waiting in RAM. Returns the number of records reported.
+    size_t query(uint8_t pair, uint32_t from, uint32_t to, size_t limit,
+                 HistoryRecordCallback callback, void* context) {
+        HistoryCursor cursor;
+        openCursor(cursor, pair, from, to);
+
+        size_t reported = 0;
+        HistoryRecord records[HISTORY_READ_BATCH];
+        while (reported < limit && !cursor.done) {
+            size_t got = read(cursor, records, HISTORY_READ_BATCH);
+            for (size_t i = 0; i < got && reported < limit; i++) {
+                callback(records[i], context);
+                reported++;
+            }
+        }
+        return reported;
+    }
+
+    unsigned long getRecordsWritten() const {
+        return recordsWritten;
+    }
+
+    unsigned long getFlushCount() const {
+        return flushCount;
+    }
+
+    unsigned long getLastFlushMicros() const {
+        return lastFlushMicros;
+    }
+
+    int getPendingCount() const {
+        return pendingCount;
+    }
+
+private:
+    static void segmentPath(uint32_t segment, char* out, size_t size) {
+        snprintf(out, size, HISTORY_DIR "/%lu.bin", (unsigned long)segment);
+    }
+
+    // One batch from the cursor's day file, moving on to the next day
+    // at its end or past `to`
+    size_t readSegment(HistoryCursor& cursor, const char* path, HistoryRecord* out, size_t max) {
+        File file = LittleFS.open(path, "r");
+        if (!file) {
+            nextSegment(cursor);
+            return 0;
+        }
+
+        size_t count = file.size() / sizeof(HistoryRecord);
+        if (cursor.position == SIZE_MAX) {
+            cursor.position = firstAtOrAfter(file, count, cursor.from);
+        }
+
+        HistoryRecord records[HISTORY_READ_BATCH];
+        size_t batch = count - cursor.position < HISTORY_READ_BATCH ? count - cursor.position : HISTORY_READ_BATCH;
+        if (batch > max) batch = max;
+        file.seek(cursor.position * sizeof(HistoryRecord), SeekSet);
+        size_t loaded = file.read((uint8_t*)records, batch * sizeof(HistoryRecord)) / sizeof(HistoryRecord);
+        file.close();
+
+        size_t got = 0;
+        for (size_t i = 0; i < loaded; i++) {
+            if (records[i].time > cursor.to) {
+                cursor.inPending = true;
+                return got;
+            }
+            if (records[i].pair == cursor.pair) out[got++] = records[i];
+        }
+        cursor.position += loaded;
+        if (loaded == 0 || cursor.position >= count) nextSegment(cursor);
+        return got;
+    }
+
+    static void nextSegment(HistoryCursor& cursor) {
+        cursor.segment++;
+        cursor.position = SIZE_MAX;
+    }
+
+    // Binary search for the first record at or after `from`, records
+    // are appended in time order
+    static size_t firstAtOrAfter(File& file, size_t count, uint32_t from) {
+        size_t low = 0;
+        size_t high = count;
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            HistoryRecord record;
+            file.seek(mid * sizeof(HistoryRecord), SeekSet);
+            if (file.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) return count;
+            if (record.time < from) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // Moves the format 1 files over one at a time. The new file is
+    // written from scratch, so a migration cut short by a reset is
+    // simply repeated at the next boot. A file that could not be moved,
+    // say with the disk full, is kept and tried again then.
+    void migrate(HistoryPairMap legacyPair) {
+        unsigned long start = millis();
+        unsigned long kept = 0;
+        unsigned long dropped = 0;
+        for (;;) {
+            Dir dir = LittleFS.openDir(HISTORY_LEGACY_DIR);
+            if (!dir.next()) break;
+
+            char from[40];
+            snprintf(from, sizeof(from), HISTORY_LEGACY_DIR "/%s", dir.fileName().c_str());
+            if (legacyPair != nullptr) {
+                char to[32];
+                segmentPath(strtoul(dir.fileName().c_str(), nullptr, 10), to, sizeof(to));
+                if (!migrateFile(from, to, legacyPair, kept, dropped)) {
+                    Serial.printf("History: could not migrate %s, kept\n", from);
+                    LittleFS.remove(to);
+                    return;
+                }
+            }
+            if (!LittleFS.remove(from)) {
+                Serial.printf("History: could not remove %s\n", from);
+                return;
+            }
+        }
+        LittleFS.rmdir(HISTORY_LEGACY_DIR);
+        Serial.printf("History: format %d, %lu old records kept, %lu dropped, in %lu ms\n",
+                      HISTORY_FORMAT, kept, dropped, millis() - start);
+    }
+
+    // False if either file could not be opened or a write fell short
+    static bool migrateFile(const char* from, const char* to, HistoryPairMap legacyPair,
+                            unsigned long& kept, unsigned long& dropped) {
+        File in = LittleFS.open(from, "r");
+        if (!in) return false;
+        File out = LittleFS.open(to, "w");
+        if (!out) return false;
+
+        HistoryRecord records[HISTORY_READ_BATCH];
+        size_t got;
+        while ((got = in.read((uint8_t*)records, sizeof(records)) / sizeof(HistoryRecord)) > 0) {
+            size_t count = 0;
+            for (size_t i = 0; i < got; i++) {
+                uint8_t pair = legacyPair(records[i].pair);
+                if (pair == HISTORY_NO_PAIR) {
+                    dropped++;
+                    continue;
+                }
+                records[count] = records[i];
+                records[count].pair = pair;
+                count++;
+            }
+            size_t bytes = count * sizeof(HistoryRecord);
+            if (out.write((const uint8_t*)records, bytes) != bytes) return false;
+            kept += count;
+            yield();
+        }
+        in.close();
+        out.close();
+        return true;
+    }
+
+    // Removes the oldest day files beyond HISTORY_MAX_SEGMENTS
+    void prune() {
+        for (;;) {
+            int files = 0;
+            unsigned long oldest = ULONG_MAX;
+            Dir dir = LittleFS.openDir(HISTORY_DIR);
+            while (dir.next()) {
+                unsigned long segment = strtoul(dir.fileName().c_str(), nullptr, 10);
+                if (segment < oldest) oldest = segment;
+                files++;
+            }
+            if (files <= HISTORY_MAX_SEGMENTS) return;
+
+            char path[32];
+            segmentPath(oldest, path, sizeof(path));
+            if (!LittleFS.remove(path)) return;
+            Serial.printf("History: removed %s\n", path);
+        }
+    }
+};
+
+#endif // HISTORY_STORE_H
@@ -0,0 +1,243 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define HTTP_LINE_BUFFER 48     // Only the start of a header line is kept
+#define HTTP_MAX_BODY 0x100000  // Larger lengths or chunks are taken as corrupt (bytes)
+
+enum HttpParseState {
+    HTTP_STATUS_LINE,
+    HTTP_HEADER_LINE,
+    HTTP_BODY,
+    HTTP_CHUNK_SIZE,
+    HTTP_CHUNK_EXT,
+    HTTP_CHUNK_DATA,
+    HTTP_CHUNK_DATA_END,
+    HTTP_TRAILER,
+    HTTP_DONE,
+    HTTP_ERROR
+};
+
+// Incremental HTTP/1.1 response parser working on a fixed line buffer.
+// Bytes can arrive in any fragmentation; body bytes are handed back
+// in place with chunked framing removed.
+class HttpResponseParser {
+private:
+    HttpParseState state = HTTP_STATUS_LINE;
+    char line[HTTP_LINE_BUFFER];
+    size_t lineLen = 0;
+
+    int status = 0;
+    long contentLength = -1;
+    long bodyRemaining = 0;
+    long retryAfter = -1;
+    bool chunked = false;
+    bool serverClose = false;
+
+public:
+    void reset() {
+        state = HTTP_STATUS_LINE;
+        lineLen = 0;
+        status = 0;
+        contentLength = -1;
+        bodyRemaining = 0;
+        retryAfter = -1;
+        chunked = false;
+        serverClose = false;
+    }
+
+    // Consumes len bytes of raw response. Body bytes are moved to the
+    // front of data and their count is returned.
+    size_t feed(char* data, size_t len) {
+        size_t bodyLen = 0;
+
+        for (size_t i = 0; i < len; i++) {
+            char c = data[i];
+
+            switch (state) {
+                case HTTP_STATUS_LINE:
+                case HTTP_HEADER_LINE:
+                case HTTP_TRAILER:
+                    if (c == '\n') {
+                        endLine();
+                    } else if (c != '\r' && lineLen < HTTP_LINE_BUFFER - 1) {
+                        line[lineLen++] = c;
+                    }
+                    break;
+
+                case HTTP_BODY:
+                    data[bodyLen++] = c;
+                    if (contentLength >= 0 && --bodyRemaining == 0) {
+                        state = HTTP_DONE;
+                    }
+                    break;
+
+                case HTTP_CHUNK_SIZE:
+                    if (c == '\n') {
+                        state = bodyRemaining > 0 ? HTTP_CHUNK_DATA : HTTP_TRAILER;
+                    } else if (c == ';') {
+                        state = HTTP_CHUNK_EXT;
+                    } else if (c != '\r' && c != ' ') {
+                        int digit = hexValue(c);
+                        if (digit < 0 || bodyRemaining > (HTTP_MAX_BODY - digit) / 16) {
+                            state = HTTP_ERROR;
+                            return bodyLen;
+                        }
+                        bodyRemaining = bodyRemaining * 16 + digit;
+                    }
+                    break;
+
+                case HTTP_CHUNK_EXT:
+                    if (c == '\n') {
+                        state = bodyRemaining > 0 ? HTTP_CHUNK_DATA : HTTP_TRAILER;
+                    }
+                    break;
+
+                case HTTP_CHUNK_DATA:
+                    data[bodyLen++] = c;
+                    if (--bodyRemaining == 0) {
+                        state = HTTP_CHUNK_DATA_END;
+                    }
+                    break;
+
+                case HTTP_CHUNK_DATA_END:
+                    if (c == '\n') {
+                        state = HTTP_CHUNK_SIZE;
+                    }
+                    break;
+
+                case HTTP_DONE:
+                case HTTP_ERROR:
+                    // Anything past the end of the response is ignored
+                    return bodyLen;
+            }
+        }
+
+        return bodyLen;
+    }
+
+    int statusCode() const {
+        return status;
+    }
+
+    bool headersComplete() const {
+        return state != HTTP_STATUS_LINE && state != HTTP_HEADER_LINE;
+    }
+
+    bool isComplete() const {
+        return state == HTTP_DONE;
+    }
+
+    bool hasError() const {
+        return state == HTTP_ERROR;
+    }
+
+    // Without a length or chunked framing the body runs until the server closes
+    bool endsAtClose() const {
+        return state == HTTP_BODY && contentLength < 0;
+    }
+
+    // Seconds from a Retry-After header, -1 without one or for the
+    // HTTP-date form
+    long retryAfterSeconds() const {
+        return retryAfter;
+    }
+
+    // Whether the connection can carry another request afterwards
+    bool keepAlive() const {
+        return !serverClose && (chunked || contentLength >= 0);
+    }
+
+private:
+    void endLine() {
+        line[lineLen] = '\0';
+
+        if (state == HTTP_STATUS_LINE) {
+            // "HTTP/1.1 200 OK"
+            const char* space = strchr(line, ' ');
+            if (strncmp(line, "HTTP/", 5) != 0 || space == nullptr) {
+                state = HTTP_ERROR;
+                return;
+            }
+            status = atoi(space + 1);
+            state = HTTP_HEADER_LINE;
+        } else if (state == HTTP_TRAILER) {
+            if (lineLen == 0) {
+                state = HTTP_DONE;
+            }
+        } else if (lineLen == 0) {
+            startBody();
+        } else {
+            parseHeader();
+        }
+
+        lineLen = 0;
+    }
+
+    void parseHeader() {
+        if (matchHeader("content-length:")) {
+            contentLength = parseLength(line + 15);
+            if (contentLength < 0) state = HTTP_ERROR;
+        } else if (matchHeader("transfer-encoding:")) {
+            chunked = containsIgnoreCase(line + 18, "chunked");
+        } else if (matchHeader("connection:")) {
+            serverClose = containsIgnoreCase(line + 11, "close");
+        } else if (matchHeader("retry-after:")) {
+            char* end;
+            long seconds = strtol(line + 12, &end, 10);
+            while (*end == ' ') end++;
+            retryAfter = end != line + 12 && *end == '\0' && seconds >= 0 ? seconds : -1;
+        }
+    }
+
+    void startBody() {
+        if (chunked) {
+            bodyRemaining = 0;
+            state = HTTP_CHUNK_SIZE;
+        } else if (contentLength == 0) {
+            state = HTTP_DONE;
+        } else {
+            bodyRemaining = contentLength;
+            state = HTTP_BODY;
+        }
+    }
+
+    bool matchHeader(const char* name) const {
+        return strncasecmp(line, name, strlen(name)) == 0;
+    }
+
+    static bool containsIgnoreCase(const char* text, const char* word) {
+        size_t wordLen = strlen(word);
+        for (; *text != '\0'; text++) {
+            if (strncasecmp(text, word, wordLen) == 0) return true;
+        }
+        return false;
+    }
+
+    // Decimal length up to HTTP_MAX_BODY, -1 for anything else
+    static long parseLength(const char* text) {
+        while (*text == ' ') text++;
+        long value = 0;
+        const char* start = text;
+        for (; *text >= '0' && *text <= '9'; text++) {
+            value = value * 10 + (*text - '0');
+            if (value > HTTP_MAX_BODY) return -1;
+        }
+        while (*text == ' ') text++;
+        return text != start && *text == '\0' ? value : -1;
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
+
+#endif // HTTP_PARSER_H
@@ -3,20 +3,61 @@
 
 #include <Arduino.h>
 
+#define LED_BLINK_MS 250            // On and off time of one flash
+#define LED_BREATHE_MS 1000         // Ramp time each way of one breath
+#define LED_FADE_STEP 10            // PWM update period during fades (ms)
+#define LED_QUEUE_SIZE 32           // Pattern steps that can be pending
+#define LED_PWM_RANGE 255
+#define LED_MIN_LEVEL 40            // Trend LED brightness for a flat 24h change
+#define LED_FULL_CHANGE 0.10f       // 24h change (fraction) that lights the trend LED fully
+
+enum LedColor {
+    LED_POS,
+    LED_NEG,
+    LED_INFO
+};
+
+// One timeline entry: target brightness of each LED, held for duration
+// or faded to from the previous entry when fade is set
+struct LedStep {
+    uint8_t pos;
+    uint8_t neg;
+    uint8_t info;
+    bool fade;
+    uint16_t duration;
+};
+
+// LED effects run from a queue of timed steps advanced by handle(), so
+// flashes no longer block the loop. When the queue drains the LEDs go
+// back to the resting state set by the on/off calls and updateLed().
 class LedHandler {
 private:
     const int onboardLedPin;
     const int posLedPin;
     const int negLedPin;
     const int infoLedPin;
-    
+
     bool onboardLedStatus = false;
     bool posLedStatus = false;
     bool negLedStatus = false;
     bool infoLedStatus = false;
 
+    // Brightness shown while no pattern is playing
+    LedStep rest = {0, 0, 0, false, 0};
+    // Brightness currently written to the pins
+    LedStep shown = {0, 0, 0, false, 0};
+    // Brightness when the current step started, for fades
+    LedStep from = {0, 0, 0, false, 0};
+
+    LedStep queue[LED_QUEUE_SIZE];
+    uint8_t head = 0;
+    uint8_t count = 0;
+    unsigned long stepStart = 0;
+    unsigned long lastFade = 0;
+    void (*onDone)() = nullptr;     // Called once the queue drains
+
 public:
-    LedHandler(int onboard, int pos, int neg, int info) 
+    LedHandler(int onboard, int pos, int neg, int info)
         : onboardLedPin(onboard), posLedPin(pos), negLedPin(neg), infoLedPin(info) {}
 
     void begin() {
@@ -24,16 +65,96 @@ public:
         pinMode(posLedPin, OUTPUT);
         pinMode(negLedPin, OUTPUT);
         pinMode(infoLedPin, OUTPUT);
+        analogWriteRange(LED_PWM_RANGE);
+        digitalWrite(posLedPin, LOW);
+        digitalWrite(negLedPin, LOW);
+        digitalWrite(infoLedPin, LOW);
         allOff();
     }
 
+    // Advances the running pattern. Call from every loop() pass.
+    void handle() {
+        if (count == 0) {
+            done();
+            return;
+        }
+
+        unsigned long now = millis();
+        const LedStep& step = queue[head];
+        unsigned long elapsed = now - stepStart;
+
+        if (elapsed >= step.duration) {
+            write(step);
+            from = step;
+            head = (head + 1) % LED_QUEUE_SIZE;
+            count--;
+            startStep(now);
+            if (count == 0) done();
+            return;
+        }
+
+        if (step.fade && now - lastFade >= LED_FADE_STEP) {
+            lastFade = now;
+            LedStep level = {
+                blend(from.pos, step.pos, elapsed, step.duration),
+                blend(from.neg, step.neg, elapsed, step.duration),
+                blend(from.info, step.info, elapsed, step.duration),
+                false, 0
+            };
+            write(level);
+        }
+    }
+
+    bool isBusy() const {
+        return count > 0;
+    }
+
+    // When handle() next has something to do, while a pattern is playing
+    unsigned long nextStepAt() const {
+        const LedStep& step = queue[head];
+        if (step.fade) return lastFade + LED_FADE_STEP;
+        return stepStart + step.duration;
+    }
+
+    // A level between off and full is PWM, which needs the timer running
+    bool usesPwm() const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (queue[(head + i) % LED_QUEUE_SIZE].fade) return true;
+        }
+        return isDimmed(shown.pos) || isDimmed(shown.neg) || isDimmed(shown.info);
+    }
+
+    // Blocking wait that keeps patterns running, for setup code
+    void wait(unsigned long ms) {
+        unsigned long start = millis();
+        while (millis() - start < ms) {
+            handle();
+            delay(LED_FADE_STEP);
+        }
+    }
+
+    // Calls back from handle() once every queued pattern has played,
+    // so a caller can follow up without blocking the loop
+    void whenDone(void (*callback)()) {
+        onDone = callback;
+    }
+
+    // Blocks until every queued pattern has played
+    void finish() {
+        while (isBusy()) {
+            handle();
+            delay(LED_FADE_STEP);
+        }
+    }
+
+    // Drops queued patterns and shows the resting state
+    void cancel() {
+        count = 0;
+        write(rest);
+    }
+
     void allOff() {
-        digitalWrite(posLedPin, LOW);
-        posLedStatus = false;
-        digitalWrite(negLedPin, LOW);
-        negLedStatus = false;
-        digitalWrite(infoLedPin, LOW);
-        infoLedStatus = false;
+        setRest(0, 0, 0);
         digitalWrite(onboardLedPin, HIGH); // Onboard LED is active LOW
         onboardLedStatus = false;
     }
@@ -44,92 +165,181 @@ public:
     }
 
     void negOn() {
-        allOff();
-        negLedStatus = true;
-        digitalWrite(negLedPin, HIGH);
+        setRest(0, LED_PWM_RANGE, 0);
     }
 
     void negOff() {
-        negLedStatus = false;
-        digitalWrite(negLedPin, LOW);
+        setRest(rest.pos, 0, rest.info);
     }
 
     void posOn() {
-        allOff();
-        posLedStatus = true;
-        digitalWrite(posLedPin, HIGH);
+        setRest(LED_PWM_RANGE, 0, 0);
     }
 
     void posOff() {
-        posLedStatus = false;
-        digitalWrite(posLedPin, LOW);
+        setRest(0, rest.neg, rest.info);
     }
 
     void infoOn() {
-        allOff();
-        infoLedStatus = true;
-        digitalWrite(infoLedPin, HIGH);
+        setRest(0, 0, LED_PWM_RANGE);
     }
 
     void infoOff() {
-        infoLedStatus = false;
-        digitalWrite(infoLedPin, LOW);
+        setRest(rest.pos, rest.neg, 0);
     }
 
     void flashNeg(int num) {
-        for (int count = 0; count < num; count++) {
-            negOn();
-            delay(250);
-            negOff();
-            delay(250);
-        }
+        blink(LED_NEG, num);
     }
 
     void flashPos(int num) {
-        for (int count = 0; count < num; count++) {
-            posOn();
-            delay(250);
-            posOff();
-            delay(250);
-        }
+        blink(LED_POS, num);
     }
 
     void flashInfo(int num) {
-        for (int count = 0; count < num; count++) {
-            infoOn();
-            delay(250);
-            infoOff();
-            delay(250);
-        }
+        blink(LED_INFO, num);
     }
 
     void flashRgb(int num, bool splash = false) {
         if (splash) {
-            posOn();
-            delay(250);
-            negOn();
-            delay(250);
-            infoOn();
-            delay(250);
-        } else {
-            for (int count = 0; count < num; count++) {
-                negOn();
-                delay(250);
-                posOn();
-                delay(250);
-                infoOn();
-                delay(250);
+            num = 1;
+        }
+        for (int i = 0; i < num; i++) {
+            if (splash) {
+                push(level(LED_POS), false, LED_BLINK_MS);
+                push(level(LED_NEG), false, LED_BLINK_MS);
+            } else {
+                push(level(LED_NEG), false, LED_BLINK_MS);
+                push(level(LED_POS), false, LED_BLINK_MS);
             }
+            push(level(LED_INFO), false, LED_BLINK_MS);
+        }
+    }
+
+    // Slow fade in and out of one LED
+    void breathe(LedColor color, int num) {
+        for (int i = 0; i < num; i++) {
+            push(level(color), true, LED_BREATHE_MS);
+            push(off(), true, LED_BREATHE_MS);
+        }
+    }
+
+    // Switches between two LEDs, num times each
+    void alternate(LedColor first, LedColor second, int num) {
+        for (int i = 0; i < num; i++) {
+            push(level(first), false, LED_BLINK_MS);
+            push(level(second), false, LED_BLINK_MS);
         }
+        push(off(), false, LED_BLINK_MS);
+    }
+
+    // Pause between patterns with all LEDs off
+    void pause(uint16_t ms) {
+        push(off(), false, ms);
     }
 
+    // Trend LED for the 24h change, brighter the larger the move
     void updateLed(float changeVal) {
+        float magnitude = fabsf(changeVal) / LED_FULL_CHANGE;
+        if (magnitude > 1.0f) magnitude = 1.0f;
+        uint8_t brightness = LED_MIN_LEVEL + (uint8_t)((LED_PWM_RANGE - LED_MIN_LEVEL) * magnitude);
+
         if (changeVal < 0) {
-            negOn();
+            setRest(0, brightness, 0);
+        } else {
+            setRest(brightness, 0, 0);
+        }
+    }
+
+private:
+    void done() {
+        if (onDone == nullptr) return;
+        void (*callback)() = onDone;
+        onDone = nullptr;
+        callback();
+    }
+
+    void blink(LedColor color, int num) {
+        for (int i = 0; i < num; i++) {
+            push(level(color), false, LED_BLINK_MS);
+            push(off(), false, LED_BLINK_MS);
+        }
+    }
+
+    static LedStep level(LedColor color) {
+        LedStep step = {0, 0, 0, false, 0};
+        if (color == LED_POS) step.pos = LED_PWM_RANGE;
+        if (color == LED_NEG) step.neg = LED_PWM_RANGE;
+        if (color == LED_INFO) step.info = LED_PWM_RANGE;
+        return step;
+    }
+
+    static LedStep off() {
+        LedStep step = {0, 0, 0, false, 0};
+        return step;
+    }
+
+    // Queues a step, dropped if the queue is full
+    void push(LedStep step, bool fade, uint16_t duration) {
+        if (count == LED_QUEUE_SIZE) return;
+        step.fade = fade;
+        step.duration = duration;
+        queue[(head + count) % LED_QUEUE_SIZE] = step;
+        count++;
+        if (count == 1) {
+            from = shown;
+            startStep(millis());
+        }
+    }
+
+    void startStep(unsigned long now) {
+        stepStart = now;
+        lastFade = now;
+        if (count == 0) {
+            write(rest);
+        } else if (!queue[head].fade) {
+            write(queue[head]);
+        }
+    }
+
+    void setRest(uint8_t pos, uint8_t neg, uint8_t info) {
+        rest.pos = pos;
+        rest.neg = neg;
+        rest.info = info;
+        if (count == 0) {
+            write(rest);
+        }
+    }
+
+    static bool isDimmed(uint8_t level) {
+        return level > 0 && level < LED_PWM_RANGE;
+    }
+
+    static uint8_t blend(uint8_t a, uint8_t b, unsigned long elapsed, unsigned long duration) {
+        return a + ((int)b - (int)a) * (long)elapsed / (long)duration;
+    }
+
+    void write(const LedStep& level) {
+        writePin(posLedPin, shown.pos, level.pos);
+        writePin(negLedPin, shown.neg, level.neg);
+        writePin(infoLedPin, shown.info, level.info);
+        posLedStatus = level.pos > 0;
+        negLedStatus = level.neg > 0;
+        infoLedStatus = level.info > 0;
+    }
+
+    // Only touches the pin when the level changes
+    static void writePin(int pin, uint8_t& current, uint8_t level) {
+        if (current == level) return;
+        current = level;
+        if (level == 0) {
+            digitalWrite(pin, LOW);
+        } else if (level == LED_PWM_RANGE) {
+            digitalWrite(pin, HIGH);
         } else {
-            posOn();
+            analogWrite(pin, level);
         }
     }
 };
 
-#endif // LED_HANDLER_H 
\ No newline at end of file
+#endif // LED_HANDLER_H
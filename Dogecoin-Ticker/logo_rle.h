@@ -0,0 +1,85 @@
+#ifndef LOGO_RLE_H
+#define LOGO_RLE_H
+
+#include <Arduino.h>
+
+#define LOGO_WIDTH 128
+#define LOGO_PAGES 4                            // 8-pixel rows of the 128x32 display
+#define LOGO_BYTES (LOGO_WIDTH * LOGO_PAGES)    // Full-screen 1-bit logo
+#define LOGO_RUN_FLAG 0x80
+#define LOGO_MIN_RUN 2
+
+// Logos are run-length coded in SSD1306 page order, the layout of the
+// display buffer. They decode straight into it, and no full-size copy
+// is needed. Control byte c:
+//   c < 0x80   c + 1 literal bytes follow
+//   c >= 0x80  the next byte repeats (c & 0x7f) + 2 times
+// "LittleFS Data/make_logo.py" writes this format.
+
+// Bytes a stream decodes to, 0 if it is truncated. Works at compile time
+// on the built-in logos and at load time on logos read from LittleFS.
+constexpr size_t rleDecodedSize(const uint8_t* data, size_t len) {
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < len) {
+        uint8_t c = data[pos++];
+        if (c & LOGO_RUN_FLAG) {
+            if (pos + 1 > len) return 0;
+            out += (c & 0x7F) + LOGO_MIN_RUN;
+            pos += 1;
+        } else {
+            if (pos + c + 1 > len) return 0;
+            out += c + 1;
+            pos += c + 1;
+        }
+    }
+    return out;
+}
+
+// Decodes a logo into a display buffer. Data can be in flash or RAM.
+inline void drawRleLogo(uint8_t* buffer, const uint8_t* data, size_t len) {
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < len && out < LOGO_BYTES) {
+        uint8_t c = pgm_read_byte(data + pos++);
+        if (c & LOGO_RUN_FLAG) {
+            size_t count = min((size_t)(c & 0x7F) + LOGO_MIN_RUN, (size_t)LOGO_BYTES - out);
+            memset(buffer + out, pgm_read_byte(data + pos++), count);
+            out += count;
+        } else {
+            size_t count = min((size_t)c + 1, min((size_t)LOGO_BYTES - out, len - pos));
+            memcpy_P(buffer + out, data + pos, count);
+            pos += count;
+            out += count;
+        }
+    }
+}
+
+// Byte at a time decoding, for combining two logos in one pass
+class RleReader {
+private:
+    const uint8_t* data;
+    size_t len;
+    size_t pos = 0;
+    uint8_t left = 0;
+    bool run = false;
+    uint8_t value = 0;
+
+public:
+    RleReader(const uint8_t* data, size_t len) : data(data), len(len) {}
+
+    uint8_t next() {
+        if (left == 0) {
+            if (pos >= len) return 0;
+            uint8_t c = pgm_read_byte(data + pos++);
+            run = c & LOGO_RUN_FLAG;
+            left = run ? (c & 0x7F) + LOGO_MIN_RUN : c + 1;
+            if (run) value = pos < len ? pgm_read_byte(data + pos++) : 0;
+        }
+        left--;
+        if (run) return value;
+        return pos < len ? pgm_read_byte(data + pos++) : 0;
+    }
+};
+
+#endif // LOGO_RLE_H
@@ -0,0 +1,119 @@
+#ifndef LOGO_STORE_H
+#define LOGO_STORE_H
+
+#include <Arduino.h>
+#include "LittleFS.h"
+#include "coin_registry.h"
+#include "logo_rle.h"
+#include "ticker_state.h"
+
+#define LOGO_DIR "/logos/"          // <coin>.rle in lower case, e.g. /logos/shib.rle
+#define LOGO_FILE_MAGIC "RLE1"
+#define LOGO_MAGIC_SIZE 4
+#define LOGO_MAX_FILE 640           // Worst case coding of 512 bytes is 516
+#define LOGO_SLOTS 2                // A fade shows two logos at once
+
+struct Logo {
+    const uint8_t* data;            // Run-length coded, flash or heap
+    size_t len;
+};
+
+// Finds the logo for a coin. A file in LittleFS wins over the built-in
+// logo, so coins can get a logo, or a new one, without a firmware
+// build. Loaded files stay in a few small heap slots; coins with
+// neither show DOGE's logo.
+class LogoStore {
+private:
+    struct Slot {
+        char coin[STATE_SYMBOL_SIZE];
+        uint8_t* data;
+        size_t len;
+    };
+
+    Slot slots[LOGO_SLOTS];
+
+public:
+    LogoStore() {
+        for (int i = 0; i < LOGO_SLOTS; i++) {
+            slots[i].coin[0] = '\0';
+            slots[i].data = nullptr;
+            slots[i].len = 0;
+        }
+    }
+
+    // keep is a logo still on screen, its slot is not reused
+    Logo get(const char* coin, const uint8_t* keep = nullptr) {
+        for (int i = 0; i < LOGO_SLOTS; i++) {
+            if (slots[i].data != nullptr && strcasecmp(slots[i].coin, coin) == 0) {
+                return {slots[i].data, slots[i].len};
+            }
+        }
+
+        Logo logo;
+        if (load(coin, keep, logo)) return logo;
+
+        int id = coinByName(coin);
+        const CoinInfo& info = coinInfo(id < 0 ? COIN_DOGE : id);
+        return {info.logo, info.logoBytes};
+    }
+
+private:
+    bool load(const char* coin, const uint8_t* keep, Logo& logo) {
+        size_t coinLen = strlen(coin);
+        if (coinLen == 0 || coinLen >= STATE_SYMBOL_SIZE) return false;
+
+        char path[sizeof(LOGO_DIR) + STATE_SYMBOL_SIZE + 4];
+        int len = snprintf(path, sizeof(path), LOGO_DIR "%s.rle", coin);
+        for (int i = sizeof(LOGO_DIR) - 1; i < len; i++) {
+            path[i] = tolower(path[i]);
+        }
+        if (!LittleFS.exists(path)) return false;
+
+        File file = LittleFS.open(path, "r");
+        if (!file) return false;
+        size_t size = file.size();
+        char magic[LOGO_MAGIC_SIZE];
+        if (size <= LOGO_MAGIC_SIZE || size > LOGO_MAX_FILE ||
+            file.readBytes(magic, LOGO_MAGIC_SIZE) != LOGO_MAGIC_SIZE ||
+            memcmp(magic, LOGO_FILE_MAGIC, LOGO_MAGIC_SIZE) != 0) {
+            file.close();
+            return reject(path);
+        }
+
+        size -= LOGO_MAGIC_SIZE;
+        uint8_t* data = (uint8_t*)malloc(size);
+        if (data == nullptr) {
+            file.close();
+            return false;
+        }
+        size_t read = file.read(data, size);
+        file.close();
+        if (read != size || rleDecodedSize(data, size) != LOGO_BYTES) {
+            free(data);
+            return reject(path);
+        }
+
+        Slot* slot = &slots[0];
+        for (int i = 0; i < LOGO_SLOTS; i++) {
+            if (slots[i].data != keep) {
+                slot = &slots[i];
+                break;
+            }
+        }
+        free(slot->data);
+        slot->data = data;
+        slot->len = size;
+        strcpy(slot->coin, coin);
+        Serial.printf("Logo: %s, %u bytes\n", path, (unsigned)size);
+
+        logo = {slot->data, slot->len};
+        return true;
+    }
+
+    bool reject(const char* path) {
+        Serial.printf("Logo: %s is not a 128x32 logo, using the built-in one\n", path);
+        return false;
+    }
+};
+
+#endif // LOGO_STORE_H
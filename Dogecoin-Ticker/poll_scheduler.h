@@ -0,0 +1,168 @@
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define POLL_DEFAULT_MIN 30000      // Fetch interval bounds (ms)
+#define POLL_DEFAULT_MAX 120000
+#define POLL_LIMIT_MIN 5000         // Range the bounds can be set to (ms)
+#define POLL_LIMIT_MAX 3600000
+#define POLL_TARGET_MOVE 0.001f     // Aim for one fetch per 0.1% of price movement
+#define POLL_SMOOTHING 0.3f         // Weight of the newest sample in the movement rate
+#define POLL_JITTER 0.25f           // Backoff varies by up to +-25%
+#define POLL_MAX_DOUBLINGS 6        // Backoff stops growing at min * 64
+#define POLL_LOG_SIZE 16            // Recent decisions kept for /polling
+
+enum PollReason {
+    POLL_START,             // No price yet
+    POLL_ADAPTIVE,          // From the price movement rate
+    POLL_BACKOFF,           // Connection failures in a row
+    POLL_RETRY_AFTER,       // The server asked for a pause
+    POLL_REASON_COUNT
+};
+
+struct PollDecision {
+    uint32_t interval;      // ms
+    uint8_t reason;         // PollReason
+};
+
+// Picks the time to the next fetch. A fast-moving price shortens it
+// towards the minimum and a flat one stretches it to the maximum.
+// Connection failures back off exponentially with jitter, and a 429 or
+// 503 waits as long as Retry-After asks. Free of Arduino dependencies,
+// so recorded price traces can be replayed through it on a desktop.
+class PollScheduler {
+private:
+    uint32_t minInterval = POLL_DEFAULT_MIN;
+    uint32_t maxInterval = POLL_DEFAULT_MAX;
+
+    float rate = -1.0f;             // Relative move per minute, -1 until two prices are in
+    double lastValue = 0;
+    uint32_t lastPriceAt = 0;
+    uint8_t failures = 0;
+
+    PollDecision current = {POLL_DEFAULT_MIN, POLL_START};
+    PollDecision recent[POLL_LOG_SIZE];
+    uint8_t logHead = 0;
+    uint8_t logCount = 0;
+
+public:
+    // Swapped if given the wrong way round, then clamped to the limits
+    void setBounds(uint32_t minMs, uint32_t maxMs) {
+        if (minMs > maxMs) {
+            uint32_t swap = minMs;
+            minMs = maxMs;
+            maxMs = swap;
+        }
+        minInterval = clamp(minMs, POLL_LIMIT_MIN, POLL_LIMIT_MAX);
+        maxInterval = clamp(maxMs, POLL_LIMIT_MIN, POLL_LIMIT_MAX);
+        if (current.reason == POLL_ADAPTIVE || current.reason == POLL_START) {
+            decide(adaptiveInterval(), current.reason);
+        }
+    }
+
+    uint32_t getMin() const {
+        return minInterval;
+    }
+
+    uint32_t getMax() const {
+        return maxInterval;
+    }
+
+    // A new pair. Failures start counting again and its first price is
+    // not compared with the old pair's, but the interval and movement
+    // rate carry over, so switching pairs never speeds up fetching.
+    void resetBackoff() {
+        lastValue = 0;
+        failures = 0;
+    }
+
+    // A price of the shown pair arrived at `now` (ms)
+    uint32_t onPrice(double value, uint32_t now) {
+        failures = 0;
+        if (lastValue > 0 && value > 0) {
+            uint32_t elapsed = now - lastPriceAt;
+            if (elapsed == 0) elapsed = 1;
+            float move = (float)(fabs(value - lastValue) / lastValue);
+            float sample = move * 60000.0f / elapsed;
+            rate = rate < 0 ? sample : rate + POLL_SMOOTHING * (sample - rate);
+        }
+        lastValue = value;
+        lastPriceAt = now;
+        return decide(adaptiveInterval(), rate < 0 ? POLL_START : POLL_ADAPTIVE);
+    }
+
+    // Connect, send or read failed. random01 is uniform in [0, 1).
+    uint32_t onUnreachable(float random01) {
+        if (failures < POLL_MAX_DOUBLINGS) failures++;
+        float backoff = (float)minInterval * (1UL << failures);
+        backoff *= 1.0f - POLL_JITTER + 2.0f * POLL_JITTER * random01;
+        return decide(clamp((uint32_t)backoff, minInterval, maxInterval), POLL_BACKOFF);
+    }
+
+    // 429 or 503. Without a Retry-After it backs off like a failure.
+    // Jitter only adds, the server's wait is a minimum.
+    uint32_t onRateLimited(long retryAfterMs, float random01) {
+        if (retryAfterMs <= 0) return onUnreachable(random01);
+        if (failures < POLL_MAX_DOUBLINGS) failures++;
+        float wait = (float)retryAfterMs * (1.0f + POLL_JITTER * random01);
+        uint32_t interval = wait > POLL_LIMIT_MAX ? POLL_LIMIT_MAX : (uint32_t)wait;
+        return decide(interval < minInterval ? minInterval : interval, POLL_RETRY_AFTER);
+    }
+
+    // Any other failed fetch, the server is answering so keep the pace
+    uint32_t onFailed() {
+        return decide(adaptiveInterval(), current.reason == POLL_START ? POLL_START : POLL_ADAPTIVE);
+    }
+
+    uint32_t getInterval() const {
+        return current.interval;
+    }
+
+    PollReason getReason() const {
+        return (PollReason)current.reason;
+    }
+
+    float getRate() const {
+        return rate;
+    }
+
+    // Recent decisions, 0 is the newest
+    int getLogCount() const {
+        return logCount;
+    }
+
+    const PollDecision& getLog(int age) const {
+        return recent[(logHead + POLL_LOG_SIZE - 1 - age) % POLL_LOG_SIZE];
+    }
+
+    static const char* reasonName(int reason) {
+        static const char* const names[POLL_REASON_COUNT] = {"start", "adaptive", "backoff", "retry-after"};
+        return names[reason];
+    }
+
+private:
+    uint32_t adaptiveInterval() const {
+        if (rate < 0) return minInterval;
+        if (rate <= 0) return maxInterval;
+        float interval = POLL_TARGET_MOVE / rate * 60000.0f;
+        if (interval >= maxInterval) return maxInterval;
+        return clamp((uint32_t)interval, minInterval, maxInterval);
+    }
+
+    uint32_t decide(uint32_t interval, uint8_t reason) {
+        current.interval = interval;
+        current.reason = reason;
+        recent[logHead] = current;
+        logHead = (logHead + 1) % POLL_LOG_SIZE;
+        if (logCount < POLL_LOG_SIZE) logCount++;
+        return interval;
+    }
+
+    static uint32_t clamp(uint32_t value, uint32_t low, uint32_t high) {
+        return value < low ? low : value > high ? high : value;
+    }
+};
+
+#endif // POLL_SCHEDULER_H
@@ -0,0 +1,144 @@
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <stdint.h>
+
+#define POWER_MIN_NAP 5             // Shorter idle gaps are spent awake (ms)
+#define POWER_MAX_NAP 1000          // Longest nap, bounds serial and OTA polling (ms)
+#define POWER_SERVING_NAP 200       // Longest nap while web clients are being served (ms)
+
+// Supply current of the ESP8266 alone at 3.3 V, from the datasheet.
+// Display and LEDs are not included.
+#define POWER_VOLTAGE 3.3f
+#define POWER_AWAKE_MA 70.0f        // Radio always on
+#define POWER_MODEM_MA 15.0f        // Radio off between beacons, CPU clocked
+#define POWER_LIGHT_MA 0.9f         // CPU and radio asleep
+
+enum PowerMode {
+    POWER_AWAKE,            // Radio stays on and loop() never naps
+    POWER_MODEM_SLEEP,      // Radio sleeps between beacons, CPU idles through naps
+    POWER_LIGHT_SLEEP,      // CPU sleeps through naps as well
+    POWER_MODE_COUNT
+};
+
+struct PowerDecision {
+    PowerMode mode;
+    uint32_t napMs;         // 0 runs the next pass straight away
+};
+
+// Works out how long loop() may sleep and how deeply. Each pass starts
+// a plan, the handlers add when they next need the CPU or why it has
+// to stay up, and decide() returns the nap. Times are on the millis()
+// clock and may wrap. Free of Arduino dependencies, so it can be driven
+// by a virtual clock on a desktop compiler.
+class PowerPlanner {
+private:
+    uint32_t now = 0;
+    uint32_t deadline = 0;
+    bool awake = false;             // No nap this pass
+    bool radioAwake = false;        // Radio stays on as well
+    bool lightAllowed = true;
+
+public:
+    void begin(uint32_t nowMs) {
+        now = nowMs;
+        deadline = nowMs + POWER_MAX_NAP;
+        awake = false;
+        radioAwake = false;
+        lightAllowed = true;
+    }
+
+    // Something is due at `at`, a time already passed means now
+    void wakeBy(uint32_t at) {
+        if ((int32_t)(at - deadline) < 0) deadline = at;
+    }
+
+    // Work that needs every pass, e.g. a fetch in flight
+    void stayAwake() {
+        awake = true;
+    }
+
+    // Clients that expect low latency, e.g. open websockets
+    void keepRadio() {
+        awake = true;
+        radioAwake = true;
+    }
+
+    // Web or OTA clients talking to the device, whose packets wait for
+    // the radio while it naps
+    void serving() {
+        wakeBy(now + POWER_SERVING_NAP);
+    }
+
+    // PWM runs off a timer that light sleep stops
+    void noLightSleep() {
+        lightAllowed = false;
+    }
+
+    PowerDecision decide() const {
+        PowerDecision decision;
+        decision.mode = radioAwake ? POWER_AWAKE : lightAllowed ? POWER_LIGHT_SLEEP : POWER_MODEM_SLEEP;
+        decision.napMs = 0;
+        if (awake) return decision;
+
+        int32_t idle = (int32_t)(deadline - now);
+        if (idle >= POWER_MIN_NAP) decision.napMs = idle;
+        return decision;
+    }
+};
+
+// Time spent running and napping in each mode, and the energy that
+// works out to under the datasheet currents above
+class PowerStats {
+private:
+    uint32_t busyMs[POWER_MODE_COUNT] = {};
+    uint32_t napMs[POWER_MODE_COUNT] = {};
+
+public:
+    void addBusy(PowerMode mode, uint32_t ms) {
+        busyMs[mode] += ms;
+    }
+
+    void addNap(PowerMode mode, uint32_t ms) {
+        napMs[mode] += ms;
+    }
+
+    uint32_t getTotalMs() const {
+        uint32_t total = 0;
+        for (int i = 0; i < POWER_MODE_COUNT; i++) total += busyMs[i] + napMs[i];
+        return total;
+    }
+
+    uint32_t getNapMs(PowerMode mode) const {
+        return napMs[mode];
+    }
+
+    // Fraction of the time loop() was running, 0-1
+    float getDutyCycle() const {
+        uint32_t total = getTotalMs();
+        if (total == 0) return 1.0f;
+        uint32_t busy = 0;
+        for (int i = 0; i < POWER_MODE_COUNT; i++) busy += busyMs[i];
+        return (float)busy / total;
+    }
+
+    // Average power as energy per hour. A running CPU in light sleep
+    // mode draws like modem sleep; only its naps reach light sleep.
+    float getMilliwattHoursPerHour() const {
+        uint32_t total = getTotalMs();
+        if (total == 0) return 0.0f;
+        float charge = (busyMs[POWER_AWAKE] + napMs[POWER_AWAKE]) * POWER_AWAKE_MA +
+                       (busyMs[POWER_MODEM_SLEEP] + napMs[POWER_MODEM_SLEEP] + busyMs[POWER_LIGHT_SLEEP]) * POWER_MODEM_MA +
+                       napMs[POWER_LIGHT_SLEEP] * POWER_LIGHT_MA;
+        return charge / total * POWER_VOLTAGE;
+    }
+
+    void reset() {
+        for (int i = 0; i < POWER_MODE_COUNT; i++) {
+            busyMs[i] = 0;
+            napMs[i] = 0;
+        }
+    }
+};
+
+#endif // POWER_POLICY_H
@@ -0,0 +1,116 @@
+#ifndef POWER_SCHEDULER_H
+#define POWER_SCHEDULER_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <coredecls.h>
+#include <ESPAsyncWebServer.h>
+#include "power_policy.h"
+#include "button_handler.h"
+
+#define POWER_BUTTON_POLL 100       // Button check period in light sleep naps (ms)
+#define POWER_WEB_IDLE 5000         // A web client counts as connected this long after a request (ms)
+
+// Applies the planner's decision at the end of each loop() pass. The
+// Wi-Fi sleep type follows the mode, and the nap is spent in the SDK,
+// which sleeps the radio between beacons and, in light sleep mode, the
+// CPU too. A button press ends a nap early: through its interrupt, or
+// in light sleep, where the interrupt is off, within POWER_BUTTON_POLL.
+class PowerScheduler {
+private:
+    PowerPlanner planner;
+    PowerStats stats;
+    ButtonHandler* button;
+
+    PowerMode mode = POWER_AWAKE;
+    bool started = false;               // Sleep types are left alone until Wi-Fi is up
+    unsigned long lastWake = 0;
+
+public:
+    PowerScheduler(ButtonHandler* buttonHandler) : button(buttonHandler) {}
+
+    // Starts a pass's plan, see PowerPlanner
+    PowerPlanner& plan(unsigned long now) {
+        planner.begin(now);
+        return planner;
+    }
+
+    // Call once Wi-Fi has connected, changing the sleep type during the
+    // join slows it down
+    void begin() {
+        started = true;
+        lastWake = millis();
+        stats.reset();
+        setMode(POWER_MODEM_SLEEP);
+    }
+
+    // Call last in loop(), after the plan is complete
+    void sleep() {
+        if (!started) return;
+
+        PowerDecision decision = planner.decide();
+        setMode(decision.mode);
+
+        unsigned long start = millis();
+        stats.addBusy(mode, start - lastWake);
+        if (decision.napMs > 0 && !ButtonHandler::hasEdge()) {
+            if (mode == POWER_LIGHT_SLEEP) {
+                button->armWake();
+                esp_delay(decision.napMs, []() { return !ButtonHandler::isDown(); }, POWER_BUTTON_POLL);
+                button->disarmWake();
+            } else {
+                esp_delay(decision.napMs, []() { return !ButtonHandler::hasEdge(); });
+            }
+        }
+        lastWake = millis();
+        stats.addNap(mode, lastWake - start);
+    }
+
+    PowerMode getMode() const {
+        return mode;
+    }
+
+    const PowerStats& getStats() const {
+        return stats;
+    }
+
+    static const char* modeName(PowerMode mode) {
+        static const char* const names[POWER_MODE_COUNT] = {"awake", "modem", "light"};
+        return names[mode];
+    }
+
+private:
+    void setMode(PowerMode next) {
+        if (next == mode) return;
+        mode = next;
+        if (mode == POWER_AWAKE) {
+            WiFi.setSleepMode(WIFI_NONE_SLEEP);
+        } else if (mode == POWER_MODEM_SLEEP) {
+            WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+        } else {
+            WiFi.setSleepMode(WIFI_LIGHT_SLEEP);
+        }
+    }
+};
+
+// Notes every web request without handling it. Add it to the server
+// before any other handler, so requests are seen before one claims them.
+class WebActivity : public AsyncWebHandler {
+private:
+    volatile unsigned long lastRequest = 0;
+    volatile bool seen = false;
+
+public:
+    bool canHandle(AsyncWebServerRequest* request) override {
+        lastRequest = millis();
+        seen = true;
+        return false;
+    }
+
+    // A browser loading the page or an upload in progress
+    bool isActive() const {
+        return seen && millis() - lastRequest < POWER_WEB_IDLE;
+    }
+};
+
+#endif // POWER_SCHEDULER_H
@@ -0,0 +1,131 @@
+#ifndef PRICE_H
+#define PRICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PRICE_MAX_SCALE 12              // Fraction digits kept when parsing
+#define PRICE_MAX_MANTISSA 99999999999999999LL
+
+// Fixed-point decimal price: value = mantissa / 10^scale.
+// Parsed straight from the API text, so no float round trips.
+struct Price {
+    int64_t mantissa = 0;
+    uint8_t scale = 0;
+
+    // Parses "123", "0.00001234" or "-1.5". Digits past what fits are dropped.
+    bool parse(const char* text) {
+        mantissa = 0;
+        scale = 0;
+        if (text == nullptr) return false;
+
+        bool negative = false;
+        if (*text == '-') {
+            negative = true;
+            text++;
+        } else if (*text == '+') {
+            text++;
+        }
+
+        bool digits = false;
+        bool fraction = false;
+        for (; *text != '\0'; text++) {
+            char c = *text;
+            if (c == '.' && !fraction) {
+                fraction = true;
+                continue;
+            }
+            if (c < '0' || c > '9') return false;
+            digits = true;
+
+            if (fraction && scale >= PRICE_MAX_SCALE) continue;
+            if (mantissa > PRICE_MAX_MANTISSA / 10) {
+                if (fraction) continue;   // Drop low fraction digits
+                return false;             // Integer part too large
+            }
+            mantissa = mantissa * 10 + (c - '0');
+            if (fraction) scale++;
+        }
+
+        if (negative) mantissa = -mantissa;
+        return digits;
+    }
+
+    bool isPositive() const {
+        return mantissa > 0;
+    }
+
+    // Approximate value, for comparing and rating prices, not for display
+    double toDouble() const {
+        double value = (double)mantissa;
+        for (uint8_t i = 0; i < scale; i++) value /= 10;
+        return value;
+    }
+
+    // Mantissa at the given number of fraction digits, rounded half away from zero
+    int64_t rescaled(uint8_t decimals) const {
+        int64_t value = mantissa;
+        uint8_t current = scale;
+        while (current < decimals) {
+            value *= 10;
+            current++;
+        }
+        if (current > decimals) {
+            int64_t divisor = 1;
+            while (current > decimals) {
+                divisor *= 10;
+                current--;
+            }
+            int64_t half = divisor / 2;
+            value = value >= 0 ? (value + half) / divisor : (value - half) / divisor;
+        }
+        return value;
+    }
+
+    // Writes at most maxDecimals fraction digits (never more than parsed),
+    // dropping further digits while the text is longer than maxChars.
+    // Returns the length written, without heap use.
+    size_t format(char* out, size_t size, uint8_t maxDecimals, size_t maxChars) const {
+        uint8_t decimals = scale < maxDecimals ? scale : maxDecimals;
+
+        for (;;) {
+            int64_t value = rescaled(decimals);
+            char digits[24];
+            size_t count = 0;
+            bool negative = value < 0;
+            uint64_t magnitude = negative ? -(uint64_t)value : (uint64_t)value;
+
+            // Digits least significant first, at least one before the point
+            do {
+                digits[count++] = '0' + magnitude % 10;
+                magnitude /= 10;
+            } while (magnitude > 0 || count <= decimals);
+
+            size_t length = count + (negative ? 1 : 0) + (decimals > 0 ? 1 : 0);
+            if (length > maxChars && decimals > 0) {
+                decimals--;
+                continue;
+            }
+
+            size_t pos = 0;
+            if (negative && pos + 1 < size) out[pos++] = '-';
+            while (count > 0 && pos + 1 < size) {
+                if (count == decimals) out[pos++] = '.';
+                if (pos + 1 < size) out[pos++] = digits[--count];
+            }
+            out[pos] = '\0';
+            return pos;
+        }
+    }
+
+    bool operator==(const Price& other) const {
+        uint8_t common = scale > other.scale ? scale : other.scale;
+        return rescaled(common) == other.rescaled(common);
+    }
+
+    bool operator!=(const Price& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // PRICE_H
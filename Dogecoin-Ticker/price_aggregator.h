@@ -0,0 +1,148 @@
+#ifndef PRICE_AGGREGATOR_H
+#define PRICE_AGGREGATOR_H
+
+#include <stdint.h>
+#include <math.h>
+#include "price.h"
+
+#define AGG_MAX_QUOTES 4            // Sources answering one fetch
+#define AGG_OUTLIER 0.02            // Quotes further than 2% from the median are dropped
+
+// One source's answer to a fetch
+struct Quote {
+    Price price;
+    float change;
+    bool hasChange;
+    uint8_t source;         // Position in the source list, lower is preferred
+};
+
+// Combines the quotes of one fetch. The median is found, quotes too far
+// from it are rejected as outliers, and the median of the rest is the
+// result. The result is always one of the quotes, never an average, so
+// its decimal text is what an exchange sent. With an even count the
+// preferred source of the two middle quotes wins. Two quotes that
+// disagree give no way to tell which one is wrong, so both are rejected.
+// The 24h change comes from the preferred source that kept its quote
+// and has one. Free of Arduino dependencies, so it can be checked on a
+// desktop compiler.
+class PriceAggregator {
+private:
+    Quote quotes[AGG_MAX_QUOTES];
+    uint8_t count = 0;
+    uint8_t outliers = 0;           // Bit per quote
+    int chosen = -1;
+    int changeFrom = -1;
+
+public:
+    void reset() {
+        count = 0;
+        outliers = 0;
+        chosen = -1;
+        changeFrom = -1;
+    }
+
+    bool add(const Price& price, float change, bool hasChange, uint8_t source) {
+        if (count >= AGG_MAX_QUOTES || !price.isPositive()) return false;
+        quotes[count].price = price;
+        quotes[count].change = change;
+        quotes[count].hasChange = hasChange;
+        quotes[count].source = source;
+        count++;
+        return true;
+    }
+
+    // Returns false without any quotes, or when just two disagree
+    bool aggregate() {
+        outliers = 0;
+        changeFrom = -1;
+        chosen = median(0);
+        if (chosen < 0) return false;
+
+        double reference = quotes[chosen].price.toDouble();
+        for (int i = 0; i < count; i++) {
+            if (fabs(quotes[i].price.toDouble() - reference) > reference * AGG_OUTLIER) {
+                outliers |= 1 << i;
+            }
+        }
+        if (count == 2 && outliers != 0) {
+            outliers = 0x3;
+            chosen = -1;
+            return false;
+        }
+        chosen = median(outliers);
+
+        for (int i = 0; i < count; i++) {
+            if (isOutlier(i) || !quotes[i].hasChange) continue;
+            if (changeFrom < 0 || quotes[i].source < quotes[changeFrom].source) changeFrom = i;
+        }
+        return true;
+    }
+
+    int getCount() const {
+        return count;
+    }
+
+    const Quote& getQuote(int i) const {
+        return quotes[i];
+    }
+
+    bool isOutlier(int i) const {
+        return (outliers & (1 << i)) != 0;
+    }
+
+    int getOutlierCount() const {
+        int n = 0;
+        for (int i = 0; i < count; i++) n += isOutlier(i) ? 1 : 0;
+        return n;
+    }
+
+    const Price& getPrice() const {
+        return quotes[chosen].price;
+    }
+
+    // Source list position the price was taken from
+    uint8_t getSource() const {
+        return quotes[chosen].source;
+    }
+
+    bool hasChange() const {
+        return changeFrom >= 0;
+    }
+
+    float getChange() const {
+        return changeFrom >= 0 ? quotes[changeFrom].change : 0;
+    }
+
+private:
+    // Index of the median among the quotes not in `skip`, -1 if none.
+    // Counts how many quotes sort below each candidate, fine for a handful.
+    int median(uint8_t skip) const {
+        int n = 0;
+        for (int i = 0; i < count; i++) n += (skip & (1 << i)) ? 0 : 1;
+        if (n == 0) return -1;
+
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (skip & (1 << i)) continue;
+            int below = 0;
+            for (int j = 0; j < count; j++) {
+                if (j == i || (skip & (1 << j))) continue;
+                if (less(j, i)) below++;
+            }
+            // Odd: the middle one. Even: either of the middle two.
+            bool middle = n % 2 == 1 ? below == n / 2 : below == n / 2 - 1 || below == n / 2;
+            if (middle && (best < 0 || quotes[i].source < quotes[best].source)) best = i;
+        }
+        return best;
+    }
+
+    // Price order, ties broken by source so every quote has its own rank
+    bool less(int a, int b) const {
+        double pa = quotes[a].price.toDouble();
+        double pb = quotes[b].price.toDouble();
+        if (pa != pb) return pa < pb;
+        return quotes[a].source < quotes[b].source;
+    }
+};
+
+#endif // PRICE_AGGREGATOR_H
@@ -0,0 +1,165 @@
+#ifndef PRICE_FEED_PARSER_H
+#define PRICE_FEED_PARSER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ArduinoJson.h>
+#include "price.h"
+
+#define FEED_RECORD_SIZE 96     // Largest single pricefeed record kept in RAM
+#define FEED_PAIR_SIZE 16
+
+// Called for every record of a batch fetch
+typedef void (*FeedRecordCallback)(const char* pair, const Price& price, float change);
+
+// Splits a /v1/pricefeed body into its top-level {...} records as the
+// bytes arrive and runs each one through ArduinoJson with a filter, so
+// only one record is ever held in memory. Needs nothing from the
+// Arduino core, so it also builds on a desktop compiler.
+class PriceFeedParser {
+private:
+    char wantedPair[FEED_PAIR_SIZE];
+    FeedRecordCallback onRecord = nullptr;
+    char record[FEED_RECORD_SIZE];
+    size_t recordLen = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    bool overflow = false;
+    unsigned int skipped = 0;   // Records too large for the buffer
+
+    StaticJsonDocument<96> filter;
+    DeserializationError lastError;
+
+    bool matched = false;
+    Price price;
+    float change = 0;
+
+public:
+    PriceFeedParser() {
+        filter["pair"] = true;
+        filter["price"] = true;
+        filter["percentChange24h"] = true;
+        wantedPair[0] = '\0';
+    }
+
+    // With a record callback every record in the feed is reported,
+    // otherwise parsing stops at the wanted pair.
+    void begin(const char* pair, FeedRecordCallback recordCallback = nullptr) {
+        snprintf(wantedPair, sizeof(wantedPair), "%s", pair);
+        onRecord = recordCallback;
+        recordLen = 0;
+        depth = 0;
+        inString = false;
+        escaped = false;
+        overflow = false;
+        skipped = 0;
+        lastError = DeserializationError::Ok;
+        matched = false;
+        price = Price();
+        change = 0;
+    }
+
+    void feed(const char* data, size_t len) {
+        for (size_t i = 0; i < len && (onRecord != nullptr || !matched); i++) {
+            feedChar(data[i]);
+        }
+    }
+
+    bool found() const {
+        return matched;
+    }
+
+    const Price& getPrice() const {
+        return price;
+    }
+
+    float getChange() const {
+        return change;
+    }
+
+    DeserializationError error() const {
+        return lastError;
+    }
+
+    unsigned int getSkippedCount() const {
+        return skipped;
+    }
+
+private:
+    void feedChar(char c) {
+        // Outside a record only '{' matters; array brackets and commas are skipped
+        if (depth == 0) {
+            if (c == '{') {
+                recordLen = 0;
+                overflow = false;
+                append(c);
+                depth = 1;
+            }
+            return;
+        }
+
+        append(c);
+
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            depth++;
+        } else if (c == '}' && --depth == 0) {
+            handleRecord();
+        }
+    }
+
+    void append(char c) {
+        if (recordLen < FEED_RECORD_SIZE) {
+            record[recordLen++] = c;
+        } else {
+            overflow = true;
+        }
+    }
+
+    void handleRecord() {
+        if (overflow) {
+            skipped++;
+            return;
+        }
+
+        StaticJsonDocument<128> doc;
+        DeserializationError err = deserializeJson(doc, record, recordLen,
+            DeserializationOption::Filter(filter));
+        if (err) {
+            lastError = err;
+            return;
+        }
+
+        // The price is kept as the exact decimal text the API sent
+        const char* pair = doc["pair"];
+        Price recordPrice;
+        if (!recordPrice.parse(doc["price"])) {
+            return;
+        }
+        float recordChange = doc["percentChange24h"].as<float>();
+
+        if (onRecord != nullptr && pair != nullptr) {
+            onRecord(pair, recordPrice, recordChange);
+        }
+
+        if (matched || (pair != nullptr && strcasecmp(pair, wantedPair) != 0)) {
+            return;
+        }
+        price = recordPrice;
+        change = recordChange;
+        matched = true;
+    }
+};
+
+#endif // PRICE_FEED_PARSER_H
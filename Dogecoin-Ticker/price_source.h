@@ -0,0 +1,303 @@
+#ifndef PRICE_SOURCE_H
+#define PRICE_SOURCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <ArduinoJson.h>
+#include "price.h"
+#include "price_feed_parser.h"
+
+#define SOURCE_BODY_SIZE 160    // Whole body kept for sources that answer with one small object
+#define SOURCE_BODY_LARGE 448   // Bitstamp's ticker, every field of the market
+
+// A REST endpoint that quotes prices. Formats the request path for a
+// pair and parses the response body as it arrives. ApiHandler owns the
+// connection, so a new exchange only needs a subclass here. Needs
+// nothing from the Arduino core, so it also builds on a desktop compiler.
+class PriceSource {
+public:
+    virtual ~PriceSource() {}
+
+    // Short lowercase name for logs and telemetry
+    virtual const char* getName() const = 0;
+    virtual const char* getHost() const = 0;
+
+    // Path of the request for the pair, e.g. "/v1/pricefeed/DOGEUSD"
+    virtual void formatPath(char* out, size_t size, const char* crypto, const char* fiat) const = 0;
+
+    // Starts parsing the body of a new response
+    virtual void begin(const char* crypto, const char* fiat) = 0;
+    virtual void feed(const char* data, size_t len) = 0;
+
+    // The body is complete
+    virtual void end() {}
+
+    virtual bool found() const = 0;
+    virtual const Price& getPrice() const = 0;
+
+    // Not every exchange reports a 24h change
+    virtual bool hasChange() const {
+        return false;
+    }
+
+    virtual float getChange() const {
+        return 0;
+    }
+
+    // Why no price was found, nullptr if the pair was simply missing
+    virtual const char* getError() const {
+        return nullptr;
+    }
+
+    // Ask the server for 1 KB TLS records, so a small receive buffer
+    // will do and the connection can stay open between fetches. A server
+    // that ignores the request fails the handshake, and the retry uses
+    // the full buffer. Override for servers known to ignore it.
+    virtual bool shortRecords() const {
+        return true;
+    }
+
+    // The exchange lists the pair. Others aren't asked, rather than
+    // counting a failure on every fetch.
+    virtual bool supports(const char* crypto, const char* fiat) const {
+        return true;
+    }
+};
+
+// Keeps the whole body and parses it once it is complete, for sources
+// that answer with one small JSON object. The subclass owns the buffer.
+class BufferedSource : public PriceSource {
+protected:
+    char* body;
+    size_t capacity;
+    size_t bodyLen = 0;
+    bool overflow = false;
+    Price price;
+    DeserializationError lastError;
+
+    BufferedSource(char* buffer, size_t size) : body(buffer), capacity(size) {}
+
+public:
+    void begin(const char* crypto, const char* fiat) override {
+        bodyLen = 0;
+        overflow = false;
+        price = Price();
+        lastError = DeserializationError::Ok;
+    }
+
+    void feed(const char* data, size_t len) override {
+        if (bodyLen + len > capacity) {
+            overflow = true;
+            return;
+        }
+        memcpy(body + bodyLen, data, len);
+        bodyLen += len;
+    }
+
+    const Price& getPrice() const override {
+        return price;
+    }
+
+    const char* getError() const override {
+        return lastError ? lastError.c_str() : nullptr;
+    }
+};
+
+// Gemini's /v1/pricefeed. In batch mode the whole feed is read and
+// every record goes to the callback, which keeps the price table and
+// symbol index filled from the one request.
+class GeminiSource : public PriceSource {
+private:
+    PriceFeedParser parser;
+    FeedRecordCallback onRecord = nullptr;
+
+public:
+    void setBatchMode(FeedRecordCallback recordCallback) {
+        onRecord = recordCallback;
+    }
+
+    bool isBatch() const {
+        return onRecord != nullptr;
+    }
+
+    const char* getName() const override {
+        return "gemini";
+    }
+
+    const char* getHost() const override {
+        return "api.gemini.com";
+    }
+
+    void formatPath(char* out, size_t size, const char* crypto, const char* fiat) const override {
+        if (isBatch()) {
+            snprintf(out, size, "/v1/pricefeed");
+        } else {
+            snprintf(out, size, "/v1/pricefeed/%s%s", crypto, fiat);
+        }
+    }
+
+    void begin(const char* crypto, const char* fiat) override {
+        char pair[FEED_PAIR_SIZE];
+        snprintf(pair, sizeof(pair), "%s%s", crypto, fiat);
+        parser.begin(pair, onRecord);
+    }
+
+    void feed(const char* data, size_t len) override {
+        parser.feed(data, len);
+    }
+
+    // Records too large for the parser's buffer
+    unsigned int getSkippedCount() const {
+        return parser.getSkippedCount();
+    }
+
+    bool found() const override {
+        return parser.found();
+    }
+
+    const Price& getPrice() const override {
+        return parser.getPrice();
+    }
+
+    bool hasChange() const override {
+        return parser.found();
+    }
+
+    float getChange() const override {
+        return parser.getChange();
+    }
+
+    const char* getError() const override {
+        return parser.error() ? parser.error().c_str() : nullptr;
+    }
+};
+
+// Coinbase's spot price, {"data":{"amount":"0.0712","base":"DOGE",...}}.
+// No 24h change.
+class CoinbaseSource : public BufferedSource {
+private:
+    char buffer[SOURCE_BODY_SIZE];
+    bool matched = false;
+
+public:
+    CoinbaseSource() : BufferedSource(buffer, sizeof(buffer)) {}
+
+    const char* getName() const override {
+        return "coinbase";
+    }
+
+    const char* getHost() const override {
+        return "api.coinbase.com";
+    }
+
+    void formatPath(char* out, size_t size, const char* crypto, const char* fiat) const override {
+        snprintf(out, size, "/v2/prices/%s-%s/spot", crypto, fiat);
+    }
+
+    void begin(const char* crypto, const char* fiat) override {
+        BufferedSource::begin(crypto, fiat);
+        matched = false;
+    }
+
+    void end() override {
+        if (overflow) {
+            lastError = DeserializationError::NoMemory;
+            return;
+        }
+
+        StaticJsonDocument<64> filter;
+        filter["data"]["amount"] = true;
+        StaticJsonDocument<128> doc;
+        lastError = deserializeJson(doc, body, bodyLen, DeserializationOption::Filter(filter));
+        if (lastError) return;
+
+        // Sent as a string, so the exact decimal text is kept
+        matched = price.parse(doc["data"]["amount"]);
+    }
+
+    bool found() const override {
+        return matched;
+    }
+};
+
+// Bitstamp's ticker, {"last":"0.0712",...,"percent_change_24":"-2.11",...}.
+// The third opinion that lets the aggregator outvote a wrong price.
+class BitstampSource : public BufferedSource {
+private:
+    char buffer[SOURCE_BODY_LARGE];
+    bool matched = false;
+    bool changed = false;
+    float change = 0;
+
+public:
+    BitstampSource() : BufferedSource(buffer, sizeof(buffer)) {}
+
+    const char* getName() const override {
+        return "bitstamp";
+    }
+
+    const char* getHost() const override {
+        return "www.bitstamp.net";
+    }
+
+    // Only dollar, euro and pound markets, and no Monero
+    bool supports(const char* crypto, const char* fiat) const override {
+        if (strcasecmp(crypto, "XMR") == 0) return false;
+        return strcasecmp(fiat, "USD") == 0 || strcasecmp(fiat, "EUR") == 0 || strcasecmp(fiat, "GBP") == 0;
+    }
+
+    // Pairs are lowercase, e.g. /api/v2/ticker/dogeusd/
+    void formatPath(char* out, size_t size, const char* crypto, const char* fiat) const override {
+        int len = snprintf(out, size, "/api/v2/ticker/%s%s/", crypto, fiat);
+        for (int i = 0; i < len && (size_t)i < size; i++) {
+            out[i] = tolower((unsigned char)out[i]);
+        }
+    }
+
+    void begin(const char* crypto, const char* fiat) override {
+        BufferedSource::begin(crypto, fiat);
+        matched = false;
+        changed = false;
+        change = 0;
+    }
+
+    void end() override {
+        if (overflow) {
+            lastError = DeserializationError::NoMemory;
+            return;
+        }
+
+        StaticJsonDocument<64> filter;
+        filter["last"] = true;
+        filter["percent_change_24"] = true;
+        StaticJsonDocument<128> doc;
+        lastError = deserializeJson(doc, body, bodyLen, DeserializationOption::Filter(filter));
+        if (lastError) return;
+
+        matched = price.parse(doc["last"]);
+
+        // In percent, and null for markets without a day of trades
+        const char* percent = doc["percent_change_24"];
+        if (percent != nullptr) {
+            change = (float)(atof(percent) / 100.0);
+            changed = true;
+        }
+    }
+
+    bool found() const override {
+        return matched;
+    }
+
+    bool hasChange() const override {
+        return changed;
+    }
+
+    float getChange() const override {
+        return change;
+    }
+};
+
+#endif // PRICE_SOURCE_H
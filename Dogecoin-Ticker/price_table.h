@@ -0,0 +1,134 @@
+#ifndef PRICE_TABLE_H
+#define PRICE_TABLE_H
+
+#include <Arduino.h>
+#include "price.h"
+#include "coin_registry.h"
+
+#define PRICE_AGE_BUCKETS 5     // <30s, <1m, <2m, <5m, older
+
+// Latest price for every registry crypto/fiat pair, filled from
+// fetches and read back on coin switches. Dimensions are template
+// parameters so the footprint is fixed at compile time.
+template <int NUM_CRYPTOS, int NUM_FIATS>
+class PriceTable {
+    static_assert(NUM_CRYPTOS <= COIN_COUNT && NUM_FIATS <= FIAT_COUNT, "Table larger than the registry");
+
+private:
+    // 8 byte mantissa, scale and padding, then change, time and flag
+    struct Entry {
+        Price price;
+        float change;
+        uint32_t fetchedAt;     // millis()
+        bool valid;
+    };
+    static_assert(sizeof(Entry) == 32, "PriceTable entry is documented as 32 bytes");
+
+    Entry entries[NUM_CRYPTOS][NUM_FIATS];
+
+    // Lookup statistics, ages are those of the entries that were hit
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    unsigned long ageCounts[PRICE_AGE_BUCKETS] = {};
+
+public:
+    PriceTable() {
+        for (int c = 0; c < NUM_CRYPTOS; c++) {
+            for (int f = 0; f < NUM_FIATS; f++) {
+                entries[c][f].valid = false;
+            }
+        }
+    }
+
+    // Finds the indices of a feed pair name (e.g. "DOGEUSD") if we track it
+    bool findPair(const char* pair, int& crypto, int& fiat) const {
+        for (int c = 0; c < NUM_CRYPTOS; c++) {
+            const char* name = coinInfo(c).name;
+            size_t cryptoLen = strlen(name);
+            if (strncasecmp(pair, name, cryptoLen) != 0) continue;
+
+            for (int f = 0; f < NUM_FIATS; f++) {
+                if (strcasecmp(pair + cryptoLen, fiatInfo(f).name) == 0) {
+                    crypto = c;
+                    fiat = f;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool store(const char* pair, const Price& price, float change) {
+        int crypto, fiat;
+        if (!findPair(pair, crypto, fiat)) return false;
+        store(crypto, fiat, price, change);
+        return true;
+    }
+
+    void store(int crypto, int fiat, const Price& price, float change) {
+        if (!inRange(crypto, fiat)) return;
+        Entry& entry = entries[crypto][fiat];
+        entry.price = price;
+        entry.change = change;
+        entry.fetchedAt = millis();
+        entry.valid = true;
+    }
+
+    // Returns the cached price and its age in ms, counting hits and misses
+    bool lookup(int crypto, int fiat, Price& price, float& change, unsigned long& age) {
+        if (!peek(crypto, fiat, price, change, age)) {
+            misses++;
+            return false;
+        }
+        hits++;
+        ageCounts[ageBucket(age)]++;
+        return true;
+    }
+
+    // Same as lookup() for redraws that aren't coin switches
+    bool peek(int crypto, int fiat, Price& price, float& change, unsigned long& age) const {
+        if (!inRange(crypto, fiat) || !entries[crypto][fiat].valid) return false;
+
+        const Entry& entry = entries[crypto][fiat];
+        price = entry.price;
+        change = entry.change;
+        age = (uint32_t)millis() - entry.fetchedAt;
+        return true;
+    }
+
+    unsigned long getHits() const {
+        return hits;
+    }
+
+    unsigned long getMisses() const {
+        return misses;
+    }
+
+    const unsigned long* getAgeCounts() const {
+        return ageCounts;
+    }
+
+    static const char* ageBucketLabel(int bucket) {
+        static const char* const labels[PRICE_AGE_BUCKETS] = {"<30s", "<1m", "<2m", "<5m", ">5m"};
+        return labels[bucket];
+    }
+
+    static constexpr size_t footprint() {
+        return sizeof(Entry) * NUM_CRYPTOS * NUM_FIATS;
+    }
+
+private:
+    static bool inRange(int crypto, int fiat) {
+        return crypto >= 0 && crypto < NUM_CRYPTOS && fiat >= 0 && fiat < NUM_FIATS;
+    }
+
+    static int ageBucket(unsigned long age) {
+        if (age < 30000) return 0;
+        if (age < 60000) return 1;
+        if (age < 120000) return 2;
+        if (age < 300000) return 3;
+        return 4;
+    }
+};
+
+#endif // PRICE_TABLE_H
@@ -0,0 +1,176 @@
+#ifndef SPARKLINE_H
+#define SPARKLINE_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "price.h"
+
+#define SPARKLINE_CAPACITY 64           // Samples kept per pair, 32 min at 30 s
+#define SPARKLINE_MIN_SPACING 5000      // Closer samples for the same pair are ignored (ms)
+
+// Ring buffer of recent prices for one pair. Samples are stored as
+// 16-bit deltas from the first price, shifted right as far as needed
+// to fit, so each one costs two bytes whatever the coin's price.
+class SparklineBuffer {
+private:
+    int64_t base = 0;           // Mantissa of the first sample at `scale`
+    uint8_t scale = 0;
+    uint8_t shift = 0;          // Stored delta = (mantissa - base) >> shift
+    uint8_t head = 0;           // Next slot to write
+    uint8_t count = 0;
+    int16_t deltas[SPARKLINE_CAPACITY];
+    unsigned long lastSample = 0;
+    uint16_t version = 0;       // Bumped on every sample
+    uint16_t shiftVersion = 0;  // Bumped when all deltas were requantized
+
+public:
+    bool add(const Price& price, unsigned long now) {
+        if (count > 0 && now - lastSample < SPARKLINE_MIN_SPACING) return false;
+
+        if (count == 0) {
+            base = price.mantissa;
+            scale = price.scale;
+            shift = 0;
+        }
+
+        int64_t delta = (price.rescaled(scale) - base) >> shift;
+        while (delta > INT16_MAX || delta < INT16_MIN) {
+            requantize();
+            delta >>= 1;
+        }
+
+        deltas[head] = (int16_t)delta;
+        head = (head + 1) % SPARKLINE_CAPACITY;
+        if (count < SPARKLINE_CAPACITY) count++;
+        lastSample = now;
+        version++;
+        return true;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    // Sample i, 0 being the oldest
+    int16_t at(int i) const {
+        return deltas[(head + SPARKLINE_CAPACITY - count + i) % SPARKLINE_CAPACITY];
+    }
+
+    uint16_t getVersion() const {
+        return version;
+    }
+
+    uint16_t getShiftVersion() const {
+        return shiftVersion;
+    }
+
+private:
+    void requantize() {
+        shift++;
+        shiftVersion++;
+        for (int i = 0; i < SPARKLINE_CAPACITY; i++) {
+            deltas[i] >>= 1;
+        }
+    }
+};
+
+// One buffer per crypto/fiat pair, sized at compile time
+template <int NUM_CRYPTOS, int NUM_FIATS>
+class SparklineStore {
+private:
+    SparklineBuffer buffers[NUM_CRYPTOS][NUM_FIATS];
+
+public:
+    SparklineBuffer* get(int crypto, int fiat) {
+        if (crypto < 0 || crypto >= NUM_CRYPTOS || fiat < 0 || fiat >= NUM_FIATS) return nullptr;
+        return &buffers[crypto][fiat];
+    }
+
+    static constexpr size_t footprint() {
+        return sizeof(SparklineBuffer) * NUM_CRYPTOS * NUM_FIATS;
+    }
+};
+
+// Screen coordinates of a buffer's samples for a given plot height.
+// When a sample arrives inside the current range only that point is
+// computed; the rest is reused from the previous frame.
+class SparklinePlot {
+private:
+    uint8_t ys[SPARKLINE_CAPACITY];
+    int count = 0;
+    int16_t low = 0;
+    int16_t high = 0;
+    uint8_t height = 0;
+
+    const SparklineBuffer* source = nullptr;
+    uint16_t version = 0;
+    uint16_t shiftVersion = 0;
+
+public:
+    void draw(Adafruit_GFX* gfx, const SparklineBuffer* buffer, int16_t x, int16_t y, int16_t w, uint8_t h) {
+        update(buffer, h);
+        if (count < 2) return;
+
+        for (int i = 1; i < count; i++) {
+            int16_t x0 = x + (int32_t)(i - 1) * (w - 1) / (count - 1);
+            int16_t x1 = x + (int32_t)i * (w - 1) / (count - 1);
+            gfx->drawLine(x0, y + ys[i - 1], x1, y + ys[i], WHITE);
+        }
+    }
+
+private:
+    void update(const SparklineBuffer* buffer, uint8_t h) {
+        if (buffer == source && h == height && buffer->getShiftVersion() == shiftVersion) {
+            uint16_t added = buffer->getVersion() - version;
+            if (added == 0) return;
+            if (added == 1 && appendLatest(buffer)) {
+                version = buffer->getVersion();
+                return;
+            }
+        }
+        recompute(buffer, h);
+    }
+
+    // Incremental path, fails if the new point or a dropped one moves the range
+    bool appendLatest(const SparklineBuffer* buffer) {
+        int16_t value = buffer->at(buffer->size() - 1);
+        if (value < low || value > high) return false;
+
+        if (buffer->size() == count) {
+            // Buffer was full and the oldest sample fell out. If it sat on
+            // the edge of the range the range may shrink, so start over.
+            if (ys[0] == 0 || ys[0] == height - 1) return false;
+            memmove(ys, ys + 1, count - 1);
+            ys[count - 1] = toY(value);
+        } else {
+            ys[count++] = toY(value);
+        }
+        return true;
+    }
+
+    void recompute(const SparklineBuffer* buffer, uint8_t h) {
+        source = buffer;
+        height = h;
+        version = buffer->getVersion();
+        shiftVersion = buffer->getShiftVersion();
+        count = buffer->size();
+        if (count == 0) return;
+
+        low = high = buffer->at(0);
+        for (int i = 1; i < count; i++) {
+            int16_t value = buffer->at(i);
+            if (value < low) low = value;
+            if (value > high) high = value;
+        }
+        for (int i = 0; i < count; i++) {
+            ys[i] = toY(buffer->at(i));
+        }
+    }
+
+    uint8_t toY(int16_t value) const {
+        if (high == low) return height / 2;
+        return (uint8_t)((int32_t)(high - value) * (height - 1) / (high - low));
+    }
+};
+
+#endif // SPARKLINE_H
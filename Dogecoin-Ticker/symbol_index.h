@@ -0,0 +1,221 @@
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "LittleFS.h"
+#include "ticker_state.h"
+
+#define SYMBOL_FILE "/symbols.json"
+#define SYMBOL_MAX_CRYPTOS 128
+#define SYMBOL_REFRESH 86400000UL   // Rebuild the index once a day (ms)
+#define SYMBOL_LINE_SIZE 192
+
+// Quote currencies a pair can end in. Longer names that end like a
+// shorter one (GUSD, USDT) come first so they match before it.
+static const char* const SYMBOL_QUOTES[] = {
+    "USDT", "USDC", "GUSD", "USD", "EUR", "GBP", "SGD", "AUD", "CAD", "CHF",
+    "HKD", "JPY", "RUB", "BTC", "ETH", "DAI", "FIL", "BCH", "LTC"
+};
+#define SYMBOL_NUM_QUOTES (sizeof(SYMBOL_QUOTES) / sizeof(SYMBOL_QUOTES[0]))
+
+static_assert(SYMBOL_NUM_QUOTES <= 32, "Quote set must fit a 32-bit mask");
+
+// Crypto -> quote currencies index of every pair in the pricefeed,
+// which is what the device can actually show. It is rebuilt from the
+// records of a regular batch fetch, so it costs no extra request, and
+// stored in LittleFS as the JSON the web page uses:
+//   {"btc":["eur","gbp","usd"],"doge":["usd"],...}
+// The file is only rewritten when its content changes.
+class SymbolIndex {
+private:
+    struct Entry {
+        char crypto[STATE_SYMBOL_SIZE];
+        uint32_t quotes;            // Bit per SYMBOL_QUOTES entry
+    };
+
+    // Only allocated while a fetch is being collected
+    Entry* entries = nullptr;
+    int count = 0;
+    unsigned long skipped = 0;      // Pairs with an unknown quote or long name
+
+    uint32_t fileHash = 0;          // FNV-1a of the stored file, 0 if none
+    char etag[12];
+    bool built = false;
+    unsigned long lastBuild = 0;
+
+public:
+    SymbolIndex() {
+        etag[0] = '\0';
+    }
+
+    // Call after LittleFS is mounted
+    void begin(AsyncWebServer* server) {
+        File file = LittleFS.open(SYMBOL_FILE, "r");
+        if (file) {
+            uint8_t buffer[64];
+            uint32_t hash = 2166136261UL;
+            size_t len;
+            while ((len = file.read(buffer, sizeof(buffer))) > 0) {
+                hash = fnv(hash, buffer, len);
+            }
+            file.close();
+            setHash(hash);
+            built = true;
+            lastBuild = millis();
+        }
+
+        server->on("/symbols", HTTP_GET, std::bind(&SymbolIndex::handleRequest, this, std::placeholders::_1));
+    }
+
+    // Starts collecting the next fetch when the index is missing or old
+    void beginPass() {
+        if (entries != nullptr) return;
+        if (built && millis() - lastBuild < SYMBOL_REFRESH) return;
+        entries = (Entry*)malloc(sizeof(Entry) * SYMBOL_MAX_CRYPTOS);
+        count = 0;
+        skipped = 0;
+    }
+
+    bool isCollecting() const {
+        return entries != nullptr;
+    }
+
+    // One pricefeed pair, e.g. "DOGEUSD"
+    void add(const char* pair) {
+        if (entries == nullptr) return;
+
+        size_t len = strlen(pair);
+        for (size_t q = 0; q < SYMBOL_NUM_QUOTES; q++) {
+            size_t quoteLen = strlen(SYMBOL_QUOTES[q]);
+            if (len <= quoteLen || strcasecmp(pair + len - quoteLen, SYMBOL_QUOTES[q]) != 0) continue;
+            if (len - quoteLen >= STATE_SYMBOL_SIZE) break;
+
+            char crypto[STATE_SYMBOL_SIZE];
+            for (size_t i = 0; i < len - quoteLen; i++) {
+                crypto[i] = tolower(pair[i]);
+            }
+            crypto[len - quoteLen] = '\0';
+
+            Entry* entry = findOrInsert(crypto);
+            if (entry == nullptr) break;
+            entry->quotes |= 1UL << q;
+            return;
+        }
+        skipped++;
+    }
+
+    // Stores what was collected. Call once a feed was read fully; a
+    // fetch that failed part way leaves the pass open for the next one.
+    void endPass() {
+        if (entries == nullptr) return;
+        if (count > 0) {
+            write();
+            built = true;
+            lastBuild = millis();
+        }
+        free(entries);
+        entries = nullptr;
+    }
+
+private:
+    Entry* findOrInsert(const char* crypto) {
+        int low = 0;
+        int high = count;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            int cmp = strcmp(entries[mid].crypto, crypto);
+            if (cmp == 0) return &entries[mid];
+            if (cmp < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (count == SYMBOL_MAX_CRYPTOS) return nullptr;
+
+        memmove(&entries[low + 1], &entries[low], sizeof(Entry) * (count - low));
+        count++;
+        memcpy(entries[low].crypto, crypto, STATE_SYMBOL_SIZE);
+        entries[low].quotes = 0;
+        return &entries[low];
+    }
+
+    // Formats entry i, or the closing brace for i == count
+    size_t formatEntry(int i, char* line) const {
+        if (i == count) {
+            return snprintf(line, SYMBOL_LINE_SIZE, "}");
+        }
+        size_t len = snprintf(line, SYMBOL_LINE_SIZE, "%s\"%s\":[", i == 0 ? "{" : ",", entries[i].crypto);
+        bool first = true;
+        for (size_t q = 0; q < SYMBOL_NUM_QUOTES; q++) {
+            if ((entries[i].quotes & (1UL << q)) == 0) continue;
+            len += snprintf(line + len, SYMBOL_LINE_SIZE - len, "%s\"", first ? "" : ",");
+            for (const char* c = SYMBOL_QUOTES[q]; *c != '\0'; c++) {
+                line[len++] = tolower(*c);
+            }
+            line[len++] = '"';
+            first = false;
+        }
+        line[len++] = ']';
+        line[len] = '\0';
+        return len;
+    }
+
+    void write() {
+        char line[SYMBOL_LINE_SIZE];
+        uint32_t hash = 2166136261UL;
+        for (int i = 0; i <= count; i++) {
+            size_t len = formatEntry(i, line);
+            hash = fnv(hash, (const uint8_t*)line, len);
+        }
+        if (built && hash == fileHash) {
+            Serial.printf("Symbols: %d cryptos, unchanged\n", count);
+            return;
+        }
+
+        File file = LittleFS.open(SYMBOL_FILE, "w");
+        if (!file) {
+            Serial.println("Symbols: could not write " SYMBOL_FILE);
+            return;
+        }
+        size_t total = 0;
+        for (int i = 0; i <= count; i++) {
+            size_t len = formatEntry(i, line);
+            total += file.write((const uint8_t*)line, len);
+        }
+        file.close();
+        setHash(hash);
+        Serial.printf("Symbols: %d cryptos, %lu pairs skipped, %u bytes written\n", count, skipped, (unsigned)total);
+    }
+
+    void setHash(uint32_t hash) {
+        fileHash = hash;
+        snprintf(etag, sizeof(etag), "\"%08x\"", (unsigned)hash);
+    }
+
+    static uint32_t fnv(uint32_t hash, const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            hash = (hash ^ data[i]) * 16777619UL;
+        }
+        return hash;
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) {
+        if (!built) {
+            request->send(503, "application/json", "{\"error\":\"symbols not fetched yet\"}");
+            return;
+        }
+        if (request->hasHeader("If-None-Match") &&
+            strcmp(request->getHeader("If-None-Match")->value().c_str(), etag) == 0) {
+            request->send(304);
+            return;
+        }
+        AsyncWebServerResponse* response = request->beginResponse(LittleFS, SYMBOL_FILE, "application/json");
+        response->addHeader("Cache-Control", "no-cache");
+        response->addHeader("ETag", etag);
+        request->send(response);
+    }
+};
+
+#endif // SYMBOL_INDEX_H
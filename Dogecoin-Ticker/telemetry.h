@@ -0,0 +1,182 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "display_handler.h"
+#include "api_handler.h"
+#include "ws_protocol.h"
+#include "power_scheduler.h"
+
+#define TELEMETRY_BUCKETS 16            // Loop time buckets: <2us, <4us, ... , >=32ms
+#define TELEMETRY_HEAP_INTERVAL 1000    // Heap sampling period (ms)
+#define TELEMETRY_JSON_SIZE 1024
+
+// Parts of loop() that are timed separately
+enum TelemetrySection {
+    SECTION_FETCH,
+    SECTION_DISPLAY,
+    SECTION_WEBSOCKET,
+    SECTION_OTA,
+    SECTION_BUTTON,
+    SECTION_HISTORY,
+    SECTION_LED,
+    SECTION_COUNT
+};
+
+static_assert(WS_LOOP_BUCKETS == TELEMETRY_BUCKETS, "Websocket counter layout out of date");
+static_assert(WS_SECTIONS == SECTION_COUNT, "Websocket counter layout out of date");
+
+// Always-on runtime counters. Recording a sample is a subtraction, a
+// count-leading-zeros and a few adds, so it stays enabled in release
+// builds. Heap is sampled once a second rather than every pass.
+class Telemetry {
+private:
+    unsigned long loopHistogram[TELEMETRY_BUCKETS];
+    unsigned long loopCount = 0;
+    unsigned long loopMax = 0;
+
+    unsigned long sectionTotal[SECTION_COUNT];
+    unsigned long sectionMax[SECTION_COUNT];
+
+    unsigned long lastHeapSample = 0;
+    uint32_t minFreeHeap = UINT32_MAX;
+    uint32_t minMaxBlock = UINT32_MAX;
+
+    const PowerScheduler* power = nullptr;
+
+public:
+    Telemetry() {
+        memset(loopHistogram, 0, sizeof(loopHistogram));
+        memset(sectionTotal, 0, sizeof(sectionTotal));
+        memset(sectionMax, 0, sizeof(sectionMax));
+    }
+
+    // Call once at the end of loop() with the pass duration
+    void recordLoop(unsigned long elapsed) {
+        loopHistogram[bucket(elapsed)]++;
+        loopCount++;
+        if (elapsed > loopMax) loopMax = elapsed;
+
+        if (millis() - lastHeapSample >= TELEMETRY_HEAP_INTERVAL) {
+            sampleHeap();
+        }
+    }
+
+    // Charges the time since `since` to a section and returns now,
+    // so consecutive calls can be chained through loop()
+    unsigned long lap(TelemetrySection section, unsigned long since) {
+        unsigned long now = micros();
+        unsigned long elapsed = now - since;
+        sectionTotal[section] += elapsed;
+        if (elapsed > sectionMax[section]) sectionMax[section] = elapsed;
+        return now;
+    }
+
+    // Adds duty cycle and energy to the JSON
+    void setPowerScheduler(const PowerScheduler* scheduler) {
+        power = scheduler;
+    }
+
+    unsigned long getLoopCount() const {
+        return loopCount;
+    }
+
+    // Compact JSON for the web route and websocket push. Loop buckets are
+    // powers of two in microseconds, section times are [total ms, max us].
+    size_t toJson(char* out, size_t size, const ApiHandler& api) {
+        sampleHeap();
+        size_t len = snprintf(out, size, "{\"telemetry\":{\"uptime\":%lu,\"loops\":%lu,\"loopMax\":%lu,\"loopHist\":[",
+                              millis() / 1000, loopCount, loopMax);
+        for (int i = 0; i < TELEMETRY_BUCKETS && len < size; i++) {
+            len += snprintf(out + len, size - len, i == 0 ? "%lu" : ",%lu", loopHistogram[i]);
+        }
+        if (len < size) {
+            len += snprintf(out + len, size - len, "],\"sections\":{");
+        }
+        for (int i = 0; i < SECTION_COUNT && len < size; i++) {
+            len += snprintf(out + len, size - len, "%s\"%s\":[%lu,%lu]", i == 0 ? "" : ",",
+                            sectionName(i), sectionTotal[i] / 1000, sectionMax[i]);
+        }
+        if (len < size) {
+            len += snprintf(out + len, size - len,
+                            "},\"heap\":{\"free\":%u,\"maxBlock\":%u,\"frag\":%u,\"minFree\":%u,\"minMaxBlock\":%u},"
+                            "\"fetch\":{\"ok\":%lu,\"failed\":%lu,\"timeouts\":%lu},"
+                            "\"tls\":{\"handshakes\":%lu,\"reused\":%lu,\"lastUs\":%lu,\"maxUs\":%lu}",
+                            (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxFreeBlockSize(),
+                            (unsigned)ESP.getHeapFragmentation(), (unsigned)minFreeHeap, (unsigned)minMaxBlock,
+                            api.getSuccessCount(), api.getFailureCount(), api.getTimeoutCount(),
+                            api.getHandshakeCount(), api.getReusedCount(),
+                            api.getLastHandshakeMicros(), api.getMaxHandshakeMicros());
+        }
+        for (int i = 0; i < api.getSourceCount() && len < size; i++) {
+            const SourceStats& source = api.getSourceStats(i);
+            len += snprintf(out + len, size - len,
+                            "%s{\"name\":\"%s\",\"ok\":%lu,\"failed\":%lu,\"outliers\":%lu,\"lastMs\":%lu,\"avgMs\":%lu}",
+                            i == 0 ? ",\"sources\":[" : ",", api.getSourceName(i), source.ok, source.failed,
+                            source.outliers, source.lastMs, source.averageMs);
+        }
+        if (len < size) {
+            len += snprintf(out + len, size - len, "]");
+        }
+        if (len < size && power != nullptr) {
+            const PowerStats& stats = power->getStats();
+            len += snprintf(out + len, size - len, ",\"power\":{\"mode\":\"%s\",\"duty\":%.3f,\"mWhPerHour\":%.1f}",
+                            PowerScheduler::modeName(power->getMode()), stats.getDutyCycle(),
+                            stats.getMilliwattHoursPerHour());
+        }
+        if (len < size) {
+            len += snprintf(out + len, size - len, "}}");
+        }
+        return len < size ? len : size - 1;
+    }
+
+    // Fills the telemetry part of the websocket counter block
+    void fillCounters(uint32_t* values, const ApiHandler& api) {
+        sampleHeap();
+        values[CTR_UPTIME] = millis() / 1000;
+        values[CTR_LOOPS] = loopCount;
+        values[CTR_LOOP_MAX] = loopMax;
+        values[CTR_HEAP_FREE] = ESP.getFreeHeap();
+        values[CTR_HEAP_MAX_BLOCK] = ESP.getMaxFreeBlockSize();
+        values[CTR_HEAP_FRAG] = ESP.getHeapFragmentation();
+        values[CTR_HEAP_MIN_FREE] = minFreeHeap;
+        values[CTR_HEAP_MIN_MAX_BLOCK] = minMaxBlock;
+        values[CTR_FETCH_OK] = api.getSuccessCount();
+        values[CTR_FETCH_FAILED] = api.getFailureCount();
+        values[CTR_FETCH_TIMEOUTS] = api.getTimeoutCount();
+        values[CTR_TLS_HANDSHAKES] = api.getHandshakeCount();
+        values[CTR_TLS_REUSED] = api.getReusedCount();
+        values[CTR_TLS_RECONNECTS] = api.getReconnectCount();
+        values[CTR_TLS_LAST_US] = api.getLastHandshakeMicros();
+        values[CTR_TLS_MAX_US] = api.getMaxHandshakeMicros();
+        for (int i = 0; i < TELEMETRY_BUCKETS; i++) {
+            values[CTR_LOOP_HIST + i] = loopHistogram[i];
+        }
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            values[CTR_SECTION_MS + i] = sectionTotal[i] / 1000;
+            values[CTR_SECTION_MAX + i] = sectionMax[i];
+        }
+    }
+
+private:
+    static int bucket(unsigned long elapsed) {
+        if (elapsed < 2) return 0;
+        int index = 31 - __builtin_clz((uint32_t)elapsed);    // floor(log2)
+        return index < TELEMETRY_BUCKETS ? index : TELEMETRY_BUCKETS - 1;
+    }
+
+    static const char* sectionName(int section) {
+        static const char* const names[SECTION_COUNT] = {"fetch", "display", "websocket", "ota", "button", "history", "led"};
+        return names[section];
+    }
+
+    void sampleHeap() {
+        lastHeapSample = millis();
+        uint32_t freeHeap = ESP.getFreeHeap();
+        uint32_t maxBlock = ESP.getMaxFreeBlockSize();
+        if (freeHeap < minFreeHeap) minFreeHeap = freeHeap;
+        if (maxBlock < minMaxBlock) minMaxBlock = maxBlock;
+    }
+};
+
+#endif // TELEMETRY_H
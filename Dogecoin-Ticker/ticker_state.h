@@ -0,0 +1,124 @@
+#ifndef TICKER_STATE_H
+#define TICKER_STATE_H
+
+#include <Arduino.h>
+
+#define STATE_SYMBOL_SIZE 8         // "DOGE" + room for longer web UI symbols
+#define STATE_MAX_LISTENERS 6
+
+// Bits in the change mask passed to listeners
+#define STATE_CHANGE_PAIR 0x01      // Crypto or fiat
+#define STATE_CHANGE_VIEW 0x02      // Price screen / chart
+#define STATE_CHANGE_SPLASH 0x04    // Boot or coin splash flags
+#define STATE_CHANGE_PREVIEW 0x08   // Coin preview started or ended
+
+// Everything the handlers need to agree on, in a fixed-size block
+struct TickerState {
+    char crypto[STATE_SYMBOL_SIZE];
+    char fiat[STATE_SYMBOL_SIZE];
+    int8_t cryptoIndex = 0;         // Position in the sketch's lists, -1 for
+    int8_t fiatIndex = 0;           // pairs only the web UI knows about
+    bool bootSplash = true;         // Waiting for the first price after boot
+    bool splashActive = true;       // Next fetch shows the coin splash first
+    bool previewMode = false;       // Button is previewing the next coin
+    bool chartView = false;
+    uint16_t version = 0;           // Bumped on every change
+};
+
+typedef void (*StateListener)(const TickerState& state, uint8_t changes);
+
+// Single owner of the ticker state. Setters ignore values that are
+// already current, so repeated requests cause no redraw or fetch.
+// Real changes are collected and delivered to listeners once per
+// loop() pass from publish(), with the mask of what changed.
+class TickerStateStore {
+private:
+    TickerState state;
+    uint8_t pending = 0;
+
+    StateListener listeners[STATE_MAX_LISTENERS];
+    int listenerCount = 0;
+
+public:
+    TickerStateStore(const char* crypto, const char* fiat) {
+        copySymbol(state.crypto, crypto);
+        copySymbol(state.fiat, fiat);
+    }
+
+    const TickerState& get() const {
+        return state;
+    }
+
+    uint16_t getVersion() const {
+        return state.version;
+    }
+
+    // Listeners are called in the order they subscribed
+    bool subscribe(StateListener listener) {
+        if (listenerCount == STATE_MAX_LISTENERS) return false;
+        listeners[listenerCount++] = listener;
+        return true;
+    }
+
+    bool setPair(const char* crypto, const char* fiat, int cryptoIndex, int fiatIndex) {
+        if (strcmp(crypto, state.crypto) == 0 && strcmp(fiat, state.fiat) == 0) return false;
+        copySymbol(state.crypto, crypto);
+        copySymbol(state.fiat, fiat);
+        state.cryptoIndex = cryptoIndex;
+        state.fiatIndex = fiatIndex;
+        changed(STATE_CHANGE_PAIR);
+        return true;
+    }
+
+    bool setChartView(bool chartView) {
+        if (state.chartView == chartView) return false;
+        state.chartView = chartView;
+        changed(STATE_CHANGE_VIEW);
+        return true;
+    }
+
+    bool setPreviewMode(bool previewMode) {
+        if (state.previewMode == previewMode) return false;
+        state.previewMode = previewMode;
+        changed(STATE_CHANGE_PREVIEW);
+        return true;
+    }
+
+    bool setBootSplash(bool bootSplash) {
+        if (state.bootSplash == bootSplash) return false;
+        state.bootSplash = bootSplash;
+        changed(STATE_CHANGE_SPLASH);
+        return true;
+    }
+
+    bool setSplashActive(bool splashActive) {
+        if (state.splashActive == splashActive) return false;
+        state.splashActive = splashActive;
+        changed(STATE_CHANGE_SPLASH);
+        return true;
+    }
+
+    // Delivers the changes made since the last call. Call from loop().
+    void publish() {
+        if (pending == 0) return;
+        uint8_t changes = pending;
+        pending = 0;
+        for (int i = 0; i < listenerCount; i++) {
+            listeners[i](state, changes);
+        }
+    }
+
+private:
+    void changed(uint8_t change) {
+        pending |= change;
+        state.version++;
+    }
+
+    // A change of one half passes the other half's own buffer back in
+    static void copySymbol(char* out, const char* symbol) {
+        if (out == symbol) return;
+        snprintf(out, STATE_SYMBOL_SIZE, "%s", symbol);
+    }
+};
+
+#endif // TICKER_STATE_H
@@ -4,24 +4,78 @@
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
-#include <Arduino_JSON.h>
+#include "ticker_state.h"
+#include "ws_protocol.h"
 
-extern bool isSplashActive;
+#define WS_MAX_CLIENTS 4            // Connections beyond this are refused
+#define WS_CLIENT_QUEUE 3           // Frames a client may have in its socket queue
+#define WS_CLIENT_INTERVAL 250      // Minimum time between sends to one client (ms)
+#define WS_CLIENT_STALL 15000       // Client closed after being backed up this long (ms)
+#define WS_JSON_SIZE 192
+#define WS_STATS_JSON_SIZE 320
+#define WS_TELEMETRY_JSON_SIZE 1024
 
+// Messages a client can have waiting, at most one of each. A newer
+// message of the same kind replaces the waiting one.
+#define WS_PENDING_STATE 0x01
+#define WS_PENDING_PRICE 0x02
+#define WS_PENDING_STATS 0x04       // Counters, or the stats JSON for JSON clients
+#define WS_PENDING_TELEMETRY 0x08   // JSON clients only
+
+// Connected client, the protocol it asked for and what it still has to get
+struct WsClientSlot {
+    uint32_t id;
+    bool used;
+    bool binary;
+    uint8_t pending;            // WS_PENDING_* bits
+    uint64_t dirtyCounters;     // Counters changed since this client last got them
+    unsigned long lastSend;
+    unsigned long stalledSince; // 0 while the client keeps up
+};
+
+// Serves the binary protocol in ws_protocol.h to clients that ask for it
+// and the original JSON messages to everyone else. Updates are not sent
+// when they happen: each client has one pending slot per message kind,
+// and handle() sends what is waiting, no more often than
+// WS_CLIENT_INTERVAL and only while the client's socket queue is short.
+// A client that falls behind gets the latest value of each kind instead
+// of a growing backlog, and one that stays backed up is disconnected.
 class WebSocketHandler {
 private:
     AsyncWebSocket ws;
-    String currentCrypto;
-    String currentCurrency;
-    unsigned long* previousFetch;
+    const TickerStateStore* ticker = nullptr;
+    void (*onStateChange)(const String& crypto, const String& currency) = nullptr;
+
+    WsClientSlot clients[WS_MAX_CLIENTS];
+    int binaryClients = 0;
+    int jsonClients = 0;
+
+    // Latest value of everything, the pending slots refer to these
+    uint32_t lastCounters[CTR_COUNT];
+    Price lastPrice;
+    float lastChange = 0;
+    int16_t lastChangeBp = 0;
+    bool lastStale = false;
+    uint16_t lastPriceVersion = 0;
+    bool priceSent = false;
+    char statsJson[WS_STATS_JSON_SIZE];
+    char telemetryJson[WS_TELEMETRY_JSON_SIZE];
+
+    unsigned long coalesced = 0;    // Messages replaced by a newer one before sending
+    unsigned long dropped = 0;      // Messages thrown away with a stalled client
+    unsigned long refused = 0;      // Connections over WS_MAX_CLIENTS
+    int maxQueued = 0;
 
 public:
-    WebSocketHandler(const char* wsPath = "/ws") : ws(wsPath) {}
+    WebSocketHandler(const char* wsPath = "/ws") : ws(wsPath) {
+        memset(clients, 0, sizeof(clients));
+        memset(lastCounters, 0, sizeof(lastCounters));
+        statsJson[0] = '\0';
+        telemetryJson[0] = '\0';
+    }
 
-    void begin(AsyncWebServer* server, String& crypto, String& currency, unsigned long& prevFetch) {
-        currentCrypto = crypto;
-        currentCurrency = currency;
-        previousFetch = &prevFetch;
+    void begin(AsyncWebServer* server, const TickerStateStore* tickerState) {
+        ticker = tickerState;
         
         ws.onEvent(std::bind(&WebSocketHandler::handleWebSocketEvent, this,
             std::placeholders::_1, std::placeholders::_2,
@@ -31,20 +85,181 @@ public:
         server->addHandler(&ws);
     }
 
-    void cleanupClients() {
+    // Called when a web client selects a new crypto/currency pair. Clients
+    // are told about the change by the state listener, not from here.
+    void setStateCallback(void (*callback)(const String& crypto, const String& currency)) {
+        onStateChange = callback;
+    }
+
+    // Sends what clients have waiting. Call from every loop() pass.
+    void handle() {
         ws.cleanupClients();
+        unsigned long now = millis();
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            WsClientSlot& slot = clients[i];
+            if (!slot.used || slot.pending == 0) continue;
+            if (now - slot.lastSend < WS_CLIENT_INTERVAL) continue;
+
+            AsyncWebSocketClient* client = ws.client(slot.id);
+            if (client == nullptr) continue;
+            if (client->queueLen() >= WS_CLIENT_QUEUE) {
+                if (slot.stalledSince == 0) {
+                    slot.stalledSince = now;
+                } else if (now - slot.stalledSince >= WS_CLIENT_STALL) {
+                    Serial.printf("WebSocket client #%u stalled, closing\n", slot.id);
+                    dropped += countPending(slot);
+                    slot.pending = 0;
+                    client->close();
+                }
+                continue;
+            }
+            slot.stalledSince = 0;
+            slot.lastSend = now;
+            flush(slot, client);
+        }
+    }
+
+    bool hasClients() const {
+        return binaryClients + jsonClients > 0;
+    }
+
+    bool hasBinaryClients() const {
+        return binaryClients > 0;
+    }
+
+    bool hasJsonClients() const {
+        return jsonClients > 0;
     }
 
-    void notifyClients(const String& state) {
-        ws.textAll(state);
+    // Current pair to every client
+    void sendState() {
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].used) queue(clients[i], WS_PENDING_STATE);
+        }
     }
 
-    String getCurrentStates() {
-        JSONVar jsonData;
-        jsonData["states"][0]["sender"] = "esp8266";
-        jsonData["states"][0]["currentCurrency"] = currentCurrency;
-        jsonData["states"][0]["currentCrypto"] = currentCrypto;
-        return JSON.stringify(jsonData);
+    // Shown price to every client, skipped when nothing changed
+    void sendPrice(const Price& price, float change, bool stale) {
+        int16_t changeBp = (int16_t)constrain(lroundf(change * 10000.0f), INT16_MIN, INT16_MAX);
+        uint16_t version = ticker->get().version;
+        if (priceSent && price == lastPrice && changeBp == lastChangeBp && stale == lastStale &&
+            version == lastPriceVersion) {
+            return;
+        }
+        lastPrice = price;
+        lastChange = change;
+        lastChangeBp = changeBp;
+        lastStale = stale;
+        lastPriceVersion = version;
+        priceSent = true;
+
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].used) queue(clients[i], WS_PENDING_PRICE);
+        }
+    }
+
+    // Counters to binary clients, each gets the ones that changed since
+    // it was last sent counters
+    void sendCounters(const uint32_t* values) {
+        uint64_t changed = WsProtocol::changedCounters(values, lastCounters);
+        if (changed == 0) return;
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            WsClientSlot& slot = clients[i];
+            if (!slot.used || !slot.binary) continue;
+            slot.dirtyCounters |= changed;
+            queue(slot, WS_PENDING_STATS);
+        }
+    }
+
+    // API and cache stats JSON from formatStats, to JSON clients
+    void sendStatsJson(const char* json) {
+        snprintf(statsJson, sizeof(statsJson), "%s", json);
+        queueJson(WS_PENDING_STATS);
+    }
+
+    // Telemetry document, to JSON clients
+    void sendTelemetryJson(const char* json) {
+        snprintf(telemetryJson, sizeof(telemetryJson), "%s", json);
+        queueJson(WS_PENDING_TELEMETRY);
+    }
+
+    // Fills the websocket part of the counter block
+    void fillCounters(uint32_t* values) {
+        values[CTR_WS_CLIENTS] = binaryClients + jsonClients;
+        values[CTR_WS_QUEUED] = getQueued();
+        values[CTR_WS_MAX_QUEUED] = maxQueued;
+        values[CTR_WS_COALESCED] = coalesced;
+        values[CTR_WS_DROPPED] = dropped;
+        values[CTR_WS_REFUSED] = refused;
+    }
+
+    // Messages waiting over all clients
+    int getQueued() const {
+        int queued = 0;
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].used) queued += countPending(clients[i]);
+        }
+        return queued;
+    }
+
+    int getMaxQueued() const { return maxQueued; }
+    unsigned long getCoalescedCount() const { return coalesced; }
+    unsigned long getDroppedCount() const { return dropped; }
+    unsigned long getRefusedCount() const { return refused; }
+
+    size_t formatStates(char* out, size_t size) {
+        return snprintf(out, size,
+                        "{\"states\":[{\"sender\":\"esp8266\",\"currentCurrency\":\"%s\",\"currentCrypto\":\"%s\"}]}",
+                        ticker->get().fiat, ticker->get().crypto);
+    }
+
+    size_t formatPrice(char* out, size_t size) {
+        char value[24];
+        lastPrice.format(value, sizeof(value), PRICE_MAX_SCALE, sizeof(value) - 1);
+        return snprintf(out, size, "{\"price\":{\"version\":%u,\"value\":\"%s\",\"change\":%.4f,\"stale\":%s}}",
+                        lastPriceVersion, value, lastChange, lastStale ? "true" : "false");
+    }
+
+    // API connection, price cache and websocket stats in one message
+    size_t formatStats(char* out, size_t size, unsigned long handshakes, unsigned long reused,
+                       unsigned long reconnects, unsigned long hits, unsigned long misses,
+                       const unsigned long* ageCounts, const char* (*ageLabel)(int), int numBuckets) {
+        size_t len = snprintf(out, size,
+                              "{\"apiStats\":{\"handshakes\":%lu,\"reused\":%lu,\"reconnects\":%lu},"
+                              "\"cacheStats\":{\"hits\":%lu,\"misses\":%lu,\"ages\":{",
+                              handshakes, reused, reconnects, hits, misses);
+        for (int i = 0; i < numBuckets && len < size; i++) {
+            len += snprintf(out + len, size - len, "%s\"%s\":%lu", i == 0 ? "" : ",", ageLabel(i), ageCounts[i]);
+        }
+        if (len < size) {
+            len += snprintf(out + len, size - len,
+                            "}},\"wsStats\":{\"clients\":%d,\"queued\":%d,\"maxQueued\":%d,"
+                            "\"coalesced\":%lu,\"dropped\":%lu,\"refused\":%lu}}",
+                            binaryClients + jsonClients, getQueued(), maxQueued, coalesced, dropped, refused);
+        }
+        return len < size ? len : size - 1;
+    }
+
+    // Reads the pair from a client's states message, false if the
+    // message is malformed or was not sent by a client
+    bool parseClientState(const char* message, String& crypto, String& currency) {
+        StaticJsonDocument<192> doc;
+        DeserializationError error = deserializeJson(doc, message);
+
+        if (error) {
+            Serial.print(F("deserializeJson() failed: "));
+            Serial.println(error.f_str());
+            return false;
+        }
+
+        JsonObject states_0 = doc["states"][0];
+        const char* sender = states_0["sender"];
+        if (sender == nullptr || strcmp(sender, "client") != 0) {
+            return false;
+        }
+        currency = states_0["currentCurrency"].as<const char*>();
+        crypto = states_0["currentCrypto"].as<const char*>();
+        return true;
     }
 
 private:
@@ -53,14 +268,20 @@ private:
         switch (type) {
             case WS_EVT_CONNECT:
                 Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
+                if (!addClient(client->id())) {
+                    Serial.printf("WebSocket client #%u refused, %d clients connected\n", client->id(), WS_MAX_CLIENTS);
+                    refused++;
+                    client->close();
+                }
                 break;
                 
             case WS_EVT_DISCONNECT:
                 Serial.printf("WebSocket client #%u disconnected\n", client->id());
+                removeClient(client->id());
                 break;
                 
             case WS_EVT_DATA:
-                handleWebSocketMessage(arg, data, len);
+                handleWebSocketMessage(client->id(), arg, data, len);
                 break;
                 
             case WS_EVT_PONG:
@@ -69,41 +290,160 @@ private:
         }
     }
 
-    void handleWebSocketMessage(void* arg, uint8_t* data, size_t len) {
+    void handleWebSocketMessage(uint32_t id, void* arg, uint8_t* data, size_t len) {
         AwsFrameInfo* info = (AwsFrameInfo*)arg;
-        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
-            Serial.print("Received Websocket Message: ");
-            Serial.print((char*)data);
-            Serial.print("\n");
+        if (!info->final || info->index != 0 || info->len != len) return;
 
-            if (strcmp((char*)data, "getCurrentStates") == 0) {
-                notifyClients(getCurrentStates());
-            } else {
-                StaticJsonDocument<192> doc;
-                DeserializationError error = deserializeJson(doc, (char*)data);
+        if (info->opcode == WS_BINARY) {
+            char crypto[STATE_SYMBOL_SIZE];
+            char fiat[STATE_SYMBOL_SIZE];
+            if (WsProtocol::decodeSetPair(data, len, crypto, fiat, sizeof(crypto)) && onStateChange != nullptr) {
+                onStateChange(String(crypto), String(fiat));
+            }
+            return;
+        }
+        if (info->opcode != WS_TEXT) return;
 
-                if (error) {
-                    Serial.print(F("deserializeJson() failed: "));
-                    Serial.println(error.f_str());
-                    return;
-                }
+        Serial.print("Received Websocket Message: ");
+        Serial.print((char*)data);
+        Serial.print("\n");
+
+        WsClientSlot* slot = findClient(id);
+        if (slot == nullptr) return;
 
-                JsonObject states_0 = doc["states"][0];
-                const char* sender = states_0["sender"];
-                String newCurrency = states_0["currentCurrency"];
-                String newCrypto = states_0["currentCrypto"];
-
-                if (strcmp(sender, "client") == 0) {
-                    Serial.println("Received message from client.");
-                    currentCrypto = newCrypto;
-                    currentCurrency = newCurrency;
-                    *previousFetch = 0;
-                    isSplashActive = true;
-                    notifyClients(getCurrentStates());
+        if (isCommand(data, len, WS_HELLO_TEXT)) {
+            startBinary(*slot);
+        } else if (isCommand(data, len, "getCurrentStates")) {
+            queue(*slot, WS_PENDING_STATE);
+        } else {
+            String newCrypto;
+            String newCurrency;
+            if (parseClientState((char*)data, newCrypto, newCurrency)) {
+                Serial.println("Received message from client.");
+                if (onStateChange != nullptr) {
+                    onStateChange(newCrypto, newCurrency);
                 }
             }
         }
     }
+
+    // Text frames are not terminated, script.js sends a trailing NUL
+    static bool isCommand(const uint8_t* data, size_t len, const char* command) {
+        size_t commandLen = strlen(command);
+        if (len == commandLen + 1 && data[commandLen] == '\0') len--;
+        return len == commandLen && memcmp(data, command, len) == 0;
+    }
+
+    // Switches a client to the binary protocol and queues a full snapshot
+    void startBinary(WsClientSlot& slot) {
+        if (!slot.binary) {
+            slot.binary = true;
+            jsonClients--;
+            binaryClients++;
+        }
+
+        AsyncWebSocketClient* client = ws.client(slot.id);
+        if (client != nullptr) {
+            uint8_t frame[2];
+            client->binary((const char*)frame, WsProtocol::encodeHello(frame));
+        }
+        slot.pending = WS_PENDING_STATE | WS_PENDING_STATS | (priceSent ? WS_PENDING_PRICE : 0);
+        slot.dirtyCounters = WS_ALL_COUNTERS;
+    }
+
+    void queue(WsClientSlot& slot, uint8_t kind) {
+        if (slot.pending & kind) {
+            coalesced++;
+            return;
+        }
+        slot.pending |= kind;
+        int queued = getQueued();
+        if (queued > maxQueued) maxQueued = queued;
+    }
+
+    void queueJson(uint8_t kind) {
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].used && !clients[i].binary) queue(clients[i], kind);
+        }
+    }
+
+    static int countPending(const WsClientSlot& slot) {
+        return __builtin_popcount(slot.pending);
+    }
+
+    // Sends waiting messages, state first, while the socket queue has room
+    void flush(WsClientSlot& slot, AsyncWebSocketClient* client) {
+        for (uint8_t kind = WS_PENDING_STATE; kind <= WS_PENDING_TELEMETRY; kind <<= 1) {
+            if ((slot.pending & kind) == 0) continue;
+            if (client->queueLen() >= WS_CLIENT_QUEUE) return;
+            slot.pending &= ~kind;
+            if (slot.binary) {
+                sendBinary(slot, client, kind);
+            } else {
+                sendJson(client, kind);
+            }
+        }
+    }
+
+    void sendBinary(WsClientSlot& slot, AsyncWebSocketClient* client, uint8_t kind) {
+        uint8_t frame[WS_MAX_FRAME];
+        size_t len = 0;
+        if (kind == WS_PENDING_STATE) {
+            len = WsProtocol::encodeState(frame, sizeof(frame), ticker->get());
+        } else if (kind == WS_PENDING_PRICE) {
+            len = WsProtocol::encodePrice(frame, sizeof(frame), lastPriceVersion, lastPrice, lastChangeBp, lastStale);
+        } else if (kind == WS_PENDING_STATS) {
+            len = WsProtocol::encodeCounters(frame, sizeof(frame), lastCounters, slot.dirtyCounters);
+            slot.dirtyCounters = 0;
+        }
+        if (len > 0) {
+            client->binary((const char*)frame, len);
+        }
+    }
+
+    void sendJson(AsyncWebSocketClient* client, uint8_t kind) {
+        if (kind == WS_PENDING_STATE || kind == WS_PENDING_PRICE) {
+            char json[WS_JSON_SIZE];
+            size_t len = kind == WS_PENDING_STATE ? formatStates(json, sizeof(json)) : formatPrice(json, sizeof(json));
+            client->text(json, len);
+        } else {
+            const char* json = kind == WS_PENDING_STATS ? statsJson : telemetryJson;
+            if (json[0] != '\0') client->text(json, strlen(json));
+        }
+    }
+
+    WsClientSlot* findClient(uint32_t id) {
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].used && clients[i].id == id) return &clients[i];
+        }
+        return nullptr;
+    }
+
+    // False when every slot is taken
+    bool addClient(uint32_t id) {
+        for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (!clients[i].used) {
+                memset(&clients[i], 0, sizeof(clients[i]));
+                clients[i].id = id;
+                clients[i].used = true;
+                clients[i].pending = priceSent ? WS_PENDING_PRICE : 0;
+                jsonClients++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removeClient(uint32_t id) {
+        WsClientSlot* slot = findClient(id);
+        if (slot == nullptr) return;
+        slot->used = false;
+        if (slot->binary) {
+            binaryClients--;
+        } else {
+            jsonClients--;
+        }
+    }
 };
 
-#endif // WEBSOCKET_HANDLER_H 
\ No newline at end of file
+#endif // WEBSOCKET_HANDLER_H
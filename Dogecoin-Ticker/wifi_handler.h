@@ -4,52 +4,104 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
 #include <ArduinoOTA.h>
+#include "boot_store.h"
 
+#define WIFI_FAST_TIMEOUT 3000          // Direct join to the cached access point (ms)
+#define WIFI_SCAN_TIMEOUT 10000         // Join after a full scan (ms)
+#define WIFI_PROGRESS_INTERVAL 500      // Connecting screen update period (ms)
+
+enum WiFiPhase {
+    WIFI_IDLE,
+    WIFI_FAST,          // Joining the cached BSSID and channel, no scan
+    WIFI_SCAN,          // Scanning for the SSID like a first boot
+    WIFI_CONNECTED,
+    WIFI_FAILED
+};
+
+// Joins the network without blocking loop(). With a boot record it goes
+// straight to the last access point and channel, still taking its
+// address from DHCP since a lease may have run out or been handed on
+// while the device was down. If that fails it falls back to a normal
+// scan. The progress and IP screens are only drawn on the scan
+// path, where nothing else is on the display yet.
 class WiFiHandler {
 private:
     const char* ssid;
     const char* password;
     DisplayHandler* display;
     LedHandler* led;
+    BootStore* boot;
+
+    WiFiPhase phase = WIFI_IDLE;
+    unsigned long phaseStart = 0;
+    unsigned long lastProgress = 0;
+    unsigned long connectedAt = 0;     // millis() when the link came up
+    bool fastJoin = false;             // Connected without a scan
 
 public:
-    WiFiHandler(const char* wifi_ssid, const char* wifi_password, DisplayHandler* disp, LedHandler* ledHandler) 
-        : ssid(wifi_ssid), password(wifi_password), display(disp), led(ledHandler) {}
+    WiFiHandler(const char* wifi_ssid, const char* wifi_password, DisplayHandler* disp, LedHandler* ledHandler,
+                BootStore* bootStore)
+        : ssid(wifi_ssid), password(wifi_password), display(disp), led(ledHandler), boot(bootStore) {}
 
-    bool begin() {
+    void begin() {
+        // Credentials are compiled in, so the SDK needn't write them to flash each boot
+        WiFi.persistent(false);
         WiFi.mode(WIFI_STA);
-        WiFi.begin(ssid, password);
         Serial.print("Connecting to WiFi ..");
 
-        int attempts = 0;
-        const int maxAttempts = 20;  // 20 * 500ms = 10 seconds timeout
+        if (boot->has(BOOT_HAS_WIFI)) {
+            const BootRecord& record = boot->get();
+            WiFi.begin(ssid, password, record.channel, record.bssid);
+            enter(WIFI_FAST);
+        } else {
+            startScan();
+        }
+    }
 
-        while (WiFi.status() != WL_CONNECTED && attempts < maxAttempts) {
-            Serial.print('.');
-            display->showWiFiConnecting(attempts + 1, maxAttempts);
-            delay(500);
-            attempts++;
+    // Call from loop(). Returns true on the pass the link comes up.
+    bool handle() {
+        if (phase != WIFI_FAST && phase != WIFI_SCAN) return false;
+
+        if (WiFi.status() == WL_CONNECTED) {
+            onConnected();
+            return true;
         }
 
-        if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("\nWiFi Connection Failed!");
-            display->showWiFiError(ssid);
-            
-            // Visual error indication
-            for (int i = 0; i < 3; i++) {
-                led->flashNeg(2);
-                delay(500);
+        unsigned long elapsed = millis() - phaseStart;
+        if (phase == WIFI_FAST) {
+            if (elapsed >= WIFI_FAST_TIMEOUT) {
+                Serial.print(" cached access point not reachable, scanning ..");
+                WiFi.disconnect();
+                startScan();
             }
-            
             return false;
         }
 
-        Serial.println(WiFi.localIP());
-        display->showWiFiSuccess(WiFi.localIP());
-        led->flashPos(2);  // Success indication
-        delay(5000);  // Show connection info for 5 seconds
-        
-        return true;
+        if (elapsed >= WIFI_SCAN_TIMEOUT) {
+            onFailed();
+        } else if (millis() - lastProgress >= WIFI_PROGRESS_INTERVAL) {
+            lastProgress = millis();
+            Serial.print('.');
+            int maxAttempts = WIFI_SCAN_TIMEOUT / WIFI_PROGRESS_INTERVAL;
+            display->showWiFiConnecting(elapsed / WIFI_PROGRESS_INTERVAL + 1, maxAttempts);
+        }
+        return false;
+    }
+
+    bool isConnected() const {
+        return phase == WIFI_CONNECTED;
+    }
+
+    bool hasFailed() const {
+        return phase == WIFI_FAILED;
+    }
+
+    bool wasFastJoin() const {
+        return fastJoin;
+    }
+
+    unsigned long getConnectedAt() const {
+        return connectedAt;
     }
 
     void setupOTA(const char* hostname = "DogeTickler") {
@@ -89,6 +141,47 @@ public:
     void handleOTA() {
         ArduinoOTA.handle();
     }
+
+private:
+    void enter(WiFiPhase next) {
+        phase = next;
+        phaseStart = millis();
+    }
+
+    void startScan() {
+        WiFi.begin(ssid, password);
+        enter(WIFI_SCAN);
+        lastProgress = 0;
+    }
+
+    void onConnected() {
+        fastJoin = phase == WIFI_FAST;
+        enter(WIFI_CONNECTED);
+        connectedAt = millis();
+        Serial.printf(" %s in %lu ms\n", fastJoin ? "joined" : "connected", connectedAt);
+        Serial.println(WiFi.localIP());
+
+        boot->saveWiFi(WiFi.BSSID(), WiFi.channel());
+        if (!fastJoin) {
+            // New network, show where the web page is until the first price
+            display->showWiFiSuccess(WiFi.localIP());
+        }
+        led->flashPos(2);  // Success indication
+    }
+
+    void onFailed() {
+        enter(WIFI_FAILED);
+        Serial.println("\nWiFi Connection Failed!");
+        display->showWiFiError(ssid);
+
+        // Visual error indication
+        for (int i = 0; i < 3; i++) {
+            led->flashNeg(2);
+            led->pause(500);
+        }
+        // Restart once it has played, the loop keeps running meanwhile
+        led->whenDone([]() { ESP.restart(); });
+    }
 };
 
 #endif // WIFI_HANDLER_H 
\ No newline at end of file
@@ -0,0 +1,173 @@
+#ifndef WS_PROTOCOL_H
+#define WS_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "price.h"
+#include "ticker_state.h"
+
+// Binary websocket protocol, little-endian. A client opts in by sending
+// the text frame "proto:1" after connecting; clients that never do keep
+// getting the JSON messages.
+//
+// Device to client:
+//   HELLO    0x00 version:u8
+//   STATE    0x01 stateVersion:u16 flags:u8 cryptoLen:u8 crypto fiatLen:u8 fiat
+//   PRICE    0x02 stateVersion:u16 mantissa:i64 scale:u8 changeBp:i16 stale:u8
+//   COUNTERS 0x03 count:u8 { id:u8 value:u32 } * count, changed counters only
+// Client to device:
+//   SET_PAIR 0x10 cryptoLen:u8 crypto fiatLen:u8 fiat
+#define WS_PROTOCOL_VERSION 1
+#define WS_HELLO_TEXT "proto:1"
+
+#define WS_MSG_HELLO 0x00
+#define WS_MSG_STATE 0x01
+#define WS_MSG_PRICE 0x02
+#define WS_MSG_COUNTERS 0x03
+#define WS_MSG_SET_PAIR 0x10
+
+#define WS_STATE_FLAG_CHART 0x01
+
+#define WS_AGE_BUCKETS 5            // Matches PRICE_AGE_BUCKETS
+#define WS_LOOP_BUCKETS 16          // Matches TELEMETRY_BUCKETS
+#define WS_SECTIONS 7               // Matches SECTION_COUNT
+
+// Counter ids, shared with script.js
+enum WsCounter {
+    CTR_UPTIME,
+    CTR_LOOPS,
+    CTR_LOOP_MAX,
+    CTR_HEAP_FREE,
+    CTR_HEAP_MAX_BLOCK,
+    CTR_HEAP_FRAG,
+    CTR_HEAP_MIN_FREE,
+    CTR_HEAP_MIN_MAX_BLOCK,
+    CTR_FETCH_OK,
+    CTR_FETCH_FAILED,
+    CTR_FETCH_TIMEOUTS,
+    CTR_TLS_HANDSHAKES,
+    CTR_TLS_REUSED,
+    CTR_TLS_RECONNECTS,
+    CTR_TLS_LAST_US,
+    CTR_TLS_MAX_US,
+    CTR_CACHE_HITS,
+    CTR_CACHE_MISSES,
+    CTR_CACHE_AGE,                                      // WS_AGE_BUCKETS entries
+    CTR_LOOP_HIST = CTR_CACHE_AGE + WS_AGE_BUCKETS,     // WS_LOOP_BUCKETS entries
+    CTR_SECTION_MS = CTR_LOOP_HIST + WS_LOOP_BUCKETS,   // WS_SECTIONS entries, total ms
+    CTR_SECTION_MAX = CTR_SECTION_MS + WS_SECTIONS,     // WS_SECTIONS entries, worst us
+    CTR_WS_CLIENTS = CTR_SECTION_MAX + WS_SECTIONS,
+    CTR_WS_QUEUED,
+    CTR_WS_MAX_QUEUED,
+    CTR_WS_COALESCED,
+    CTR_WS_DROPPED,
+    CTR_WS_REFUSED,
+    CTR_COUNT
+};
+
+static_assert(CTR_COUNT <= 64, "Counter ids must fit a 64-bit change mask");
+
+#define WS_MAX_FRAME (2 + 5 * CTR_COUNT)
+#define WS_ALL_COUNTERS (CTR_COUNT == 64 ? ~0ULL : (1ULL << CTR_COUNT) - 1)
+
+// Fixed-layout encoders and decoders, no heap and no JSON
+class WsProtocol {
+public:
+    static size_t encodeHello(uint8_t* out) {
+        out[0] = WS_MSG_HELLO;
+        out[1] = WS_PROTOCOL_VERSION;
+        return 2;
+    }
+
+    static size_t encodeState(uint8_t* out, size_t size, const TickerState& state) {
+        size_t cryptoLen = strlen(state.crypto);
+        size_t fiatLen = strlen(state.fiat);
+        if (size < 6 + cryptoLen + fiatLen) return 0;
+
+        size_t pos = 0;
+        out[pos++] = WS_MSG_STATE;
+        pos += putU16(out + pos, state.version);
+        out[pos++] = state.chartView ? WS_STATE_FLAG_CHART : 0;
+        out[pos++] = cryptoLen;
+        memcpy(out + pos, state.crypto, cryptoLen);
+        pos += cryptoLen;
+        out[pos++] = fiatLen;
+        memcpy(out + pos, state.fiat, fiatLen);
+        return pos + fiatLen;
+    }
+
+    static size_t encodePrice(uint8_t* out, size_t size, uint16_t stateVersion,
+                              const Price& price, int16_t changeBp, bool stale) {
+        if (size < 15) return 0;
+        size_t pos = 0;
+        out[pos++] = WS_MSG_PRICE;
+        pos += putU16(out + pos, stateVersion);
+        for (int i = 0; i < 8; i++) {
+            out[pos++] = (uint8_t)((uint64_t)price.mantissa >> (8 * i));
+        }
+        out[pos++] = price.scale;
+        pos += putU16(out + pos, (uint16_t)changeBp);
+        out[pos++] = stale ? 1 : 0;
+        return pos;
+    }
+
+    // Mask of the counters that differ from lastSent, which is then
+    // updated to values
+    static uint64_t changedCounters(const uint32_t* values, uint32_t* lastSent) {
+        uint64_t mask = 0;
+        for (int id = 0; id < CTR_COUNT; id++) {
+            if (values[id] == lastSent[id]) continue;
+            lastSent[id] = values[id];
+            mask |= 1ULL << id;
+        }
+        return mask;
+    }
+
+    // The counters in mask. Returns 0 when the mask is empty.
+    static size_t encodeCounters(uint8_t* out, size_t size, const uint32_t* values, uint64_t mask) {
+        if (size < WS_MAX_FRAME) return 0;
+        size_t pos = 2;
+        uint8_t count = 0;
+        for (int id = 0; id < CTR_COUNT; id++) {
+            if ((mask & (1ULL << id)) == 0) continue;
+            out[pos++] = id;
+            pos += putU32(out + pos, values[id]);
+            count++;
+        }
+        if (count == 0) return 0;
+        out[0] = WS_MSG_COUNTERS;
+        out[1] = count;
+        return pos;
+    }
+
+    static bool decodeSetPair(const uint8_t* data, size_t len, char* crypto, char* fiat, size_t symbolSize) {
+        if (len < 3 || data[0] != WS_MSG_SET_PAIR) return false;
+        size_t cryptoLen = data[1];
+        if (cryptoLen == 0 || cryptoLen >= symbolSize || 2 + cryptoLen >= len) return false;
+        size_t fiatLen = data[2 + cryptoLen];
+        if (fiatLen == 0 || fiatLen >= symbolSize || 3 + cryptoLen + fiatLen != len) return false;
+
+        memcpy(crypto, data + 2, cryptoLen);
+        crypto[cryptoLen] = '\0';
+        memcpy(fiat, data + 3 + cryptoLen, fiatLen);
+        fiat[fiatLen] = '\0';
+        return true;
+    }
+
+private:
+    static size_t putU16(uint8_t* out, uint16_t value) {
+        out[0] = value & 0xFF;
+        out[1] = value >> 8;
+        return 2;
+    }
+
+    static size_t putU32(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out[i] = (uint8_t)(value >> (8 * i));
+        }
+        return 4;
+    }
+};
+
+#endif // WS_PROTOCOL_H
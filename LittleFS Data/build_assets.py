@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Builds the LittleFS image contents from data/ into build/data/.
+
+- Text assets are gzipped; the device serves the .gz with
+  Content-Encoding: gzip.
+- Assets index.html links to get a content hash in their name and move
+  to /assets/, which the device serves as immutable.
+- index.html keeps its name and is revalidated through the ETag written
+  to /index.etag.
+- /build.manifest holds an ETag from the content hash of the whole
+  build, then the path of every other file it shipped. The device sends
+  that ETag with those files, so they are revalidated too.
+- Folders such as logos/ (see make_logo.py) are copied unchanged.
+
+Upload build/data instead of data. Only the Python standard library is
+needed.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SOURCE = os.path.join(ROOT, "data")
+OUTPUT = os.path.join(ROOT, "build", "data")
+
+TEXT_TYPES = (".html", ".js", ".css", ".json", ".svg", ".txt")
+INDEX = "index.html"
+INDEX_ETAG = "index.etag"
+MANIFEST = "build.manifest"
+ASSET_DIR = "assets"
+HASH_LENGTH = 10
+
+
+def compress(data):
+    # mtime=0 keeps the output, and so the hashes, reproducible
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def hashed_name(name, data):
+    digest = hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+    stem, ext = os.path.splitext(name)
+    return "%s.%s%s" % (stem, digest, ext)
+
+
+def manifest():
+    """Build ETag and the paths the device serves the files under, the
+    index and the hashed assets left out since they have their own"""
+    digest = hashlib.sha256()
+    paths = []
+    for folder, dirs, files in os.walk(OUTPUT):
+        dirs.sort()
+        for file in sorted(files):
+            path = os.path.join(folder, file)
+            name = os.path.relpath(path, OUTPUT).replace(os.sep, "/")
+            with open(path, "rb") as f:
+                digest.update(name.encode("utf-8") + b"\0" + f.read())
+            if name in (INDEX + ".gz", INDEX_ETAG) or name.startswith(ASSET_DIR + "/"):
+                continue
+            paths.append("/" + (name[:-3] if name.endswith(".gz") else name))
+    etag = '"%s"' % digest.hexdigest()[:16]
+    return etag, paths
+
+
+def write(path, data):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def main():
+    if os.path.exists(OUTPUT):
+        shutil.rmtree(OUTPUT)
+
+    with open(os.path.join(SOURCE, INDEX), "rb") as f:
+        index = f.read().decode("utf-8")
+
+    sizes = []
+    for name in sorted(os.listdir(SOURCE)):
+        path = os.path.join(SOURCE, name)
+        if name == INDEX or name.startswith("."):
+            continue
+        if os.path.isdir(path):
+            shutil.copytree(path, os.path.join(OUTPUT, name))
+            for file in sorted(os.listdir(path)):
+                size = os.path.getsize(os.path.join(path, file))
+                sizes.append((name + "/" + file, size, size))
+            continue
+        if not os.path.isfile(path):
+            continue
+        with open(path, "rb") as f:
+            data = f.read()
+
+        # Local references like src="./script.js" or href="style.css"
+        reference = re.compile(r'((?:src|href)=")(?:\./)?' + re.escape(name) + '"')
+        target = name
+        if reference.search(index):
+            target = ASSET_DIR + "/" + hashed_name(name, data)
+            index = reference.sub(lambda m: m.group(1) + target + '"', index)
+
+        if name.endswith(TEXT_TYPES):
+            packed = compress(data)
+            write(os.path.join(OUTPUT, target + ".gz"), packed)
+        else:
+            packed = data
+            write(os.path.join(OUTPUT, target), packed)
+        sizes.append((target, len(data), len(packed)))
+
+    index_data = index.encode("utf-8")
+    index_packed = compress(index_data)
+    write(os.path.join(OUTPUT, INDEX + ".gz"), index_packed)
+    etag = '"%s"' % hashlib.sha256(index_packed).hexdigest()[:16]
+    write(os.path.join(OUTPUT, INDEX_ETAG), etag.encode("ascii"))
+    sizes.insert(0, (INDEX, len(index_data), len(index_packed)))
+
+    build_etag, paths = manifest()
+    write(os.path.join(OUTPUT, MANIFEST), "\n".join([build_etag] + paths).encode("utf-8") + b"\n")
+
+    total_raw = sum(raw for _, raw, _ in sizes)
+    total_packed = sum(packed for _, _, packed in sizes)
+    for name, raw, packed in sizes:
+        print("%-32s %8d -> %7d bytes" % (name, raw, packed))
+    print("%-32s %8d -> %7d bytes (%d%%)" % ("total", total_raw, total_packed,
+                                             100 * total_packed // max(total_raw, 1)))
+    print("index ETag %s, build ETag %s for %d more files, upload %s" %
+          (etag, build_etag, len(paths), os.path.relpath(OUTPUT, os.getcwd())))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
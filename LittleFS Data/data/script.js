@@ -12,6 +12,26 @@ var connected = false;
 var firstConnect = true;
 var optChanged = false;
 
+// Binary protocol, see ws_protocol.h in the sketch
+const WS_HELLO_TEXT = "proto:1";
+const WS_MSG_HELLO = 0x00;
+const WS_MSG_STATE = 0x01;
+const WS_MSG_PRICE = 0x02;
+const WS_MSG_COUNTERS = 0x03;
+const WS_MSG_SET_PAIR = 0x10;
+
+// Counter ids, same order as enum WsCounter
+const CTR_UPTIME = 0, CTR_LOOPS = 1, CTR_LOOP_MAX = 2, CTR_HEAP_FREE = 3, CTR_HEAP_MAX_BLOCK = 4,
+    CTR_HEAP_FRAG = 5, CTR_HEAP_MIN_FREE = 6, CTR_HEAP_MIN_MAX_BLOCK = 7, CTR_FETCH_OK = 8,
+    CTR_FETCH_FAILED = 9, CTR_FETCH_TIMEOUTS = 10, CTR_TLS_HANDSHAKES = 11, CTR_TLS_REUSED = 12,
+    CTR_TLS_RECONNECTS = 13, CTR_TLS_LAST_US = 14, CTR_TLS_MAX_US = 15, CTR_CACHE_HITS = 16,
+    CTR_CACHE_MISSES = 17, CTR_CACHE_AGE = 18, CTR_WS_CLIENTS = 53, CTR_WS_QUEUED = 54,
+    CTR_WS_MAX_QUEUED = 55, CTR_WS_COALESCED = 56, CTR_WS_DROPPED = 57, CTR_WS_REFUSED = 58;
+const AGE_LABELS = ["<30s", "<1m", "<2m", "<5m", ">5m"];
+
+var binaryMode = false;             // Device answered our hello
+var counters = [];                  // Latest value of every counter, updated by deltas
+
 const cryptoDictionary = [];
 
 function onLoad(event) {
@@ -34,6 +54,7 @@ function setUpApp() {
     $('#saveChangesButton').attr('disabled', 'disabled');
 
     parseSymbols(); // Fetch our data from API and parse JSON response
+    loadPolling();
 
     // If we have the data, start our websocket connection to ESP8266
     if (cryptoDictionary != null) {
@@ -49,7 +70,9 @@ function initWebSocket() {
     $('#saveChangesButton').removeClass("btn-primary btn-danger").addClass("btn-warning");
     $('#saveChangesButton').html("Connecting...")
 
+    binaryMode = false;
     websocket = new WebSocket(gateway);
+    websocket.binaryType = 'arraybuffer';
     websocket.onopen = onOpen;
     websocket.onclose = onClose;
     websocket.onmessage = onMessage;
@@ -60,7 +83,9 @@ function onOpen(event) {
     connected = true;
     console.log('WebSocket Open');
 
-    websocket.send("getCurrentStates\0");
+    // Ask for the binary protocol, the device answers with its hello and
+    // the current state, price and counters
+    websocket.send(WS_HELLO_TEXT + "\0");
 
     $('#saveChangesButton').removeClass("btn-warning btn-danger").addClass("btn-success");
     $('#saveChangesButton').html("Save Changes");
@@ -78,10 +103,39 @@ function onClose(event) {
 
 function onMessage(event) {
 
+    if (event.data instanceof ArrayBuffer) {
+        onBinaryMessage(new DataView(event.data));
+        return;
+    }
+
+    // JSON queued for us before the device saw our hello
+    if (binaryMode) return;
+
     var jsonData = JSON.parse(event.data);
 
     console.log("===============================\nJSON Message: " + JSON.stringify(jsonData));
 
+    if (jsonData.cacheStats) {
+        showCacheStats(jsonData.cacheStats);
+    }
+
+    if (jsonData.price) {
+        showPrice(jsonData.price.value, jsonData.price.change * 100, jsonData.price.stale);
+    }
+
+    if (jsonData.wsStats) {
+        showStreamStats(jsonData.wsStats);
+    }
+
+    if (jsonData.telemetry) {
+        showTelemetry(jsonData.telemetry);
+    }
+
+    if (jsonData.apiStats) {
+        console.log("API Connection: " + jsonData.apiStats.handshakes + " handshakes, " +
+            jsonData.apiStats.reused + " reused, " + jsonData.apiStats.reconnects + " reconnects");
+    }
+
     for (i in jsonData.states) {
 
         var sender = jsonData.states[i].sender;
@@ -91,25 +145,151 @@ function onMessage(event) {
         console.log("Sender: " + sender);
 
         if (sender == "esp8266") {
+            showState(activeCrypto, activeTarget);
+        }
+    }
+    console.log(event.data);
+}
+
+function showState(activeCrypto, activeTarget) {
+
+    if (cryptoDictionary == null) {
+
+        parseSymbols(activeCrypto, activeTarget);
 
-            if (cryptoDictionary == null) {
+    } else {
+
+        cCrypto = activeCrypto;
+        console.log("Current Crypto: " + activeCrypto);
+        $('#active-crypto').html(activeCrypto)
+
+        cCurrency = activeTarget;
+        $('#active-target').html(activeTarget)
+        console.log("Current Currency: " + activeTarget);
 
-                parseSymbols(activeCrypto, activeTarget);
+    }
+}
 
-            } else {
+function onBinaryMessage(view) {
 
-                cCrypto = activeCrypto;
-                console.log("Current Crypto: " + activeCrypto);
-                $('#active-crypto').html(activeCrypto)
+    switch (view.getUint8(0)) {
 
-                cCurrency = activeTarget;
-                $('#active-target').html(activeTarget)
-                console.log("Current Currency: " + activeTarget);
+        case WS_MSG_HELLO:
+            binaryMode = true;
+            console.log("Binary protocol v" + view.getUint8(1));
+            break;
 
+        case WS_MSG_STATE: {
+            var pos = 4;
+            var crypto = readSymbol(view, pos);
+            pos += 1 + crypto.length;
+            var target = readSymbol(view, pos);
+            showState(crypto, target);
+            break;
+        }
+
+        case WS_MSG_PRICE: {
+            var mantissa = view.getBigInt64(3, true);
+            var scale = view.getUint8(11);
+            var change = view.getInt16(12, true) / 100;
+            var stale = view.getUint8(14) != 0;
+            showPrice(formatPrice(mantissa, scale), change, stale);
+            break;
+        }
+
+        case WS_MSG_COUNTERS: {
+            var count = view.getUint8(1);
+            for (var i = 0; i < count; i++) {
+                var offset = 2 + i * 5;
+                counters[view.getUint8(offset)] = view.getUint32(offset + 1, true);
             }
+            showCounters();
+            break;
         }
     }
-    console.log(event.data);
+}
+
+// Decimal string of mantissa / 10^scale from the mantissa's own digits,
+// a Number would round mantissas past 2^53
+function formatPrice(mantissa, scale) {
+    var negative = mantissa < 0n;
+    var digits = (negative ? -mantissa : mantissa).toString().padStart(scale + 1, "0");
+    var split = digits.length - scale;
+    return (negative ? "-" : "") + digits.slice(0, split) + (scale > 0 ? "." + digits.slice(split) : "");
+}
+
+// Length-prefixed ASCII symbol
+function readSymbol(view, pos) {
+    var len = view.getUint8(pos);
+    var symbol = "";
+    for (var i = 0; i < len; i++) {
+        symbol += String.fromCharCode(view.getUint8(pos + 1 + i));
+    }
+    return symbol;
+}
+
+// Builds the same objects the JSON messages carry and shows them
+function showCounters() {
+
+    var ages = {};
+    for (var i = 0; i < AGE_LABELS.length; i++) {
+        ages[AGE_LABELS[i]] = counters[CTR_CACHE_AGE + i] || 0;
+    }
+    showCacheStats({ hits: counters[CTR_CACHE_HITS] || 0, misses: counters[CTR_CACHE_MISSES] || 0, ages: ages });
+
+    showStreamStats({
+        clients: counters[CTR_WS_CLIENTS] || 0, queued: counters[CTR_WS_QUEUED] || 0,
+        maxQueued: counters[CTR_WS_MAX_QUEUED] || 0, coalesced: counters[CTR_WS_COALESCED] || 0,
+        dropped: counters[CTR_WS_DROPPED] || 0, refused: counters[CTR_WS_REFUSED] || 0
+    });
+
+    showTelemetry({
+        loopMax: counters[CTR_LOOP_MAX],
+        heap: { free: counters[CTR_HEAP_FREE], maxBlock: counters[CTR_HEAP_MAX_BLOCK], frag: counters[CTR_HEAP_FRAG] },
+        fetch: { ok: counters[CTR_FETCH_OK], failed: counters[CTR_FETCH_FAILED], timeouts: counters[CTR_FETCH_TIMEOUTS] },
+        tls: { lastUs: counters[CTR_TLS_LAST_US] }
+    });
+}
+
+// Price cache hit/miss counts and the age of the prices that were hit
+function showCacheStats(stats) {
+
+    var total = stats.hits + stats.misses;
+    var hitRate = total > 0 ? Math.round(stats.hits * 100 / total) : 0;
+
+    var ages = [];
+    for (var label in stats.ages) {
+        ages.push(label + ": " + stats.ages[label]);
+    }
+
+    $('#cache-stats').html("Price cache: " + stats.hits + " hits, " + stats.misses + " misses (" + hitRate + "%) | Ages " + ages.join(", "));
+}
+
+// Price shown on the device, change in percent
+function showPrice(value, change, stale) {
+
+    var sign = change >= 0 ? "+" : "";
+    $('#live-price').html(cCrypto + "/" + cCurrency + " " + value + " (" + sign + change.toFixed(2) + "%)" + (stale ? " - stale" : ""));
+    $('#live-price').toggleClass("text-success", change >= 0 && !stale).toggleClass("text-danger", change < 0 && !stale);
+}
+
+// Websocket send queues on the device
+function showStreamStats(stats) {
+
+    $('#ws-stats').html("Web clients: " + stats.clients + " | Queued " + stats.queued + " (max " + stats.maxQueued +
+        "), " + stats.coalesced + " coalesced, " + stats.dropped + " dropped, " + stats.refused + " refused");
+}
+
+function showTelemetry(t) {
+
+    $('#telemetry-stats').html("Loop max " + t.loopMax + " us | Heap " + t.heap.free + " free, " +
+        t.heap.maxBlock + " max block, " + t.heap.frag + "% fragmented | Fetches " + t.fetch.ok + " ok, " +
+        t.fetch.failed + " failed, " + t.fetch.timeouts + " timeouts | TLS handshake " +
+        Math.round(t.tls.lastUs / 1000) + " ms" +
+        (t.power ? " | Power " + t.power.mode + ", " + (t.power.duty * 100).toFixed(1) + "% duty, " +
+            t.power.mWhPerHour + " mWh/h" : "") +
+        (t.sources ? " | Sources " + t.sources.map(s => s.name + " " + s.ok + " ok, " + s.failed + " failed, " +
+            s.outliers + " outliers, " + s.avgMs + " ms").join("; ") : ""));
 }
 
 function updateSelectList(element) {
@@ -141,8 +321,20 @@ function saveChanges() {
     console.log("Saving Changes!");
     console.log("New Crypto", targetCrypto, "will be shown in", targetCurrency)
 
-    // Build our JSON to send to ESP8266
-    var x = ('{"states":[{"sender":"client","currentCurrency":' + '"' + targetCurrency + '","currentCrypto": "' + targetCrypto + '"}]}\0');
+    var x;
+    if (binaryMode) {
+        // SET_PAIR: type, then each symbol with its length
+        x = new Uint8Array(3 + targetCrypto.length + targetCurrency.length);
+        var pos = 0;
+        x[pos++] = WS_MSG_SET_PAIR;
+        x[pos++] = targetCrypto.length;
+        for (var i = 0; i < targetCrypto.length; i++) x[pos++] = targetCrypto.charCodeAt(i);
+        x[pos++] = targetCurrency.length;
+        for (var i = 0; i < targetCurrency.length; i++) x[pos++] = targetCurrency.charCodeAt(i);
+    } else {
+        // Build our JSON to send to ESP8266
+        x = ('{"states":[{"sender":"client","currentCurrency":' + '"' + targetCurrency + '","currentCrypto": "' + targetCrypto + '"}]}\0');
+    }
 
     optChanged = false;
 
@@ -154,74 +346,76 @@ function saveChanges() {
 
 }
 
-async function getSupportedSymbols() {
-
-    let endpoint = 'https://api.sandbox.gemini.com/v1/symbols';
+// Fetch interval bounds, in seconds on the form and in ms from the device
+async function loadPolling(options) {
 
     try {
 
-        let result = await fetch(endpoint);
-        return await result.json();
+        let result = await fetch('/polling', options);
+        if (!result.ok) return;
+        let p = await result.json();
+
+        $('#poll-min').val(p.min / 1000);
+        $('#poll-max').val(p.max / 1000);
+        $('#poll-stats').html("Next fetch in " + Math.round(p.interval / 1000) + " s (" + p.reason + ")" +
+            (p.rate >= 0 ? " | Moving " + (p.rate * 100).toFixed(3) + "%/min" : ""));
 
     } catch (error) {
-        console.log("Fetch Symbols Error: ", error);
+        console.log("Fetch Polling Error: ", error);
     }
 }
 
-async function parseSymbols(curCrypto, curTarget) {
-
-    // Symbols sample: {"btcusd","ethusd","shibbtc","dogeeth", ... }
-
-    // Set() with filters for target currencies | eg. if "btcusd" => find the usd
-    //const targetCurrencies = new Set(["usd", "btc", "eth", "fil", "sgd", "gbp"]);
-    var targetCurrencies = ["usd", "btc", "eth", "fil", "sgd", "gbp", "eur", "dai", "bch", "ltc"]
-
-    // Sets our Symbols variable once we receive the data from the API
-    let symbols = await getSupportedSymbols();
+function savePolling() {
 
-    /* 
-    // Takes the cryptopairs from our API data and strips the currency from the end
-    // to give us our cryptocoin symbol. Then takes each cryptocoin and gets the
-    // stripped currency and puts it into an array and adds it to dictionary
-    // so we can show the available conversions in the select lists
-    */
-
-    const p = crypto => {
-
-        const foundCryptos = targetCurrencies.find(str => crypto.endsWith(str));
-        const cryptos = !foundCryptos ? crypto : crypto.slice(0, -foundCryptos.length);
+    let body = new URLSearchParams({ min: $('#poll-min').val(), max: $('#poll-max').val() });
+    loadPolling({ method: 'POST', body: body });
+}
 
-        const foundCurrencies = symbols.find(str => crypto.startsWith(cryptos));
-        const currencies = !foundCurrencies ? crypto : crypto.slice(0, foundCryptos.length);
+async function getSupportedSymbols() {
 
-        if (cryptos in cryptoDictionary) {
+    // Built by the device from the pairs it can fetch: {"btc":["eur","usd"],...}
+    let endpoint = '/symbols';
 
-            cryptoDictionary[cryptos].add(foundCryptos);
+    try {
 
-        } else {
+        let result = await fetch(endpoint);
+        if (!result.ok) return null;
+        return await result.json();
 
-            cryptoDictionary[cryptos] = new Set([foundCryptos]);
+    } catch (error) {
+        console.log("Fetch Symbols Error: ", error);
+    }
+    return null;
+}
 
-        }
+async function parseSymbols(curCrypto, curTarget) {
 
-        //console.log(cryptoDictionary);
+    let symbols = await getSupportedSymbols();
 
-        return cryptos;
+    // The device builds the index with its first price fetch after boot
+    if (symbols == null) {
+        setTimeout(function () { parseSymbols(curCrypto, curTarget); }, 5000);
+        return;
     }
 
-    // Maps the Symbols and puts them in a Set
-    compiledCryptos = new Set(symbols.map(p));
+    // The device sends the cryptos sorted, each with its quote currencies
+    var targetSet = new Set();
+    for (var crypto in symbols) {
+        cryptoDictionary[crypto] = new Set(symbols[crypto]);
+        symbols[crypto].forEach(target => targetSet.add(target));
+    }
 
-    // Creates an array from the Set and sort it
-    sortedSymbols = Array.from(compiledCryptos).sort();
+    compiledCryptos = new Set(Object.keys(symbols));
+    sortedSymbols = Array.from(compiledCryptos);
+    var targetCurrencies = Array.from(targetSet).sort();
 
     // Creates cryptocoin selectlist option for each symbol in our Array
     if (curCrypto == null) updateCryptos(sortedSymbols, true);
     else updateCryptos(sortedSymbols, false);
 
     // Creates convert-to selectlist option for each symbol in our targetCurrencies array
-    if (curTarget == null) updateCurrencies(targetCurrencies.sort(), true);
-    else updateCurrencies(targetCurrencies.sort(), false);
+    if (curTarget == null) updateCurrencies(targetCurrencies, true);
+    else updateCurrencies(targetCurrencies, false);
 
     console.log("Data Parsed:", cryptoDictionary);
 }
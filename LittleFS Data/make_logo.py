@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Converts a 128x32 1-bit image to the run-length coded logo format.
+
+The output is in SSD1306 page order, which the device decodes straight
+into its framebuffer (see logo_rle.h):
+- One byte holds 8 vertical pixels of one column, and the 128 columns
+  of page 0 (rows 0-7) come first.
+- A control byte c < 0x80 is followed by c + 1 literal bytes.
+- A control byte c >= 0x80 repeats the next byte (c & 0x7f) + 2 times.
+
+Input:
+- a PBM file (P1 or P4)
+- or a 512-byte row-major array from a C header, as drawBitmap() takes
+  it: --array NAME header.h
+
+Output:
+- default: an .rle file with the "RLE1" magic. Copy it to data/logos/
+  named after the coin in lower case, e.g. data/logos/shib.rle, and the
+  device shows it for that coin without a firmware rebuild.
+- --c NAME: a constexpr array for bitmaps.h.
+"""
+
+import argparse
+import re
+import sys
+
+WIDTH = 128
+HEIGHT = 32
+ROW_BYTES = WIDTH // 8
+MAGIC = b"RLE1"
+MAX_LITERAL = 128
+MAX_RUN = 129
+
+
+def read_pbm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    # Header tokens, skipping comments
+    tokens = []
+    pos = 0
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos].decode("ascii"))
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+    if (width, height) != (WIDTH, HEIGHT):
+        sys.exit("image must be %dx%d, got %dx%d" % (WIDTH, HEIGHT, width, height))
+
+    if magic == "P4":
+        return bytes(data[pos + 1:pos + 1 + ROW_BYTES * HEIGHT])
+    if magic == "P1":
+        bits = [c for c in data[pos:].decode("ascii") if c in "01"]
+        rows = bytearray()
+        for i in range(0, len(bits), 8):
+            rows.append(int("".join(bits[i:i + 8]), 2))
+        return bytes(rows)
+    sys.exit("unsupported PBM type %s" % magic)
+
+
+def read_array(path, name):
+    with open(path) as f:
+        text = f.read()
+    match = re.search(re.escape(name) + r"\s*\[\s*\]\s*[^=]*=\s*\{([^}]*)\}", text)
+    if match is None:
+        sys.exit("array %s not found in %s" % (name, path))
+    values = [int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]+", match.group(1))]
+    return bytes(values[:ROW_BYTES * HEIGHT])
+
+
+def to_pages(rows):
+    """Row-major, MSB leftmost -> SSD1306 pages, LSB topmost."""
+    pages = bytearray(WIDTH * HEIGHT // 8)
+    for y in range(HEIGHT):
+        for x in range(WIDTH):
+            if rows[y * ROW_BYTES + x // 8] & (0x80 >> (x % 8)):
+                pages[(y // 8) * WIDTH + x] |= 1 << (y % 8)
+    return bytes(pages)
+
+
+def encode(data):
+    out = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_LITERAL]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:MAX_LITERAL]
+
+    pos = 0
+    while pos < len(data):
+        run = 1
+        while pos + run < len(data) and data[pos + run] == data[pos] and run < MAX_RUN:
+            run += 1
+        if run >= 2:
+            flush_literal()
+            out.append(0x80 | (run - 2))
+            out.append(data[pos])
+            pos += run
+        else:
+            literal.append(data[pos])
+            pos += 1
+    flush_literal()
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="PBM image, or C header with --array")
+    parser.add_argument("--array", help="name of a row-major logo array in the input header")
+    parser.add_argument("--c", metavar="NAME", help="print a C array instead of writing a file")
+    parser.add_argument("-o", "--output", help="output .rle file")
+    args = parser.parse_args()
+
+    rows = read_array(args.input, args.array) if args.array else read_pbm(args.input)
+    if len(rows) != ROW_BYTES * HEIGHT:
+        sys.exit("expected %d bytes of image data, got %d" % (ROW_BYTES * HEIGHT, len(rows)))
+    packed = encode(to_pages(rows))
+
+    if args.c:
+        print("constexpr unsigned char %s[] PROGMEM = {" % args.c)
+        lines = [", ".join("0x%02x" % b for b in packed[i:i + 16]) for i in range(0, len(packed), 16)]
+        print(",\n".join("\t" + line for line in lines))
+        print("};")
+    else:
+        if not args.output:
+            sys.exit("give -o file.rle or --c NAME")
+        with open(args.output, "wb") as f:
+            f.write(MAGIC + packed)
+    print("%d -> %d bytes" % (len(rows), len(packed)), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,42 @@
+#ifndef HOST_ALLOC_COUNTER_H
+#define HOST_ALLOC_COUNTER_H
+
+// Counts heap allocations by replacing the global operator new. Include
+// in one translation unit per test executable.
+
+#include <stdlib.h>
+#include <new>
+
+inline unsigned long& allocationCount() {
+    static unsigned long count = 0;
+    return count;
+}
+
+void* operator new(size_t size) {
+    allocationCount()++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+#endif // HOST_ALLOC_COUNTER_H
@@ -0,0 +1,60 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+// Timing for the host benches. A case runs BENCH_SAMPLES batches of
+// `batch` runs and prints one JSON line with per-run percentiles in
+// nanoseconds, heap allocations per run and the bytes the last run
+// produced, like `bench` on the device prints in microseconds. Brings
+// in alloc_counter.h, so include it in one translation unit per test
+// executable.
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include "alloc_counter.h"
+
+#define BENCH_SAMPLES 200
+
+struct BenchStats {
+    double p50;             // ns per run
+    double p90;
+    double p99;
+    double max;
+    double allocations;     // Per run
+    size_t bytes;
+};
+
+// body(run) does one run and returns the size of what it produced
+template <typename Body>
+BenchStats benchRun(const char* name, int batch, Body body) {
+    double samples[BENCH_SAMPLES];
+    size_t bytes = body(0);     // Warm up caches and lazily built state
+
+    int run = 1;
+    unsigned long before = allocationCount();
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < batch; i++) bytes = body(run++);
+        samples[s] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / batch;
+    }
+    unsigned long allocations = allocationCount() - before;
+
+    std::sort(samples, samples + BENCH_SAMPLES);
+    auto percentile = [&](int p) {
+        int index = (BENCH_SAMPLES * p + 99) / 100 - 1;
+        return samples[index < 0 ? 0 : index];
+    };
+    BenchStats stats;
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    stats.max = samples[BENCH_SAMPLES - 1];
+    stats.allocations = (double)allocations / (BENCH_SAMPLES * batch);
+    stats.bytes = bytes;
+    printf("{\"bench\":\"%s\",\"runs\":%d,\"p50_ns\":%.0f,\"p90_ns\":%.0f,\"p99_ns\":%.0f,\"max_ns\":%.0f,"
+           "\"allocs_per_run\":%.2f,\"bytes\":%zu}\n",
+           name, BENCH_SAMPLES * batch, stats.p50, stats.p90, stats.p99, stats.max, stats.allocations, stats.bytes);
+    return stats;
+}
+
+#endif // HOST_BENCH_H
@@ -0,0 +1,95 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Just enough of a test runner for the host checks: TEST() registers a
+// case, CHECK() records a failure and carries on, and HOST_TEST_MAIN()
+// runs every case and sets the exit status for ctest.
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct HostTestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<HostTestCase>& hostTests() {
+    static std::vector<HostTestCase> tests;
+    return tests;
+}
+
+inline int& hostFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct HostTestRegistrar {
+    HostTestRegistrar(const char* name, void (*run)()) {
+        hostTests().push_back(HostTestCase{name, run});
+    }
+};
+
+// Canned response from host/responses, CRLF line ends kept
+inline std::string loadResponse(const char* name) {
+    std::string path = std::string(HOST_RESPONSES_DIR) + "/" + name;
+    std::string text;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        printf("  missing response %s\n", path.c_str());
+        hostFailures()++;
+        return text;
+    }
+    char buffer[256];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, len);
+    fclose(file);
+    return text;
+}
+
+#define TEST(name)                                              \
+    static void name();                                         \
+    static HostTestRegistrar name##Registrar(#name, name);      \
+    static void name()
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);   \
+            hostFailures()++;                                                   \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+    do {                                                                        \
+        long long checkA = (long long)(a), checkB = (long long)(b);             \
+        if (checkA != checkB) {                                                 \
+            printf("  %s:%d: %s == %s failed, %lld != %lld\n", __FILE__,        \
+                   __LINE__, #a, #b, checkA, checkB);                           \
+            hostFailures()++;                                                   \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_STR(a, b)                                                         \
+    do {                                                                        \
+        const char *checkA = (a), *checkB = (b);                                \
+        if (strcmp(checkA, checkB) != 0) {                                      \
+            printf("  %s:%d: %s == %s failed, \"%s\" != \"%s\"\n", __FILE__,    \
+                   __LINE__, #a, #b, checkA, checkB);                           \
+            hostFailures()++;                                                   \
+        }                                                                       \
+    } while (0)
+
+#define HOST_TEST_MAIN()                                                        \
+    int main() {                                                                \
+        for (const HostTestCase& test : hostTests()) {                          \
+            int before = hostFailures();                                        \
+            test.run();                                                         \
+            printf("%s %s\n", hostFailures() == before ? "ok  " : "FAIL",       \
+                   test.name);                                                  \
+        }                                                                       \
+        return hostFailures() == 0 ? 0 : 1;                                     \
+    }
+
+#endif // HOST_TEST_H
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Estimated page load of the web UI from the device, before and after
+the asset build. Nothing is fetched: the request count and bytes come
+from the files build_assets.py writes and the headers the device sends,
+and the times from a model of the ESP8266's network below, not from a
+measurement. A board on the bench is the way to time a real load.
+
+Before: the plain data/ folder through serveStatic, uncompressed and
+without cache headers, so every visit downloads every file again.
+After: build_assets.py output. The index is gzipped with an ETag, so a
+repeat visit costs one 304. The content-hashed assets are cached as
+immutable, so a repeat visit doesn't request them at all.
+
+Only files on the device count; CDN links are the same either way.
+Exits non-zero if the build stops paying off, so it runs under ctest.
+"""
+
+import gzip
+import importlib.util
+import os
+import re
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+ASSETS = os.path.join(ROOT, "LittleFS Data")
+
+# ESPAsyncWebServer over lwIP with the default 536-byte MSS and two
+# segments in flight, over a Wi-Fi LAN
+RTT_MS = 8.0                # Request to first byte, network only
+SERVE_MS = 12.0             # LittleFS open and response setup per request
+THROUGHPUT = 60000.0        # Body bytes per second the device sustains
+HEADERS_200 = 180           # Response header bytes, with or without caching headers
+HEADERS_304 = 120
+
+
+def load_build_assets():
+    spec = importlib.util.spec_from_file_location("build_assets", os.path.join(ASSETS, "build_assets.py"))
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def local_references(index, names):
+    """Files index.html loads from the device, in page order"""
+    found = []
+    for match in re.finditer(r'(?:src|href)="(?:\./)?([^"]+)"', index):
+        name = match.group(1)
+        if name in names and name not in found:
+            found.append(name)
+    return found
+
+
+def request_ms(body_bytes, header_bytes):
+    return RTT_MS + SERVE_MS + (body_bytes + header_bytes) * 1000.0 / THROUGHPUT
+
+
+class Visit:
+    def __init__(self):
+        self.requests = 0
+        self.bytes = 0
+        self.ms = 0.0
+
+    # Browsers fetch the page, then its scripts one after another on
+    # the device's few connections, so the times add up
+    def fetch(self, body_bytes, header_bytes=HEADERS_200):
+        self.requests += 1
+        self.bytes += body_bytes + header_bytes
+        self.ms += request_ms(body_bytes, header_bytes)
+
+
+def before(source):
+    index_path = os.path.join(source, "index.html")
+    with open(index_path, encoding="utf-8") as f:
+        index = f.read()
+    names = set(os.listdir(source))
+
+    visit = Visit()
+    visit.fetch(os.path.getsize(index_path))
+    for name in local_references(index, names):
+        visit.fetch(os.path.getsize(os.path.join(source, name)))
+    return visit, visit
+
+
+def after(output):
+    index_gz = os.path.join(output, "index.html.gz")
+    with gzip.open(index_gz, "rt", encoding="utf-8") as f:
+        index = f.read()
+
+    first = Visit()
+    first.fetch(os.path.getsize(index_gz))
+    for name in re.findall(r'(?:src|href)="(assets/[^"]+)"', index):
+        first.fetch(os.path.getsize(os.path.join(output, name + ".gz")))
+
+    repeat = Visit()
+    repeat.fetch(0, HEADERS_304)
+    return first, repeat
+
+
+def report(label, visit):
+    print("%-16s %2d requests %8d bytes %7.0f ms" % (label, visit.requests, visit.bytes, visit.ms))
+
+
+def main():
+    build_assets = load_build_assets()
+    with tempfile.TemporaryDirectory() as temp:
+        build_assets.OUTPUT = os.path.join(temp, "data")
+        devnull = open(os.devnull, "w")
+        stdout, sys.stdout = sys.stdout, devnull
+        try:
+            build_assets.main()
+        finally:
+            sys.stdout = stdout
+            devnull.close()
+
+        old_first, old_repeat = before(build_assets.SOURCE)
+        new_first, new_repeat = after(build_assets.OUTPUT)
+
+    report("before, first", old_first)
+    report("before, repeat", old_repeat)
+    report("after, first", new_first)
+    report("after, repeat", new_repeat)
+
+    ok = True
+    if new_first.bytes * 2 > old_first.bytes:
+        print("gzip saves less than half of the first visit")
+        ok = False
+    if new_repeat.requests != 1 or new_repeat.bytes > HEADERS_304:
+        print("a repeat visit should be a single 304")
+        ok = False
+    if new_repeat.ms * 10 > old_repeat.ms:
+        print("a repeat visit should take under a tenth of the time")
+        ok = False
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,191 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+// Drawing primitives of Adafruit_GFX over drawPixel(). Text keeps the
+// library's cursor and layout rules: the built-in font is 6x8 cells
+// from the top-left, a GFXfont draws from the baseline. Glyph bitmaps
+// are not carried over; each character draws a pattern of its own, so
+// different text still sets different pixels, in the right place.
+
+#include "Arduino.h"
+
+// Metrics only, see Fonts/
+struct GFXfont {
+    const uint8_t* bitmap;
+    const void* glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+};
+
+class Adafruit_GFX : public Print {
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 0xFFFF;
+    uint16_t textbgcolor = 0xFFFF;
+    uint8_t textsize = 1;
+    bool wrap = true;
+    const GFXfont* gfxFont = nullptr;
+
+public:
+    using Print::write;
+
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+        for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+    }
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+    }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t i = 0; i < w; i++) drawFastVLine(x + i, y, h, color);
+    }
+
+    void fillScreen(uint16_t color) {
+        fillRect(0, 0, _width, _height, color);
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        drawFastHLine(x, y, w, color);
+        drawFastHLine(x, y + h - 1, w, color);
+        drawFastVLine(x, y, h, color);
+        drawFastVLine(x + w - 1, y, h, color);
+    }
+
+    // Bresenham, like the library
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+        bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if (steep) {
+            std::swap(x0, y0);
+            std::swap(x1, y1);
+        }
+        if (x0 > x1) {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+        int16_t dx = x1 - x0;
+        int16_t dy = abs(y1 - y0);
+        int16_t err = dx / 2;
+        int16_t ystep = y0 < y1 ? 1 : -1;
+        for (; x0 <= x1; x0++) {
+            if (steep) drawPixel(y0, x0, color);
+            else drawPixel(x0, y0, color);
+            err -= dy;
+            if (err < 0) {
+                y0 += ystep;
+                err += dx;
+            }
+        }
+    }
+
+    // Row-major, most significant bit first, rows padded to whole bytes
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) {
+        int16_t byteWidth = (w + 7) / 8;
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                if (bitmap[j * byteWidth + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+            }
+        }
+    }
+
+    void setCursor(int16_t x, int16_t y) {
+        cursor_x = x;
+        cursor_y = y;
+    }
+
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    // Same color for both draws transparent text, like the library
+    void setTextColor(uint16_t color) {
+        textcolor = textbgcolor = color;
+    }
+
+    void setTextColor(uint16_t color, uint16_t background) {
+        textcolor = color;
+        textbgcolor = background;
+    }
+
+    void setTextSize(uint8_t size) {
+        textsize = size > 0 ? size : 1;
+    }
+
+    void setTextWrap(bool on) {
+        wrap = on;
+    }
+
+    void setFont(const GFXfont* font = nullptr) {
+        gfxFont = font;
+    }
+
+    size_t write(uint8_t c) override {
+        if (c == '\r') return 1;
+        if (c == '\n') {
+            cursor_x = 0;
+            cursor_y += lineHeight();
+            return 1;
+        }
+        int16_t advance = charWidth();
+        if (wrap && cursor_x + advance > _width) {
+            cursor_x = 0;
+            cursor_y += lineHeight();
+        }
+        drawChar(cursor_x, cursor_y, c);
+        cursor_x += advance;
+        return 1;
+    }
+
+    void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        size_t len = strlen(text);
+        *x1 = x;
+        *y1 = gfxFont != nullptr ? y - ascent() : y;
+        *w = len * charWidth();
+        *h = gfxFont != nullptr ? ascent() : 8 * textsize;
+    }
+
+    void getTextBounds(const String& text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        getTextBounds(text.c_str(), x, y, x1, y1, w, h);
+    }
+
+private:
+    int16_t charWidth() const {
+        return (gfxFont != nullptr ? gfxFont->yAdvance / 2 : 6) * textsize;
+    }
+
+    int16_t lineHeight() const {
+        return (gfxFont != nullptr ? gfxFont->yAdvance : 8) * textsize;
+    }
+
+    int16_t ascent() const {
+        return gfxFont->yAdvance * 3 / 5 * textsize;
+    }
+
+    // Cell of the character's own pattern, the last column left blank
+    void drawChar(int16_t x, int16_t y, uint8_t c) {
+        int16_t w = charWidth();
+        int16_t h = gfxFont != nullptr ? ascent() : 8 * textsize;
+        int16_t top = gfxFont != nullptr ? y - h : y;
+        bool opaque = textbgcolor != textcolor;
+        for (int16_t i = 0; i < w; i++) {
+            uint32_t column = c == ' ' || i == w - 1 ? 0 : (c * 2654435761u) >> (i % 16);
+            for (int16_t j = 0; j < h; j++) {
+                bool on = j < h - textsize && (column >> (j % 8)) & 1;
+                if (on) drawPixel(x + i, top + j, textcolor);
+                else if (opaque) drawPixel(x + i, top + j, textbgcolor);
+            }
+        }
+    }
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
@@ -0,0 +1,118 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+// Framebuffer-only stand-in for Adafruit_SSD1306. display() sends the
+// whole buffer over the mock bus the way the library does, and
+// Ssd1306Model decodes bus traffic back into controller RAM.
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_GFX.h"
+
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+private:
+    TwoWire* wire;
+    uint8_t address = 0x3C;
+    uint8_t buffer[128 * 64 / 8];
+
+public:
+    Adafruit_SSD1306(int16_t w, int16_t h, TwoWire* twoWire, int8_t) : Adafruit_GFX(w, h), wire(twoWire) {
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    bool begin(uint8_t vcs, uint8_t i2cAddress) {
+        address = i2cAddress;
+        return true;
+    }
+
+    uint8_t* getBuffer() {
+        return buffer;
+    }
+
+    void clearDisplay() {
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+        uint8_t& byte = buffer[x + (y / 8) * _width];
+        if (color == SSD1306_WHITE) byte |= 1 << (y & 7);
+        else if (color == SSD1306_INVERSE) byte ^= 1 << (y & 7);
+        else byte &= ~(1 << (y & 7));
+    }
+
+    void display() {
+        size_t bytes = _width * _height / 8;
+        wire->beginTransmission(address);
+        const uint8_t commands[] = {0x00, SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, (uint8_t)(_width - 1)};
+        wire->write(commands, sizeof(commands));
+        wire->endTransmission();
+        for (size_t sent = 0; sent < bytes;) {
+            size_t chunk = std::min((size_t)BUFFER_LENGTH - 1, bytes - sent);
+            wire->beginTransmission(address);
+            wire->write((uint8_t)0x40);
+            wire->write(buffer + sent, chunk);
+            wire->endTransmission();
+            sent += chunk;
+        }
+    }
+};
+
+// Controller RAM rebuilt from the bus, honouring the column and page
+// address window like the real SSD1306 in horizontal addressing mode
+class Ssd1306Model {
+public:
+    uint8_t ram[128 * 4];
+
+    Ssd1306Model() {
+        memset(ram, 0, sizeof(ram));
+    }
+
+    void apply(const TwoWire& bus) {
+        for (const I2cTransmission& t : bus.log) {
+            if (t.bytes.empty()) continue;
+            if (t.bytes[0] == 0x00) command(t.bytes);
+            else if (t.bytes[0] == 0x40) data(t.bytes);
+        }
+    }
+
+private:
+    uint8_t colStart = 0, colEnd = 127, pageStart = 0, pageEnd = 3;
+    uint8_t col = 0, page = 0;
+
+    void command(const std::vector<uint8_t>& bytes) {
+        for (size_t i = 1; i < bytes.size(); i++) {
+            if (bytes[i] == SSD1306_COLUMNADDR && i + 2 < bytes.size()) {
+                colStart = col = bytes[i + 1];
+                colEnd = bytes[i + 2];
+                i += 2;
+            } else if (bytes[i] == SSD1306_PAGEADDR && i + 2 < bytes.size()) {
+                pageStart = page = bytes[i + 1];
+                pageEnd = std::min<uint8_t>(bytes[i + 2], 3);
+                i += 2;
+            }
+        }
+    }
+
+    void data(const std::vector<uint8_t>& bytes) {
+        for (size_t i = 1; i < bytes.size(); i++) {
+            ram[page * 128 + col] = bytes[i];
+            if (col++ == colEnd) {
+                col = colStart;
+                page = page == pageEnd ? pageStart : page + 1;
+            }
+        }
+    }
+};
+
+#endif // HOST_ADAFRUIT_SSD1306_H
@@ -0,0 +1,449 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Stand-in for the ESP8266 Arduino core on a desktop compiler. Time is
+// a virtual clock that only moves when a test or a stand-in (a TLS
+// handshake, delay()) advances it, so runs are repeatable.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <ctime>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+
+using std::min;
+using std::max;
+
+// Flash and RAM share one address space on the host
+#define PROGMEM
+#define PSTR(text) (text)
+#define F(text) (text)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x00
+#define INPUT_PULLUP 0x02
+#define OUTPUT 0x01
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define DEC 10
+#define HEX 16
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Input change a test scheduled, applied as the clock passes it
+struct HostGpioEvent {
+    uint8_t pin;
+    int level;
+};
+
+// Pin levels and interrupts. A test schedules input changes, e.g. a
+// button press, and delay() and esp_delay() apply them at their time,
+// calling the attached interrupt like the hardware would.
+struct HostGpio {
+    static const int PINS = 17;
+    int level[PINS];
+    int pwm[PINS];
+    int mode[PINS];
+    void (*isr[PINS])();
+    int isrMode[PINS];
+    std::multimap<uint64_t, HostGpioEvent> events;
+    unsigned long interrupts = 0;
+
+    HostGpio() {
+        reset();
+    }
+
+    static HostGpio& get() {
+        static HostGpio gpio;
+        return gpio;
+    }
+
+    void reset() {
+        for (int i = 0; i < PINS; i++) {
+            level[i] = HIGH;
+            pwm[i] = 0;
+            mode[i] = INPUT;
+            isr[i] = nullptr;
+            isrMode[i] = 0;
+        }
+        events.clear();
+        interrupts = 0;
+    }
+
+    void schedule(uint8_t pin, int value, uint32_t atMs) {
+        events.insert({(uint64_t)atMs * 1000, HostGpioEvent{pin, value}});
+    }
+
+    // Input change from outside, fires the pin's interrupt on an edge
+    void set(uint8_t pin, int value) {
+        if (pin >= PINS || level[pin] == value) return;
+        level[pin] = value;
+        bool fires = isrMode[pin] == CHANGE || (isrMode[pin] == RISING && value == HIGH) ||
+                     (isrMode[pin] == FALLING && value == LOW);
+        if (isr[pin] != nullptr && fires) {
+            interrupts++;
+            isr[pin]();
+        }
+    }
+
+    uint64_t nextEventAt() const {
+        return events.empty() ? UINT64_MAX : events.begin()->first;
+    }
+
+    void applyDue(uint64_t nowMicros) {
+        while (!events.empty() && events.begin()->first <= nowMicros) {
+            HostGpioEvent event = events.begin()->second;
+            events.erase(events.begin());
+            set(event.pin, event.level);
+        }
+    }
+};
+
+struct HostClock {
+    static uint64_t& nowMicros() {
+        static uint64_t now = 0;
+        return now;
+    }
+
+    static void advanceMicros(uint64_t us) {
+        nowMicros() += us;
+    }
+
+    static void advance(uint32_t ms) {
+        nowMicros() += (uint64_t)ms * 1000;
+    }
+
+    static void set(uint32_t ms) {
+        nowMicros() = (uint64_t)ms * 1000;
+    }
+
+    // Moves to `target`, stopping at each scheduled GPIO change on the way
+    static void runTo(uint64_t target) {
+        HostGpio& gpio = HostGpio::get();
+        while (gpio.nextEventAt() <= target) {
+            nowMicros() = std::max(nowMicros(), gpio.nextEventAt());
+            gpio.applyDue(nowMicros());
+        }
+        nowMicros() = std::max(nowMicros(), target);
+    }
+
+    // Unix time at the clock's zero, as NTP would set it. Until it is,
+    // time() counts from boot like the ESP8266's does.
+    static time_t& epoch() {
+        static time_t seconds = 0;
+        return seconds;
+    }
+};
+
+inline time_t hostTime(time_t* out) {
+    time_t now = HostClock::epoch() + (time_t)(HostClock::nowMicros() / 1000000);
+    if (out != nullptr) *out = now;
+    return now;
+}
+#define time(out) hostTime(out)
+
+inline unsigned long millis() {
+    return (unsigned long)(uint32_t)(HostClock::nowMicros() / 1000);
+}
+
+inline unsigned long micros() {
+    return (unsigned long)(uint32_t)HostClock::nowMicros();
+}
+
+inline void delay(unsigned long ms) {
+    HostClock::runTo(HostClock::nowMicros() + (uint64_t)ms * 1000);
+}
+
+inline void yield() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HostGpio::PINS) HostGpio::get().mode[pin] = mode;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= HostGpio::PINS) return;
+    HostGpio::get().level[pin] = value;
+    HostGpio::get().pwm[pin] = 0;
+}
+
+inline int digitalRead(uint8_t pin) {
+    return pin < HostGpio::PINS ? HostGpio::get().level[pin] : LOW;
+}
+
+inline void analogWrite(uint8_t pin, int value) {
+    if (pin < HostGpio::PINS) HostGpio::get().pwm[pin] = value;
+}
+
+inline void analogWriteRange(uint32_t) {}
+
+inline uint8_t digitalPinToInterrupt(uint8_t pin) {
+    return pin;
+}
+
+inline void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    if (pin >= HostGpio::PINS) return;
+    HostGpio::get().isr[pin] = isr;
+    HostGpio::get().isrMode[pin] = mode;
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    if (pin < HostGpio::PINS) HostGpio::get().isr[pin] = nullptr;
+}
+
+// Same sequence every run
+inline long random(long howBig) {
+    static uint32_t state = 12345;
+    state = state * 1103515245 + 12345;
+    return howBig > 0 ? (long)((state >> 8) % (uint32_t)howBig) : 0;
+}
+
+inline long random(long howSmall, long howBig) {
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+// The ESP8266 libc has it, older glibc doesn't
+inline size_t hostStrlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#define strlcpy hostStrlcpy
+
+// Arduino String over std::string, with the members the sketch uses
+class String {
+private:
+    std::string text;
+
+public:
+    String() {}
+    String(const char* value) : text(value != nullptr ? value : "") {}
+    String(const std::string& value) : text(value) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    size_t length() const { return text.size(); }
+    char operator[](size_t i) const { return i < text.size() ? text[i] : '\0'; }
+    long toInt() const { return strtol(text.c_str(), nullptr, 10); }
+    bool startsWith(const String& prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String& suffix) const {
+        return text.size() >= suffix.text.size() &&
+               text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+    String substring(size_t from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(size_t from, size_t to) const {
+        return from < text.size() && from < to ? String(text.substr(from, to - from)) : String();
+    }
+    int indexOf(char c) const {
+        size_t at = text.find(c);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == other; }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator!=(const char* other) const { return text != other; }
+    bool operator<(const String& other) const { return text < other.text; }
+
+    friend String operator+(String left, const String& right) { return left += right; }
+    friend String operator+(String left, const char* right) { return left += right; }
+    friend String operator+(const char* left, const String& right) { return String(left) += right; }
+};
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& out) const = 0;
+};
+
+// Text output shared by Serial, the display and response streams
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (len-- > 0) n += write(*data++);
+        return n;
+    }
+
+    size_t write(const char* text) { return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* data, size_t len) { return write((const uint8_t*)data, len); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str(), text.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC) { return base == DEC ? printf("%ld", value) : printf("%lx", value); }
+    size_t print(unsigned long value, int base = DEC) { return base == DEC ? printf("%lu", value) : printf("%lx", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    size_t print(const Printable& value) { return value.printTo(*this); }
+
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+    size_t println(double value, int digits) { return print(value, digits) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        if ((size_t)len < sizeof(buffer)) return write((const uint8_t*)buffer, len);
+
+        std::string text(len, '\0');
+        va_start(args, format);
+        vsnprintf(&text[0], len + 1, format, args);
+        va_end(args);
+        return write((const uint8_t*)text.data(), len);
+    }
+};
+
+class IPAddress : public Printable {
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+
+    uint8_t operator[](int i) const { return octets[i]; }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(text);
+    }
+
+    size_t printTo(Print& out) const override {
+        return out.print(toString());
+    }
+};
+
+// Heap as the TLS stand-in sees it: one pool, no fragmentation
+struct HostHeap {
+    static long& freeBytes() {
+        static long bytes = 40000;
+        return bytes;
+    }
+};
+
+#define HOST_RTC_USER_BYTES 512     // RTC user memory, addressed in 4-byte blocks like the ESP8266's
+
+class HostEsp {
+public:
+    uint8_t rtc[HOST_RTC_USER_BYTES] = {};
+    int restarts = 0;
+
+    uint32_t getFreeHeap() {
+        return (uint32_t)std::max(0L, HostHeap::freeBytes());
+    }
+
+    uint32_t getMaxFreeBlockSize() {
+        return getFreeHeap();
+    }
+
+    uint8_t getHeapFragmentation() {
+        return 0;
+    }
+
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+        if (offset * 4 + size > HOST_RTC_USER_BYTES) return false;
+        memcpy(data, rtc + offset * 4, size);
+        return true;
+    }
+
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+        if (offset * 4 + size > HOST_RTC_USER_BYTES) return false;
+        memcpy(rtc + offset * 4, data, size);
+        return true;
+    }
+
+    void restart() {
+        restarts++;
+    }
+};
+
+// Serial output goes to stdout only when HOST_VERBOSE is set. Input is
+// what the test queued with hostInput().
+class HostSerial : public Print {
+private:
+    std::string input;
+
+public:
+    using Print::write;
+
+    static bool enabled() {
+        static bool verbose = getenv("HOST_VERBOSE") != nullptr;
+        return verbose;
+    }
+
+    void begin(unsigned long) {}
+
+    size_t write(uint8_t c) override {
+        if (enabled()) putchar(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        if (enabled()) fwrite(data, 1, len, stdout);
+        return len;
+    }
+
+    int available() {
+        return (int)input.size();
+    }
+
+    int read() {
+        if (input.empty()) return -1;
+        int c = (uint8_t)input[0];
+        input.erase(0, 1);
+        return c;
+    }
+
+    void hostInput(const char* text) {
+        input += text;
+    }
+};
+
+// NTP is not asked, tests set HostClock::epoch()
+inline void configTime(int, int, const char*, const char* = nullptr, const char* = nullptr) {}
+
+inline HostEsp ESP;
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
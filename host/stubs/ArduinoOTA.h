@@ -0,0 +1,45 @@
+#ifndef HOST_ARDUINOOTA_H
+#define HOST_ARDUINOOTA_H
+
+// OTA updates never arrive on the host; callbacks are kept, not called
+
+#include "Arduino.h"
+
+#define U_FLASH 0
+#define U_FS 100
+
+typedef enum {
+    OTA_AUTH_ERROR,
+    OTA_BEGIN_ERROR,
+    OTA_CONNECT_ERROR,
+    OTA_RECEIVE_ERROR,
+    OTA_END_ERROR
+} ota_error_t;
+
+class ArduinoOTAClass {
+public:
+    bool started = false;
+    unsigned long handled = 0;
+
+    void setHostname(const char*) {}
+    void onStart(std::function<void()>) {}
+    void onEnd(std::function<void()>) {}
+    void onProgress(std::function<void(unsigned int, unsigned int)>) {}
+    void onError(std::function<void(ota_error_t)>) {}
+
+    void begin() {
+        started = true;
+    }
+
+    void handle() {
+        handled++;
+    }
+
+    int getCommand() {
+        return U_FLASH;
+    }
+};
+
+inline ArduinoOTAClass ArduinoOTA;
+
+#endif // HOST_ARDUINOOTA_H
@@ -0,0 +1,106 @@
+#ifndef HOST_ESP8266WIFI_H
+#define HOST_ESP8266WIFI_H
+
+// Stand-in station interface. A join completes after scanJoinMs, or
+// after fastJoinMs when begin() is given the access point's BSSID and
+// channel; a wrong BSSID or channel never joins, as the SDK would keep
+// trying the absent access point.
+
+#include "Arduino.h"
+
+enum WiFiMode_t {
+    WIFI_OFF,
+    WIFI_STA,
+    WIFI_AP,
+    WIFI_AP_STA
+};
+
+enum wl_status_t {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+};
+
+enum WiFiSleepType_t {
+    WIFI_NONE_SLEEP,
+    WIFI_LIGHT_SLEEP,
+    WIFI_MODEM_SLEEP
+};
+
+class HostWiFi {
+public:
+    // The access point, for tests to set
+    bool reachable = true;
+    uint32_t fastJoinMs = 250;
+    uint32_t scanJoinMs = 2500;
+    uint8_t apBssid[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    uint8_t apChannel = 6;
+
+    // What the sketch did
+    int joins = 0;
+    bool lastJoinFast = false;
+    WiFiSleepType_t sleepMode = WIFI_NONE_SLEEP;
+
+private:
+    bool joining = false;
+    unsigned long joinStart = 0;
+    uint32_t joinMs = 0;
+
+public:
+    void persistent(bool) {}
+
+    bool mode(WiFiMode_t) {
+        return true;
+    }
+
+    wl_status_t begin(const char* ssid, const char* password, int32_t channel = 0, const uint8_t* bssid = nullptr,
+                      bool connect = true) {
+        joins++;
+        joining = true;
+        joinStart = millis();
+        lastJoinFast = bssid != nullptr;
+        if (bssid == nullptr) {
+            joinMs = scanJoinMs;
+        } else if (channel == apChannel && memcmp(bssid, apBssid, 6) == 0) {
+            joinMs = fastJoinMs;
+        } else {
+            joinMs = UINT32_MAX;
+        }
+        return WL_DISCONNECTED;
+    }
+
+    wl_status_t status() {
+        if (joining && reachable && joinMs != UINT32_MAX && millis() - joinStart >= joinMs) {
+            return WL_CONNECTED;
+        }
+        return WL_DISCONNECTED;
+    }
+
+    bool disconnect(bool = false) {
+        joining = false;
+        return true;
+    }
+
+    IPAddress localIP() {
+        return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+    }
+
+    uint8_t* BSSID() {
+        return apBssid;
+    }
+
+    int32_t channel() {
+        return apChannel;
+    }
+
+    bool setSleepMode(WiFiSleepType_t type, uint8_t = 0) {
+        sleepMode = type;
+        return true;
+    }
+};
+
+inline HostWiFi WiFi;
+
+#endif // HOST_ESP8266WIFI_H
@@ -0,0 +1,6 @@
+#ifndef HOST_ESPASYNCTCP_H
+#define HOST_ESPASYNCTCP_H
+
+// Nothing used directly, the web server stand-in needs no sockets
+
+#endif // HOST_ESPASYNCTCP_H
@@ -0,0 +1,494 @@
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+// Stand-in for ESPAsyncWebServer without sockets. Tests hand requests
+// to AsyncWebServer::hostRequest(), which offers them to the handlers
+// in the order they were added, as the library does, and returns the
+// finished response; chunked responses are drained a TCP segment at a
+// time. AsyncWebSocket clients are connected, fed frames and read back
+// by the test the same way.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "LittleFS.h"
+
+enum WebRequestMethod {
+    HTTP_GET = 0x01,
+    HTTP_POST = 0x02,
+    HTTP_DELETE = 0x04,
+    HTTP_PUT = 0x08,
+    HTTP_PATCH = 0x10,
+    HTTP_HEAD = 0x20,
+    HTTP_OPTIONS = 0x40,
+    HTTP_ANY = 0x7F
+};
+typedef uint8_t WebRequestMethodComposite;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+#define HOST_TCP_SEGMENT 1460       // Chunk the library offers a filler at most
+
+class AsyncWebServerRequest;
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebParameter {
+private:
+    String paramName;
+    String paramValue;
+    bool post;
+
+public:
+    AsyncWebParameter(const String& name, const String& value, bool isPost)
+        : paramName(name), paramValue(value), post(isPost) {}
+
+    const String& name() const { return paramName; }
+    const String& value() const { return paramValue; }
+    bool isPost() const { return post; }
+};
+
+class AsyncWebHeader {
+private:
+    String headerName;
+    String headerValue;
+
+public:
+    AsyncWebHeader(const String& name, const String& value) : headerName(name), headerValue(value) {}
+
+    const String& name() const { return headerName; }
+    const String& value() const { return headerValue; }
+};
+
+class AsyncWebServerResponse {
+public:
+    int code;
+    String contentType;
+    std::vector<AsyncWebHeader> headers;
+    std::string body;
+    AwsResponseFiller filler;       // Set for chunked responses
+    unsigned long fillerCalls = 0;
+
+    AsyncWebServerResponse(int status, const String& type) : code(status), contentType(type) {}
+    virtual ~AsyncWebServerResponse() {}
+
+    void addHeader(const String& name, const String& value) {
+        headers.emplace_back(name, value);
+    }
+
+    const char* header(const char* name) const {
+        for (const AsyncWebHeader& h : headers) {
+            if (strcasecmp(h.name().c_str(), name) == 0) return h.value().c_str();
+        }
+        return nullptr;
+    }
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+    using Print::write;
+
+    AsyncResponseStream(const String& type) : AsyncWebServerResponse(200, type) {}
+
+    size_t write(uint8_t c) override {
+        body += (char)c;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        body.append((const char*)data, len);
+        return len;
+    }
+};
+
+class AsyncWebServerRequest {
+private:
+    WebRequestMethodComposite requestMethod;
+    String requestUrl;
+    std::vector<AsyncWebParameter> params;
+    std::vector<AsyncWebHeader> headers;
+    std::unique_ptr<AsyncWebServerResponse> response;
+
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method, const char* url,
+                          const std::vector<AsyncWebHeader>& requestHeaders = {}, const char* form = "")
+        : requestMethod(method), headers(requestHeaders) {
+        const char* query = strchr(url, '?');
+        requestUrl = query != nullptr ? String(std::string(url, query - url)) : String(url);
+        if (query != nullptr) parse(query + 1, false);
+        parse(form, true);
+    }
+
+    WebRequestMethodComposite method() const { return requestMethod; }
+    const String& url() const { return requestUrl; }
+
+    bool hasParam(const String& name, bool post = false) const {
+        return const_cast<AsyncWebServerRequest*>(this)->getParam(name, post) != nullptr;
+    }
+
+    AsyncWebParameter* getParam(const String& name, bool post = false) {
+        for (AsyncWebParameter& p : params) {
+            if (p.name() == name && p.isPost() == post) return &p;
+        }
+        return nullptr;
+    }
+
+    bool hasHeader(const String& name) const {
+        return const_cast<AsyncWebServerRequest*>(this)->getHeader(name) != nullptr;
+    }
+
+    AsyncWebHeader* getHeader(const String& name) {
+        for (AsyncWebHeader& h : headers) {
+            if (strcasecmp(h.name().c_str(), name.c_str()) == 0) return &h;
+        }
+        return nullptr;
+    }
+
+    void send(AsyncWebServerResponse* reply) {
+        response.reset(reply);
+        if (reply->filler) drain(*reply);
+    }
+
+    void send(int code, const String& contentType = String(), const String& content = String()) {
+        AsyncWebServerResponse* reply = new AsyncWebServerResponse(code, contentType);
+        reply->body = content.c_str();
+        send(reply);
+    }
+
+    // Serves path.gz with Content-Encoding when it exists, like the library
+    AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(),
+                                          bool download = false) {
+        String gzip = path + ".gz";
+        bool gzipped = fs.exists(gzip.c_str());
+        File file = fs.open(gzipped ? gzip.c_str() : path.c_str(), "r");
+        if (!file) return new AsyncWebServerResponse(404, "text/plain");
+
+        AsyncWebServerResponse* reply = new AsyncWebServerResponse(200, contentType);
+        if (gzipped) reply->addHeader("Content-Encoding", "gzip");
+        char buffer[512];
+        size_t len;
+        while ((len = file.readBytes(buffer, sizeof(buffer))) > 0) reply->body.append(buffer, len);
+        return reply;
+    }
+
+    AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller filler) {
+        AsyncWebServerResponse* reply = new AsyncWebServerResponse(200, contentType);
+        reply->filler = filler;
+        return reply;
+    }
+
+    AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460) {
+        return new AsyncResponseStream(contentType);
+    }
+
+    // What the handler sent, nullptr if it didn't
+    const AsyncWebServerResponse* hostResponse() const {
+        return response.get();
+    }
+
+private:
+    void parse(const char* text, bool post) {
+        while (text != nullptr && *text != '\0') {
+            const char* end = strchr(text, '&');
+            std::string pair = end != nullptr ? std::string(text, end - text) : std::string(text);
+            size_t equals = pair.find('=');
+            params.emplace_back(String(pair.substr(0, equals)),
+                                String(equals == std::string::npos ? std::string() : pair.substr(equals + 1)), post);
+            text = end != nullptr ? end + 1 : nullptr;
+        }
+    }
+
+    // A filler is called until it returns 0, a segment at a time
+    static void drain(AsyncWebServerResponse& reply) {
+        uint8_t buffer[HOST_TCP_SEGMENT];
+        for (int retries = 0; retries < 1000;) {
+            size_t len = reply.filler(buffer, sizeof(buffer), reply.body.size());
+            reply.fillerCalls++;
+            if (len == RESPONSE_TRY_AGAIN) {
+                retries++;
+                continue;
+            }
+            if (len == 0) return;
+            reply.body.append((const char*)buffer, len);
+        }
+    }
+};
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+
+    virtual bool canHandle(AsyncWebServerRequest* request) {
+        return false;
+    }
+
+    virtual void handleRequest(AsyncWebServerRequest* request) {}
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+private:
+    String uri;
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction onRequest;
+
+public:
+    AsyncCallbackWebHandler(const String& path, WebRequestMethodComposite methods, ArRequestHandlerFunction fn)
+        : uri(path), method(methods), onRequest(fn) {}
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if ((request->method() & method) == 0) return false;
+        return request->url() == uri || request->url().startsWith(uri + "/");
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) override {
+        onRequest(request);
+    }
+};
+
+// Files under uri from path in fs, index.htm for a directory
+class AsyncStaticWebHandler : public AsyncWebHandler {
+private:
+    String uri;
+    FS& fs;
+    String path;
+    String cacheControl;
+
+public:
+    AsyncStaticWebHandler(const String& prefix, FS& files, const String& root, const char* cache)
+        : uri(prefix), fs(files), path(root), cacheControl(cache) {}
+
+    AsyncStaticWebHandler& setCacheControl(const char* cache) {
+        cacheControl = cache;
+        return *this;
+    }
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        if (request->method() != HTTP_GET || !request->url().startsWith(uri)) return false;
+        String file = filePath(request);
+        return fs.exists(file.c_str()) || fs.exists((file + ".gz").c_str());
+    }
+
+    void handleRequest(AsyncWebServerRequest* request) override {
+        AsyncWebServerResponse* response = request->beginResponse(fs, filePath(request));
+        if (cacheControl.length() > 0) response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+    }
+
+private:
+    String filePath(AsyncWebServerRequest* request) const {
+        String file = path + request->url().substring(uri.length());
+        if (file.endsWith("/")) file += "index.htm";
+        return file;
+    }
+};
+
+enum AwsEventType {
+    WS_EVT_CONNECT,
+    WS_EVT_DISCONNECT,
+    WS_EVT_PONG,
+    WS_EVT_ERROR,
+    WS_EVT_DATA
+};
+
+enum AwsFrameType {
+    WS_CONTINUATION = 0x00,
+    WS_TEXT = 0x01,
+    WS_BINARY = 0x02,
+    WS_DISCONNECT = 0x08,
+    WS_PING = 0x09,
+    WS_PONG = 0x0A
+};
+
+struct AwsFrameInfo {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+};
+
+class AsyncWebSocket;
+
+// Frames sent to one client, kept for the test to read
+struct HostWsFrame {
+    bool binary;
+    std::string data;
+};
+
+class AsyncWebSocketClient {
+private:
+    uint32_t clientId;
+
+public:
+    std::vector<HostWsFrame> sent;
+    size_t queued = 0;          // Socket queue length reported to the sketch
+    bool closed = false;
+
+    AsyncWebSocketClient(uint32_t id) : clientId(id) {}
+
+    uint32_t id() const { return clientId; }
+
+    IPAddress remoteIP() const { return IPAddress(192, 168, 1, 20); }
+
+    size_t queueLen() const { return queued; }
+
+    void text(const char* data, size_t len) {
+        if (!closed) sent.push_back(HostWsFrame{false, std::string(data, len)});
+    }
+
+    void binary(const char* data, size_t len) {
+        if (!closed) sent.push_back(HostWsFrame{true, std::string(data, len)});
+    }
+
+    void close();
+
+    // Payload bytes sent so far
+    size_t sentBytes() const {
+        size_t bytes = 0;
+        for (const HostWsFrame& frame : sent) bytes += frame.data.size();
+        return bytes;
+    }
+
+    AsyncWebSocket* server = nullptr;
+};
+
+typedef std::function<void(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg,
+                           uint8_t* data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+private:
+    String url;
+    AwsEventHandler onEventHandler;
+    std::vector<std::unique_ptr<AsyncWebSocketClient>> clients;
+    uint32_t nextId = 1;
+
+public:
+    AsyncWebSocket(const String& path) : url(path) {}
+
+    const char* path() const {
+        return url.c_str();
+    }
+
+    void onEvent(AwsEventHandler handler) {
+        onEventHandler = handler;
+    }
+
+    AsyncWebSocketClient* client(uint32_t id) {
+        for (auto& c : clients) {
+            if (c->id() == id && !c->closed) return c.get();
+        }
+        return nullptr;
+    }
+
+    void cleanupClients(uint16_t maxClients = 8) {
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const std::unique_ptr<AsyncWebSocketClient>& c) { return c->closed; }),
+                      clients.end());
+    }
+
+    bool canHandle(AsyncWebServerRequest* request) override {
+        return request->url() == url;
+    }
+
+    // A browser opening the socket
+    AsyncWebSocketClient* hostConnect() {
+        clients.emplace_back(new AsyncWebSocketClient(nextId++));
+        AsyncWebSocketClient* c = clients.back().get();
+        c->server = this;
+        event(c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+        return c;
+    }
+
+    // One unfragmented frame from the browser
+    void hostReceive(AsyncWebSocketClient* c, const void* data, size_t len, bool binary) {
+        AwsFrameInfo info = {};
+        info.final = 1;
+        info.opcode = binary ? WS_BINARY : WS_TEXT;
+        info.message_opcode = info.opcode;
+        info.len = len;
+        std::string copy((const char*)data, len);
+        event(c, WS_EVT_DATA, &info, (uint8_t*)&copy[0], len);
+    }
+
+    void hostDisconnect(AsyncWebSocketClient* c) {
+        c->close();
+    }
+
+    void hostClosed(AsyncWebSocketClient* c) {
+        event(c, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+    }
+
+private:
+    void event(AsyncWebSocketClient* c, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        if (onEventHandler) onEventHandler(this, c, type, arg, data, len);
+    }
+};
+
+// The library reports the disconnect from its own context; here it is
+// reported at once
+inline void AsyncWebSocketClient::close() {
+    if (closed) return;
+    closed = true;
+    if (server != nullptr) server->hostClosed(this);
+}
+
+class AsyncWebServer {
+private:
+    std::vector<AsyncWebHandler*> handlers;
+    std::vector<std::unique_ptr<AsyncWebHandler>> owned;
+
+public:
+    bool started = false;
+    unsigned long notFound = 0;
+
+    AsyncWebServer(uint16_t port) {}
+
+    void begin() {
+        started = true;
+    }
+
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler) {
+        handlers.push_back(handler);
+        return *handler;
+    }
+
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction fn) {
+        AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler(uri, method, fn);
+        owned.emplace_back(handler);
+        addHandler(handler);
+        return *handler;
+    }
+
+    AsyncStaticWebHandler& serveStatic(const char* uri, FS& fs, const char* path, const char* cacheControl = nullptr) {
+        AsyncStaticWebHandler* handler = new AsyncStaticWebHandler(uri, fs, path, cacheControl);
+        owned.emplace_back(handler);
+        addHandler(handler);
+        return *handler;
+    }
+
+    // The websocket served on path, nullptr if there is none
+    AsyncWebSocket* hostSocket(const char* path) {
+        for (AsyncWebHandler* handler : handlers) {
+            AsyncWebSocket* socket = dynamic_cast<AsyncWebSocket*>(handler);
+            if (socket != nullptr && strcmp(socket->path(), path) == 0) return socket;
+        }
+        return nullptr;
+    }
+
+    // The first handler that can take the request gets it, a 404 if none
+    void hostRequest(AsyncWebServerRequest& request) {
+        for (AsyncWebHandler* handler : handlers) {
+            if (handler->canHandle(&request)) {
+                handler->handleRequest(&request);
+                return;
+            }
+        }
+        notFound++;
+        request.send(404);
+    }
+};
+
+#endif // HOST_ESPASYNCWEBSERVER_H
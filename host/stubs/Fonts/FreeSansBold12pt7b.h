@@ -0,0 +1,9 @@
+#ifndef HOST_FREESANSBOLD12PT7B_H
+#define HOST_FREESANSBOLD12PT7B_H
+
+// Line height of the library font, no glyphs, see Adafruit_GFX.h
+#include "../Adafruit_GFX.h"
+
+const GFXfont FreeSansBold12pt7b PROGMEM = {nullptr, nullptr, 0x20, 0x7E, 29};
+
+#endif // HOST_FREESANSBOLD12PT7B_H
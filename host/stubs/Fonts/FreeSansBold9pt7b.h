@@ -0,0 +1,9 @@
+#ifndef HOST_FREESANSBOLD9PT7B_H
+#define HOST_FREESANSBOLD9PT7B_H
+
+// Line height of the library font, no glyphs, see Adafruit_GFX.h
+#include "../Adafruit_GFX.h"
+
+const GFXfont FreeSansBold9pt7b PROGMEM = {nullptr, nullptr, 0x20, 0x7E, 22};
+
+#endif // HOST_FREESANSBOLD9PT7B_H
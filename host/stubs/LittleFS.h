@@ -0,0 +1,276 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// Stand-in for the ESP8266 LittleFS on a host directory, a fresh
+// temporary one per process. Writes are also charged to a model of the
+// flash underneath: littlefs can't program into a block it didn't just
+// erase, so a file reopened for writing copies its partly filled last
+// block to a new one, and every close commits a metadata page. That is
+// where the write amplification of small appends comes from.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <memory>
+#include <filesystem>
+#include "Arduino.h"
+
+#define HOST_FLASH_PAGE 256         // Program unit (bytes)
+#define HOST_FLASH_BLOCK 8192       // Erase unit, as the ESP8266 core sets up LittleFS (bytes)
+
+enum SeekMode {
+    SeekSet = SEEK_SET,
+    SeekCur = SEEK_CUR,
+    SeekEnd = SEEK_END
+};
+
+// Flash traffic since the last reset()
+struct HostFlash {
+    unsigned long long payloadBytes = 0;    // What the sketch wrote
+    unsigned long long programBytes = 0;    // What the flash was programmed with
+    unsigned long long erases = 0;
+    unsigned long long readCalls = 0;
+    unsigned long long opens = 0;
+    unsigned long long capacity = ~0ULL;    // Payload bytes the disk holds, for full-disk tests
+
+    static HostFlash& get() {
+        static HostFlash flash;
+        return flash;
+    }
+
+    void reset() {
+        *this = HostFlash();
+    }
+
+    double amplification() const {
+        return payloadBytes > 0 ? (double)programBytes / payloadBytes : 0;
+    }
+
+    static unsigned long long pages(unsigned long long bytes) {
+        return (bytes + HOST_FLASH_PAGE - 1) / HOST_FLASH_PAGE * HOST_FLASH_PAGE;
+    }
+};
+
+namespace HostFs {
+// Removed again when the process exits
+struct TempDir {
+    std::filesystem::path path;
+
+    TempDir() {
+        char name[] = "/tmp/host-littlefs-XXXXXX";
+        path = mkdtemp(name);
+    }
+
+    ~TempDir() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+};
+
+inline const std::filesystem::path& root() {
+    static TempDir dir;
+    return dir.path;
+}
+
+inline std::filesystem::path map(const char* path) {
+    return root() / std::filesystem::path(path).relative_path();
+}
+
+// Empties the disk, like a fresh image
+inline void format() {
+    std::error_code error;
+    for (auto& entry : std::filesystem::directory_iterator(root(), error)) {
+        std::filesystem::remove_all(entry.path(), error);
+    }
+    HostFlash::get().reset();
+}
+
+inline unsigned long long used() {
+    unsigned long long bytes = 0;
+    std::error_code error;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(root(), error)) {
+        if (entry.is_regular_file()) bytes += entry.file_size();
+    }
+    return bytes;
+}
+}
+
+class File {
+private:
+    struct Handle {
+        FILE* fp = nullptr;
+        std::string name;
+        size_t sizeAtOpen = 0;
+        size_t written = 0;
+
+        ~Handle() {
+            if (fp == nullptr) return;
+            fclose(fp);
+            if (written == 0) return;
+            // Tail block copied if the file was reopened part way into
+            // one, then the new data, then the metadata commit
+            HostFlash& flash = HostFlash::get();
+            size_t tail = sizeAtOpen % HOST_FLASH_BLOCK;
+            flash.programBytes += HostFlash::pages(tail + written) + HOST_FLASH_PAGE;
+            flash.erases += (tail + written + HOST_FLASH_BLOCK - 1) / HOST_FLASH_BLOCK;
+        }
+    };
+    std::shared_ptr<Handle> handle;
+
+public:
+    File() {}
+
+    File(FILE* fp, const char* name, size_t size) : handle(std::make_shared<Handle>()) {
+        handle->fp = fp;
+        handle->name = name;
+        handle->sizeAtOpen = size;
+        HostFlash::get().opens++;
+    }
+
+    explicit operator bool() const {
+        return handle != nullptr && handle->fp != nullptr;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) {
+        if (!*this) return 0;
+        HostFlash::get().readCalls++;
+        return fread(buffer, 1, size, handle->fp);
+    }
+
+    size_t readBytes(char* buffer, size_t size) {
+        return read((uint8_t*)buffer, size);
+    }
+
+    int read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) {
+        if (!*this) return 0;
+        HostFlash& flash = HostFlash::get();
+        unsigned long long room = flash.capacity > HostFs::used() ? flash.capacity - HostFs::used() : 0;
+        if (size > room) size = room;
+        size_t done = fwrite(data, 1, size, handle->fp);
+        fflush(handle->fp);
+        handle->written += done;
+        flash.payloadBytes += done;
+        return done;
+    }
+
+    size_t write(uint8_t c) {
+        return write(&c, 1);
+    }
+
+    bool seek(uint32_t position, SeekMode mode = SeekSet) {
+        return *this && fseek(handle->fp, position, mode) == 0;
+    }
+
+    size_t position() const {
+        return *this ? ftell(handle->fp) : 0;
+    }
+
+    size_t size() const {
+        if (!*this) return 0;
+        long at = ftell(handle->fp);
+        fseek(handle->fp, 0, SEEK_END);
+        long end = ftell(handle->fp);
+        fseek(handle->fp, at, SEEK_SET);
+        return end;
+    }
+
+    int available() {
+        return (int)(size() - position());
+    }
+
+    const char* name() const {
+        return *this ? handle->name.c_str() : "";
+    }
+
+    void close() {
+        handle.reset();
+    }
+};
+
+class Dir {
+private:
+    std::filesystem::directory_iterator it;
+    std::filesystem::directory_iterator end;
+    std::string current;
+    bool started = false;
+
+public:
+    Dir() {}
+
+    explicit Dir(const std::filesystem::path& path) {
+        std::error_code error;
+        it = std::filesystem::directory_iterator(path, error);
+    }
+
+    bool next() {
+        if (started && it != end) ++it;
+        started = true;
+        if (it == end) return false;
+        current = it->path().filename().string();
+        return true;
+    }
+
+    String fileName() const {
+        return String(current);
+    }
+
+    size_t fileSize() const {
+        std::error_code error;
+        return it != end ? it->file_size(error) : 0;
+    }
+};
+
+class FS {
+public:
+    bool begin() {
+        return std::filesystem::is_directory(HostFs::root());
+    }
+
+    bool exists(const char* path) {
+        std::error_code error;
+        return std::filesystem::exists(HostFs::map(path), error);
+    }
+
+    bool mkdir(const char* path) {
+        std::error_code error;
+        return std::filesystem::create_directories(HostFs::map(path), error);
+    }
+
+    bool rmdir(const char* path) {
+        std::error_code error;
+        return std::filesystem::remove(HostFs::map(path), error);
+    }
+
+    bool remove(const char* path) {
+        std::error_code error;
+        return std::filesystem::is_regular_file(HostFs::map(path), error) &&
+               std::filesystem::remove(HostFs::map(path), error);
+    }
+
+    // "r", "w" or "a"; parent directories are created for writes, as
+    // the ESP8266 core does
+    File open(const char* path, const char* mode) {
+        std::filesystem::path file = HostFs::map(path);
+        std::error_code error;
+        size_t size = std::filesystem::is_regular_file(file, error) ? std::filesystem::file_size(file, error) : 0;
+        if (mode[0] == 'w') size = 0;
+        if (mode[0] != 'r') std::filesystem::create_directories(file.parent_path(), error);
+        const char* hostMode = mode[0] == 'r' ? "rb" : mode[0] == 'w' ? "wb" : "ab";
+        FILE* fp = fopen(file.c_str(), hostMode);
+        if (fp == nullptr) return File();
+        return File(fp, path, size);
+    }
+
+    Dir openDir(const char* path) {
+        return Dir(HostFs::map(path));
+    }
+};
+
+inline FS LittleFS;
+
+#endif // HOST_LITTLEFS_H
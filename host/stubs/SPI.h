@@ -0,0 +1,6 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+// Included for the display library only, the panel is on I2C
+
+#endif // HOST_SPI_H
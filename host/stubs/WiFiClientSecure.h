@@ -0,0 +1,128 @@
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+// Stand-in TLS client that talks to canned servers instead of the
+// network. Each server has a handshake time (the virtual clock jumps
+// by it inside connect(), as BearSSL blocks there), a latency before
+// the response shows up, and the response text. Connections charge
+// their buffers to HostHeap like BearSSL does.
+
+#include <map>
+#include <string>
+#include "Arduino.h"
+
+#define HOST_TLS_CONTEXT 6000   // BearSSL engine and session, besides the buffers
+#define HOST_TLS_FULL_RECORDS 16709     // Receive buffer a 16 KB record needs
+
+struct HostServer {
+    bool reachable = true;
+    bool shortRecords = true;       // Takes the max fragment length extension
+    uint32_t handshakeMs = 0;
+    uint32_t latencyMs = 0;
+    std::string response;
+    bool closeAfterResponse = false;
+
+    // Counters for the test to check
+    int connects = 0;
+    int requests = 0;
+    std::string lastRequest;
+};
+
+inline std::map<std::string, HostServer>& hostServers() {
+    static std::map<std::string, HostServer> servers;
+    return servers;
+}
+
+namespace BearSSL {
+class Session {};
+}
+
+class WiFiClientSecure {
+private:
+    HostServer* server = nullptr;
+    bool open = false;
+    size_t charged = 0;
+    uint16_t rxSize = HOST_TLS_FULL_RECORDS;
+    uint16_t txSize = 512;
+
+    std::string pending;
+    size_t pos = 0;
+    unsigned long readyAt = 0;
+
+public:
+    ~WiFiClientSecure() {
+        stop();
+    }
+
+    void setInsecure() {}
+    void setSession(BearSSL::Session*) {}
+    void setTimeout(unsigned long) {}
+
+    void setBufferSizes(int recv, int xmit) {
+        rxSize = recv;
+        txSize = xmit;
+    }
+
+    int connect(const char* host, uint16_t) {
+        stop();
+        auto found = hostServers().find(host);
+        if (found == hostServers().end() || !found->second.reachable) return 0;
+        server = &found->second;
+        server->connects++;
+        // Blocks, but interrupts such as a button edge still fire
+        HostClock::runTo(HostClock::nowMicros() + server->handshakeMs * 1000ULL);
+
+        // Full size records overflow a short buffer during the handshake
+        if (rxSize < HOST_TLS_FULL_RECORDS && !server->shortRecords) return 0;
+
+        charged = rxSize + txSize + HOST_TLS_CONTEXT;
+        HostHeap::freeBytes() -= charged;
+        open = true;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        if (!open) return 0;
+        server->requests++;
+        server->lastRequest.assign((const char*)data, len);
+        pending = server->response;
+        pos = 0;
+        readyAt = millis() + server->latencyMs;
+        return len;
+    }
+
+    int available() {
+        if (millis() < readyAt) return 0;
+        return (int)(pending.size() - pos);
+    }
+
+    int read(uint8_t* buffer, size_t size) {
+        int count = std::min((int)size, available());
+        if (count <= 0) return -1;
+        memcpy(buffer, pending.data() + pos, count);
+        pos += count;
+        if (pos == pending.size() && server->closeAfterResponse) close();
+        return count;
+    }
+
+    // A closing server stays readable until its bytes are drained
+    uint8_t connected() {
+        return open || pos < pending.size();
+    }
+
+    void stop() {
+        close();
+        pending.clear();
+        pos = 0;
+    }
+
+private:
+    void close() {
+        if (!open) return;
+        HostHeap::freeBytes() += charged;
+        charged = 0;
+        open = false;
+    }
+};
+
+#endif // HOST_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,61 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+// Mock I2C bus. Every transmission is kept with its bytes, so tests can
+// count what a frame costs on the wire and replay it into a model of
+// the SSD1306.
+
+#include <vector>
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 128       // Same as the ESP8266 core
+
+struct I2cTransmission {
+    uint8_t address;
+    std::vector<uint8_t> bytes;
+};
+
+class TwoWire {
+public:
+    std::vector<I2cTransmission> log;
+    uint32_t clock = 100000;
+
+    void begin() {}
+
+    void setClock(uint32_t hz) {
+        clock = hz;
+    }
+
+    void beginTransmission(uint8_t address) {
+        log.push_back(I2cTransmission{address, {}});
+    }
+
+    size_t write(uint8_t value) {
+        log.back().bytes.push_back(value);
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        log.back().bytes.insert(log.back().bytes.end(), data, data + len);
+        return len;
+    }
+
+    uint8_t endTransmission() {
+        return 0;
+    }
+
+    // Bytes on the bus, the address byte of each transmission included
+    size_t busBytes() const {
+        size_t total = 0;
+        for (const I2cTransmission& t : log) total += t.bytes.size() + 1;
+        return total;
+    }
+
+    void clear() {
+        log.clear();
+    }
+};
+
+inline TwoWire Wire;
+
+#endif // HOST_WIRE_H
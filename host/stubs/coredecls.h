@@ -0,0 +1,46 @@
+#ifndef HOST_COREDECLS_H
+#define HOST_COREDECLS_H
+
+// The core's suspend and resume. esp_delay() naps on the virtual clock
+// until the timeout or until blocked() turns false, which a scheduled
+// GPIO change can cause through its interrupt.
+
+#include "Arduino.h"
+
+struct HostNaps {
+    unsigned long count = 0;
+    uint64_t micros = 0;
+
+    static HostNaps& get() {
+        static HostNaps naps;
+        return naps;
+    }
+};
+
+inline void esp_schedule() {}
+
+// Checks blocked() every intervalMs, like the core's polling variant
+template <typename T>
+void esp_delay(uint32_t timeoutMs, T&& blocked, uint32_t intervalMs) {
+    uint64_t start = HostClock::nowMicros();
+    uint64_t end = start + (uint64_t)timeoutMs * 1000;
+    while (HostClock::nowMicros() < end && blocked()) {
+        HostClock::runTo(std::min(end, HostClock::nowMicros() + (uint64_t)std::max<uint32_t>(intervalMs, 1) * 1000));
+    }
+    HostNaps::get().count++;
+    HostNaps::get().micros += HostClock::nowMicros() - start;
+}
+
+// Woken by esp_schedule(); only an interrupt can call it during a nap
+template <typename T>
+void esp_delay(uint32_t timeoutMs, T&& blocked) {
+    uint64_t start = HostClock::nowMicros();
+    uint64_t end = start + (uint64_t)timeoutMs * 1000;
+    while (HostClock::nowMicros() < end && blocked()) {
+        HostClock::runTo(std::min(end, HostGpio::get().nextEventAt()));
+    }
+    HostNaps::get().count++;
+    HostNaps::get().micros += HostClock::nowMicros() - start;
+}
+
+#endif // HOST_COREDECLS_H
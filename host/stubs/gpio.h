@@ -0,0 +1,15 @@
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+// SDK GPIO interrupt types, for wakeup from light sleep
+
+typedef enum {
+    GPIO_PIN_INTR_DISABLE = 0,
+    GPIO_PIN_INTR_POSEDGE = 1,
+    GPIO_PIN_INTR_NEGEDGE = 2,
+    GPIO_PIN_INTR_ANYEDGE = 3,
+    GPIO_PIN_INTR_LOLEVEL = 4,
+    GPIO_PIN_INTR_HILEVEL = 5
+} GPIO_INT_TYPE;
+
+#endif // HOST_GPIO_H
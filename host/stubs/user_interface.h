@@ -0,0 +1,13 @@
+#ifndef HOST_USER_INTERFACE_H
+#define HOST_USER_INTERFACE_H
+
+// SDK calls the sketch makes, included inside extern "C" like the SDK's
+
+#include <stdint.h>
+#include "gpio.h"
+
+inline void wifi_enable_gpio_wakeup(uint32_t pin, GPIO_INT_TYPE type) {}
+
+inline void wifi_disable_gpio_wakeup() {}
+
+#endif // HOST_USER_INTERFACE_H
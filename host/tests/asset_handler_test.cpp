@@ -0,0 +1,117 @@
+// AssetHandler's routes on the LittleFS stand-in, laid out the way
+// build_assets.py writes them: the index revalidated through its ETag,
+// the files in build.manifest through the build's ETag, and files the
+// sketch writes at runtime always sent in full.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "asset_handler.h"
+
+#define INDEX_ETAG "\"1f2e3d4c5b6a7988\""
+#define BUILD_ETAG "\"0a1b2c3d4e5f6071\""
+
+static void writeFile(const char* path, const char* text) {
+    File file = LittleFS.open(path, "w");
+    file.write((const uint8_t*)text, strlen(text));
+}
+
+static void writeBuild(bool withManifest) {
+    HostFs::format();
+    writeFile("/index.html.gz", "<gzipped index>");
+    writeFile("/index.etag", INDEX_ETAG "\n");
+    writeFile("/assets/script.b3f2f7ca4d.js.gz", "<gzipped script>");
+    writeFile("/style.css.gz", "<gzipped style>");
+    writeFile("/logos/shib.rle", "<logo>");
+    if (withManifest) writeFile("/build.manifest", BUILD_ETAG "\n/style.css\n/logos/shib.rle\n");
+    // Written by the sketch, not the build
+    writeFile("/boot.bin", "<boot record>");
+}
+
+struct Site {
+    AsyncWebServer server{80};
+    AssetHandler assets;
+    std::unique_ptr<AsyncWebServerRequest> request;
+
+    Site() {
+        assets.begin(&server);
+        assets.serveFiles(&server);
+    }
+
+    const AsyncWebServerResponse* get(const char* url, const char* ifNoneMatch = nullptr) {
+        std::vector<AsyncWebHeader> headers;
+        if (ifNoneMatch != nullptr) headers.emplace_back("If-None-Match", ifNoneMatch);
+        request.reset(new AsyncWebServerRequest(HTTP_GET, url, headers));
+        server.hostRequest(*request);
+        return request->hostResponse();
+    }
+};
+
+static bool hasHeader(const AsyncWebServerResponse* response, const char* name, const char* value) {
+    const char* found = response->header(name);
+    return found != nullptr && strcmp(found, value) == 0;
+}
+
+TEST(indexRevalidates) {
+    writeBuild(true);
+    Site site;
+    const AsyncWebServerResponse* response = site.get("/");
+    CHECK_EQ(response->code, 200);
+    CHECK(hasHeader(response, "ETag", INDEX_ETAG));
+    CHECK(hasHeader(response, "Content-Encoding", "gzip"));
+
+    CHECK_EQ(site.get("/", INDEX_ETAG)->code, 304);
+    CHECK_EQ(site.assets.getNotModifiedCount(), 1);
+}
+
+TEST(hashedAssetsAreImmutable) {
+    writeBuild(true);
+    Site site;
+    const AsyncWebServerResponse* response = site.get("/assets/script.b3f2f7ca4d.js");
+    CHECK_EQ(response->code, 200);
+    CHECK(hasHeader(response, "Cache-Control", ASSET_CACHE_IMMUTABLE));
+}
+
+TEST(shippedFilesCarryTheBuildEtag) {
+    writeBuild(true);
+    Site site;
+    const AsyncWebServerResponse* response = site.get("/logos/shib.rle");
+    CHECK_EQ(response->code, 200);
+    CHECK_STR(response->body.c_str(), "<logo>");
+    CHECK(hasHeader(response, "ETag", BUILD_ETAG));
+    CHECK(hasHeader(response, "Cache-Control", ASSET_CACHE_REVALIDATE));
+
+    // Gzipped ones under their plain name
+    response = site.get("/style.css");
+    CHECK(hasHeader(response, "ETag", BUILD_ETAG));
+    CHECK(hasHeader(response, "Content-Encoding", "gzip"));
+
+    CHECK_EQ(site.get("/logos/shib.rle", BUILD_ETAG)->code, 304);
+    CHECK_EQ(site.get("/style.css", "W/\"other\", " BUILD_ETAG)->code, 304);
+    CHECK_EQ(site.assets.getNotModifiedCount(), 2);
+
+    // Another build's tag gets the file
+    CHECK_EQ(site.get("/logos/shib.rle", "\"ffffffffffffffff\"")->code, 200);
+}
+
+TEST(runtimeFilesAreSentInFull) {
+    writeBuild(true);
+    Site site;
+    const AsyncWebServerResponse* response = site.get("/boot.bin", BUILD_ETAG);
+    CHECK_EQ(response->code, 200);
+    CHECK(response->header("ETag") == nullptr);
+    CHECK(hasHeader(response, "Cache-Control", ASSET_CACHE_REVALIDATE));
+
+    CHECK_EQ(site.get("/missing.txt")->code, 404);
+}
+
+// An upload of the plain data folder has no manifest
+TEST(noManifestNoEtag) {
+    writeBuild(false);
+    Site site;
+    const AsyncWebServerResponse* response = site.get("/logos/shib.rle", BUILD_ETAG);
+    CHECK_EQ(response->code, 200);
+    CHECK(response->header("ETag") == nullptr);
+}
+
+HOST_TEST_MAIN()
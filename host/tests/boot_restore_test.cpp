@@ -0,0 +1,95 @@
+// Time to first price after a power cycle, from the boot record the
+// last run left in LittleFS: the cached access point, pair and price.
+// The sketch runs on the host stubs as in sketch_loop_test; a cold boot
+// there scans for the access point and gets its first price after about
+// 4.3 s. RTC memory is cleared, so only the file is read.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+void pushStats(bool withTelemetry);
+bool showCachedPrice();
+void redrawPrice();
+
+#include "Dogecoin-Ticker.ino"
+
+#define HANDSHAKE_MS 300
+#define LATENCY_MS 800
+#define BOOT_LIMIT_MS 20000
+#define START_TIME 1700000000UL
+
+static HostServer& serve(const char* host, const char* response) {
+    HostServer& server = hostServers()[host];
+    server.handshakeMs = HANDSHAKE_MS;
+    server.latencyMs = LATENCY_MS;
+    server.response = loadResponse(response);
+    return server;
+}
+
+static unsigned long litPixels() {
+    unsigned long lit = 0;
+    const uint8_t* buffer = display.getBuffer();
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT / 8; i++) lit += __builtin_popcount(buffer[i]);
+    return lit;
+}
+
+// What the previous run saved before the power was cut
+static void savePreviousRun() {
+    BootStore previous;
+    previous.begin();
+    previous.saveWiFi(WiFi.apBssid, WiFi.apChannel);
+    previous.savePair("BTC", "USD");
+    Price price;
+    price.parse("36512.25");
+    previous.savePrice(price, 0.0125f);
+    previous.handle();
+    HostClock::advance(BOOT_SAVE_INTERVAL);
+    previous.handle();
+    memset(ESP.rtc, 0, sizeof(ESP.rtc));
+}
+
+TEST(restoredBootShowsPriceAtOnce) {
+    hostServers().clear();
+    HostHeap::freeBytes() = 40000;
+    serve("api.gemini.com", "gemini_pricefeed.http");
+    serve("api.coinbase.com", "coinbase_spot.http");
+    serve("www.bitstamp.net", "bitstamp_ticker.http");
+    HostClock::set(0);
+    HostClock::epoch() = START_TIME;
+    HostFs::format();
+    savePreviousRun();
+    HostClock::set(0);
+
+    setup();
+    unsigned long setupMs = millis();
+
+    // The saved pair and price are drawn before Wi-Fi is up
+    CHECK(bootStore.has(BOOT_HAS_PRICE));
+    CHECK_STR(tickerState.get().crypto, "BTC");
+    CHECK(!tickerState.get().splashActive);
+    CHECK(!wifiHandler.isConnected());
+    CHECK(litPixels() > 0);
+
+    unsigned long passes = 0;
+    while (firstPriceAt == 0 && millis() < BOOT_LIMIT_MS) {
+        loop();
+        delay(1);
+        passes++;
+    }
+    printf("  saved price shown after %lu ms, fresh price after %lu ms, %lu loop passes, Wi-Fi up at %lu ms\n",
+           setupMs, firstPriceAt, passes, wifiHandler.getConnectedAt());
+
+    CHECK(setupMs < 1000);
+    CHECK(firstPriceAt != 0);
+    CHECK(wifiHandler.wasFastJoin());
+    CHECK_EQ(WiFi.joins, 1);
+
+    // The cached access point skips the scan; the fetch then takes one
+    // handshake and the server's latency per source, as on a cold boot
+    CHECK(wifiHandler.getConnectedAt() < WiFi.scanJoinMs);
+    CHECK(firstPriceAt < WiFi.scanJoinMs);
+    CHECK_STR(tickerState.get().crypto, "BTC");
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,395 @@
+// A fetch in flight must not starve the rest of loop(). The sketch's
+// loop is modelled as: ButtonHandler, WebSocketHandler, then one
+// ApiHandler step, then 1 ms of other work. While it runs, the button
+// is pressed on a fixed schedule through the GPIO stand-in and a web
+// client keeps asking for the state, and the test times how long each
+// press takes to reach its callback and each request its reply. Requests
+// that arrive during a blocking step are delivered after it, as the TCP
+// stack would. The
+// servers answer after a delay, so the fetch spans many passes. The
+// canned servers take short TLS records, so all three connections fit
+// the stand-in heap at once and stay open. A server that refuses them
+// needs the full buffer, which there is only room for one at a time.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <ESPAsyncWebServer.h>
+
+// What ApiHandler needs from the display
+class DisplayHandler {
+public:
+    int errors = 0;
+    void showCoinSplash(const char*) {}
+    void showError(const char*, const char*) {
+        errors++;
+    }
+};
+
+#include "api_handler.h"
+#include "button_handler.h"
+#include "websocket_handler.h"
+
+#define HANDSHAKE_MS 300
+#define LATENCY_MS 800
+#define HEAP_BYTES 40000
+#define PRESS_EVERY_MS 500     // A release and the next press inside one blocking step
+#define PRESS_MS 150            // would read as one long press
+#define REQUEST_EVERY_MS 300
+#define DEBOUNCE_MS 50          // ButtonHandler's debounceDelay
+
+// Only a handshake blocks, so a handler waits at most one of those on
+// top of its own delay
+#define PRESS_LATENCY_BOUND (DEBOUNCE_MS + HANDSHAKE_MS + 2)
+#define REPLY_LATENCY_BOUND (WS_CLIENT_INTERVAL + HANDSHAKE_MS + 2)
+
+static Price updated;
+static int updates = 0;
+
+static void onUpdate(const Price& price, float) {
+    updated = price;
+    updates++;
+}
+
+static int records = 0;
+
+static void onRecord(const char*, const Price&, float) {
+    records++;
+}
+
+static unsigned long shortPresses = 0;
+
+static void onShortPress() {
+    shortPresses++;
+}
+
+static HostServer& serve(const char* host, const char* response) {
+    HostServer& server = hostServers()[host];
+    server.handshakeMs = HANDSHAKE_MS;
+    server.latencyMs = LATENCY_MS;
+    server.response = loadResponse(response);
+    return server;
+}
+
+static void serveCanned() {
+    hostServers().clear();
+    HostHeap::freeBytes() = HEAP_BYTES;
+    serve("api.gemini.com", "gemini_pricefeed.http");
+    serve("api.coinbase.com", "coinbase_spot.http");
+    serve("www.bitstamp.net", "bitstamp_ticker.http");
+}
+
+static std::string replaced(std::string text, const std::string& from, const std::string& to) {
+    size_t at = text.find(from);
+    if (at != std::string::npos) text.replace(at, from.size(), to);
+    return text;
+}
+
+struct LoopTrace {
+    unsigned long passes = 0;
+    unsigned long released = 0;             // Presses that ended while the loop ran
+    unsigned long presses = 0;              // Short presses ButtonHandler reported
+    unsigned long maxPressLatencyMs = 0;    // Release to callback
+    unsigned long requests = 0;             // State requests from the web client
+    unsigned long replies = 0;
+    unsigned long maxReplyLatencyMs = 0;    // Request arriving to the reply leaving
+    unsigned long wallMs = 0;
+};
+
+// Button and websocket handlers next to the fetch, as in the sketch
+struct LoopHandlers {
+    TickerStateStore ticker;
+    AsyncWebServer server;
+    ButtonHandler button;
+    WebSocketHandler webSocket;
+    AsyncWebSocketClient* client;
+
+    LoopHandlers() : ticker("DOGE", "USD"), server(80) {
+        HostGpio::get().reset();
+        button.begin();
+        button.setCallbacks(onShortPress);
+        webSocket.begin(&server, &ticker);
+        client = server.hostSocket("/ws")->hostConnect();
+    }
+};
+
+// Runs loop passes until the fetch is done or the time is up
+static LoopTrace runLoop(ApiHandler& api, unsigned long limitMs) {
+    LoopTrace trace;
+    LoopHandlers handlers;
+    unsigned long start = millis();
+    std::vector<unsigned long> releases;
+    for (unsigned long at = start + PRESS_EVERY_MS / 2; at < start + limitMs; at += PRESS_EVERY_MS) {
+        HostGpio::get().schedule(BUTTON_PIN, LOW, at);
+        HostGpio::get().schedule(BUTTON_PIN, HIGH, at + PRESS_MS);
+        releases.push_back(at + PRESS_MS);
+    }
+
+    AsyncWebSocket* socket = handlers.server.hostSocket("/ws");
+    shortPresses = 0;
+    unsigned long requestAt = start;
+    bool waiting = false;
+    size_t frames = 0;
+    while (api.isBusy() && millis() - start < limitMs) {
+        if (!waiting && (long)(millis() - requestAt) >= 0) {
+            socket->hostReceive(handlers.client, "getCurrentStates", sizeof("getCurrentStates"), false);
+            waiting = true;
+            trace.requests++;
+        }
+
+        unsigned long before = shortPresses;
+        handlers.button.handle();
+        if (shortPresses > before) {
+            trace.maxPressLatencyMs = max(trace.maxPressLatencyMs, millis() - releases[trace.presses]);
+            trace.presses = shortPresses;
+        }
+
+        handlers.webSocket.handle();
+        if (handlers.client->sent.size() > frames) {
+            frames = handlers.client->sent.size();
+            trace.replies++;
+            trace.maxReplyLatencyMs = max(trace.maxReplyLatencyMs, millis() - requestAt);
+            requestAt += REQUEST_EVERY_MS * ((millis() - requestAt) / REQUEST_EVERY_MS + 1);
+            waiting = false;
+        }
+
+        api.handle();
+        delay(1);
+        trace.passes++;
+    }
+    trace.wallMs = millis() - start;
+    for (unsigned long at : releases) {
+        if (at < millis()) trace.released++;
+    }
+    HostGpio::get().reset();
+    return trace;
+}
+
+// Every press that had time to be seen was seen, and nothing else
+static void checkServiced(const LoopTrace& trace) {
+    CHECK(trace.presses <= trace.released);
+    CHECK(trace.presses + 1 >= trace.released);
+    CHECK(trace.maxPressLatencyMs <= PRESS_LATENCY_BOUND);
+    CHECK(trace.replies + 1 >= trace.requests);
+    CHECK(trace.maxReplyLatencyMs <= REPLY_LATENCY_BOUND);
+}
+
+TEST(handlersRunWhileFetching) {
+    serveCanned();
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+    api.setUpdateCallback(onUpdate);
+    updates = 0;
+
+    CHECK(api.fetchPrice("DOGE", "USD"));
+    LoopTrace trace = runLoop(api, 10000);
+
+    CHECK(!api.isBusy());
+    CHECK_EQ(updates, 1);
+    CHECK_EQ(display.errors, 0);
+
+    // The server's wait is spent in loop passes, not inside handle()
+    CHECK(trace.passes >= LATENCY_MS);
+    printf("  %lu presses in %lu ms, press latency max %lu ms, %lu replies, reply latency max %lu ms\n",
+           trace.presses, trace.wallMs, trace.maxPressLatencyMs, trace.replies, trace.maxReplyLatencyMs);
+    CHECK(trace.presses >= trace.wallMs / PRESS_EVERY_MS - 1);
+    CHECK(trace.replies >= trace.wallMs / (REQUEST_EVERY_MS + REPLY_LATENCY_BOUND));
+    checkServiced(trace);
+
+    // Only connecting blocks, one handshake per pass
+    CHECK(api.getMaxStepMicros() <= HANDSHAKE_MS * 1000UL);
+}
+
+TEST(fullBuffersTakeTurns) {
+    serveCanned();
+    hostServers()["api.coinbase.com"].shortRecords = false;
+    hostServers()["www.bitstamp.net"].shortRecords = false;
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+
+    // The third source waited for the second's buffer instead of failing
+    CHECK_EQ(display.errors, 0);
+    for (int i = 0; i < api.getSourceCount(); i++) {
+        CHECK_EQ(api.getSourceStats(i).ok, 1);
+    }
+
+    // Only Gemini's short buffer connection is kept
+    CHECK_EQ(HostHeap::freeBytes(), HEAP_BYTES - (API_SSL_BUFFER + 512 + HOST_TLS_CONTEXT));
+}
+
+TEST(shortBuffersStayOpen) {
+    serveCanned();
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(display.errors, 0);
+    CHECK_EQ(HostHeap::freeBytes(), HEAP_BYTES - API_SOURCE_COUNT * (API_SSL_BUFFER + 512 + HOST_TLS_CONTEXT));
+}
+
+TEST(keepAliveSkipsHandshake) {
+    serveCanned();
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+    api.setUpdateCallback(onUpdate);
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    api.fetchPrice("DOGE", "USD");
+    LoopTrace trace = runLoop(api, 10000);
+
+    CHECK(!api.isBusy());
+    checkServiced(trace);
+    for (auto& server : hostServers()) {
+        CHECK_EQ(server.second.connects, 1);
+    }
+    CHECK_EQ(api.getReusedCount(), API_SOURCE_COUNT);
+}
+
+TEST(sourcesOverlap) {
+    serveCanned();
+    hostServers()["www.bitstamp.net"].latencyMs = 2 * LATENCY_MS;
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "USD");
+    LoopTrace trace = runLoop(api, 10000);
+
+    // The fetch takes about as long as its slowest source, not as long
+    // as asking them one after another
+    unsigned long slowest = 0;
+    for (int i = 0; i < api.getSourceCount(); i++) {
+        slowest = max(slowest, api.getSourceStats(i).lastMs);
+    }
+    unsigned long sequential = 0;
+    for (auto& server : hostServers()) {
+        sequential += server.second.handshakeMs + server.second.latencyMs;
+    }
+    CHECK_EQ(display.errors, 0);
+    CHECK(trace.wallMs <= slowest + 2);
+    CHECK(trace.wallMs < sequential * 2 / 3);
+}
+
+TEST(shortRecordsFallBack) {
+    serveCanned();
+    hostServers()["api.gemini.com"].shortRecords = false;
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(display.errors, 0);
+    CHECK_EQ(api.getSourceStats(0).ok, 1);
+    CHECK_EQ(hostServers()["api.gemini.com"].connects, 2);
+
+    // Remembered, so the next fetch connects once
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(hostServers()["api.gemini.com"].connects, 3);
+}
+
+TEST(feedCompletesWithoutPair) {
+    serveCanned();
+    const char* notFound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    hostServers()["api.coinbase.com"].response = notFound;
+    hostServers()["www.bitstamp.net"].response = notFound;
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("SHIB", "USD");
+    ApiHandler api(&display, &ticker);
+    api.setBatchMode(onRecord);
+    records = 0;
+
+    api.fetchPrice("SHIB", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(display.errors, 1);
+    CHECK_EQ(records, 4);
+    CHECK(api.isFeedComplete());
+}
+
+TEST(outlierIsOutvoted) {
+    serveCanned();
+    HostServer& coinbase = hostServers()["api.coinbase.com"];
+    coinbase.response = replaced(coinbase.response, "0.07131", "0.08131");
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+    api.setUpdateCallback(onUpdate);
+    updates = 0;
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(updates, 1);
+    CHECK_EQ(api.getSourceStats(1).outliers, 1);
+    Price gemini;
+    gemini.parse("0.07123");
+    CHECK(updated == gemini);
+}
+
+TEST(unlistedPairSkipsSource) {
+    serveCanned();
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "SGD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "SGD");
+    runLoop(api, 10000);
+    CHECK_EQ(hostServers()["www.bitstamp.net"].requests, 0);
+    CHECK_EQ(api.getSourceStats(2).failed, 0);
+}
+
+TEST(twoDisagreeingSourcesFail) {
+    serveCanned();
+    hostServers()["www.bitstamp.net"].reachable = false;
+    HostServer& coinbase = hostServers()["api.coinbase.com"];
+    coinbase.response = replaced(coinbase.response, "0.07131", "0.08131");
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+    api.setUpdateCallback(onUpdate);
+    updates = 0;
+
+    api.fetchPrice("DOGE", "USD");
+    runLoop(api, 10000);
+    CHECK_EQ(updates, 0);
+    CHECK_EQ(display.errors, 1);
+    CHECK_EQ(api.getSourceStats(0).outliers, 1);
+    CHECK_EQ(api.getSourceStats(1).outliers, 1);
+}
+
+TEST(timeoutEndsFetch) {
+    serveCanned();
+    for (auto& server : hostServers()) server.second.latencyMs = API_TIMEOUT * 2;
+    HostClock::set(0);
+    DisplayHandler display;
+    TickerStateStore ticker("DOGE", "USD");
+    ApiHandler api(&display, &ticker);
+
+    api.fetchPrice("DOGE", "USD");
+    LoopTrace trace = runLoop(api, API_TIMEOUT * 4);
+    CHECK(!api.isBusy());
+    CHECK_EQ(display.errors, 1);
+    checkServiced(trace);
+    CHECK(api.getTimeoutCount() >= 1);
+}
+
+HOST_TEST_MAIN()
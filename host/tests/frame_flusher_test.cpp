@@ -0,0 +1,117 @@
+// FrameFlusher against the mock I2C bus. The bus traffic is replayed
+// into a model of the SSD1306's RAM, which has to match the framebuffer
+// after every flush, and a price tick has to cost a small part of a
+// full frame.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include "frame_flusher.h"
+
+struct Rig {
+    TwoWire wire;
+    Adafruit_SSD1306 display{128, 32, &wire, -1};
+    FrameFlusher flusher{&display, &wire, 0x3C};
+    Ssd1306Model model;
+
+    // Flushes and returns the bytes that went over the bus
+    size_t flush() {
+        wire.clear();
+        flusher.flush();
+        model.apply(wire);
+        return wire.busBytes();
+    }
+
+    bool inSync() {
+        return memcmp(model.ram, display.getBuffer(), FRAME_BYTES) == 0;
+    }
+};
+
+static void fillRect(Adafruit_SSD1306& display, int x, int y, int w, int h, uint16_t color) {
+    for (int row = y; row < y + h; row++) {
+        for (int col = x; col < x + w; col++) display.drawPixel(col, row, color);
+    }
+}
+
+// Stand-in for the last two price digits changing: a checker pattern
+// that shifts with the value
+static void drawDigits(Adafruit_SSD1306& display, int value) {
+    fillRect(display, 90, 8, 26, 16, BLACK);
+    for (int row = 8; row < 24; row++) {
+        for (int col = 90; col < 116; col++) {
+            if ((row + col + value) % 3 == 0) display.drawPixel(col, row, WHITE);
+        }
+    }
+}
+
+TEST(firstFlushSendsFullFrame) {
+    Rig rig;
+    fillRect(rig.display, 0, 0, 40, 32, WHITE);
+    size_t bytes = rig.flush();
+    CHECK(rig.inSync());
+    CHECK_EQ(bytes, rig.flusher.getLastFrameBytes());
+    CHECK(bytes >= FRAME_BYTES);
+}
+
+TEST(unchangedFrameSendsNothing) {
+    Rig rig;
+    rig.flush();
+    CHECK_EQ(rig.flush(), 0);
+    CHECK_EQ(rig.flusher.getLastFrameBytes(), 0);
+}
+
+TEST(priceTickSendsSmallPart) {
+    Rig rig;
+    fillRect(rig.display, 0, 0, 24, 24, WHITE);        // Logo
+    drawDigits(rig.display, 0);
+    size_t full = rig.flush();
+
+    for (int value = 1; value <= 20; value++) {
+        drawDigits(rig.display, value);
+        size_t bytes = rig.flush();
+        CHECK(rig.inSync());
+        CHECK_EQ(bytes, rig.flusher.getLastFrameBytes());
+        CHECK(bytes * 5 < full);
+    }
+    printf("  full frame %zu bytes, price tick %lu bytes\n", full, rig.flusher.getLastFrameBytes());
+}
+
+TEST(changesAtBothEdgesSendPageRange) {
+    Rig rig;
+    rig.flush();
+    rig.display.drawPixel(0, 0, WHITE);
+    rig.display.drawPixel(127, 0, WHITE);
+    size_t bytes = rig.flush();
+    CHECK(rig.inSync());
+    // Window command, then the 128 columns in two chunks
+    CHECK_EQ(bytes, 8 + FRAME_WIDTH + 2 * 2);
+}
+
+TEST(invalidateResendsFullFrame) {
+    Rig rig;
+    size_t full = rig.flush();
+    rig.flusher.invalidate();
+    CHECK_EQ(rig.flush(), full);
+}
+
+TEST(randomChangesStayInSync) {
+    Rig rig;
+    rig.flush();
+    srand(7);
+    for (int frame = 0; frame < 500; frame++) {
+        int changes = rand() % 6;
+        for (int i = 0; i < changes; i++) {
+            fillRect(rig.display, rand() % 128, rand() % 32, rand() % 20 + 1, rand() % 10 + 1, rand() % 2);
+        }
+        size_t bytes = rig.flush();
+        CHECK_EQ(bytes, rig.flusher.getLastFrameBytes());
+        if (!rig.inSync()) {
+            printf("  out of sync after frame %d\n", frame);
+            CHECK(false);
+            return;
+        }
+    }
+}
+
+HOST_TEST_MAIN()
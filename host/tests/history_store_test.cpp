@@ -0,0 +1,146 @@
+// HistoryStore on the file-backed LittleFS stand-in. A week of samples
+// every 30 s, flushed the way loop() does, then queried over an hour, a
+// day and the week. Prints the write amplification the flash model
+// charges for the appends and what each query costs, and checks that a
+// migration which runs out of room keeps the legacy file.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <chrono>
+#include "history_store.h"
+
+#define SAMPLE_MS 30000
+#define WEEK_SAMPLES (7 * 86400 / (SAMPLE_MS / 1000))
+#define START_DAY 19675UL               // 2023-11-14, epoch of the first sample
+#define START_TIME (START_DAY * HISTORY_SEGMENT_SECONDS)
+#define PAIR 3
+
+static void count(const HistoryRecord&, void* context) {
+    (*(size_t*)context)++;
+}
+
+struct QueryCost {
+    size_t records;
+    unsigned long long opens;
+    unsigned long long reads;
+    long long micros;
+};
+
+static QueryCost timeQuery(HistoryStore& store, uint32_t from, uint32_t to) {
+    HostFlash& flash = HostFlash::get();
+    QueryCost cost = {0, flash.opens, flash.readCalls, 0};
+    auto start = std::chrono::steady_clock::now();
+    store.query(PAIR, from, to, SIZE_MAX, count, &cost.records);
+    cost.micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    cost.opens = flash.opens - cost.opens;
+    cost.reads = flash.readCalls - cost.reads;
+    return cost;
+}
+
+static void report(const char* name, const QueryCost& cost) {
+    printf("  %-5s %6zu records, %5llu opens, %5llu reads, %6lld us\n",
+           name, cost.records, cost.opens, cost.reads, cost.micros);
+}
+
+static void fillWeek(HistoryStore& store) {
+    Price price;
+    price.parse("0.07123");
+    for (unsigned long i = 0; i < WEEK_SAMPLES; i++) {
+        store.append(PAIR, price, -0.0195f);
+        store.handle();
+        HostClock::advance(SAMPLE_MS);
+    }
+    store.flush();
+}
+
+TEST(weekOfSamples) {
+    HostFs::format();
+    HostClock::set(0);
+    HostClock::epoch() = START_TIME;
+    HistoryStore store;
+    CHECK(store.begin());
+    fillWeek(store);
+
+    HostFlash& flash = HostFlash::get();
+    CHECK_EQ(store.getRecordsWritten(), (unsigned long)WEEK_SAMPLES);
+    CHECK_EQ(flash.payloadBytes, (unsigned long long)WEEK_SAMPLES * sizeof(HistoryRecord));
+    printf("  %lu flushes, %llu bytes written, %llu programmed, %llu erases, amplification %.1f\n",
+           store.getFlushCount(), flash.payloadBytes, flash.programBytes, flash.erases,
+           flash.amplification());
+
+    // A flush every HISTORY_FLUSH_INTERVAL, not one per sample
+    CHECK(store.getFlushCount() <= WEEK_SAMPLES * (unsigned long)SAMPLE_MS / HISTORY_FLUSH_INTERVAL + 8);
+
+    // Each flush recopies the tail of a day file's last block, half a
+    // block on average, for 320 new bytes
+    CHECK(flash.amplification() >= 1.0);
+    CHECK(flash.amplification() < (HOST_FLASH_BLOCK / 2 + 2.0 * HOST_FLASH_PAGE) / 320 + 2);
+
+    uint32_t end = START_TIME + WEEK_SAMPLES * (SAMPLE_MS / 1000) - 1;
+    QueryCost hour = timeQuery(store, end - 3600 + 1, end);
+    QueryCost day = timeQuery(store, end - 86400 + 1, end);
+    QueryCost week = timeQuery(store, START_TIME, end);
+    report("hour", hour);
+    report("day", day);
+    report("week", week);
+    CHECK_EQ(hour.records, (size_t)120);
+    CHECK_EQ(day.records, (size_t)2880);
+    CHECK_EQ(week.records, (size_t)WEEK_SAMPLES);
+
+    // The binary search finds the hour without reading the whole day
+    CHECK(hour.reads < 20 + 120 / HISTORY_READ_BATCH);
+    CHECK(week.reads <= 7 * (20 + 2880 / HISTORY_READ_BATCH));
+}
+
+TEST(emptyRangeReadsNothing) {
+    HostFs::format();
+    HostClock::set(0);
+    HostClock::epoch() = START_TIME;
+    HistoryStore store;
+    CHECK(store.begin());
+    fillWeek(store);
+
+    QueryCost before = timeQuery(store, START_TIME - 86400, START_TIME - 1);
+    CHECK_EQ(before.records, (size_t)0);
+    CHECK_EQ(before.opens, 0ULL);
+}
+
+static uint8_t mapPair(uint8_t legacy) {
+    return legacy == 0 ? PAIR : HISTORY_NO_PAIR;
+}
+
+static void writeLegacy(size_t records) {
+    LittleFS.mkdir(HISTORY_LEGACY_DIR);
+    File file = LittleFS.open(HISTORY_LEGACY_DIR "/19675.bin", "w");
+    for (size_t i = 0; i < records; i++) {
+        HistoryRecord record = {7123, (uint32_t)(START_TIME + i * 30), -195, (uint8_t)(i % 2), 5};
+        file.write((const uint8_t*)&record, sizeof(record));
+    }
+    file.close();
+}
+
+TEST(migrationKeepsLegacyOnFullDisk) {
+    HostFs::format();
+    HostClock::set(0);
+    HostClock::epoch() = START_TIME;
+    writeLegacy(64);
+    HostFlash::get().capacity = HostFs::used() + 100;
+
+    HistoryStore store;
+    CHECK(store.begin(mapPair));
+    CHECK(LittleFS.exists(HISTORY_LEGACY_DIR "/19675.bin"));
+    CHECK(!LittleFS.exists(HISTORY_DIR "/19675.bin"));
+
+    // Moved at the next boot with room
+    HostFlash::get().capacity = ~0ULL;
+    HistoryStore next;
+    CHECK(next.begin(mapPair));
+    CHECK(!LittleFS.exists(HISTORY_LEGACY_DIR));
+    size_t records = 0;
+    next.query(PAIR, START_TIME, START_TIME + 86400, SIZE_MAX, count, &records);
+    CHECK_EQ(records, (size_t)32);
+}
+
+HOST_TEST_MAIN()
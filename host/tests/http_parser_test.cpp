@@ -0,0 +1,236 @@
+// HttpResponseParser on canned responses, fed whole, byte by byte and
+// split at every position.
+
+#include "host_test.h"
+#include "alloc_counter.h"
+#include <Arduino.h>
+#include "http_parser.h"
+
+struct Parsed {
+    HttpResponseParser http;
+    std::string body;
+};
+
+// Feeds the response in pieces of `step` bytes, the last one shorter
+static void parseInSteps(Parsed& out, const std::string& response, size_t step) {
+    out.http.reset();
+    out.body.clear();
+    std::string copy = response;
+    for (size_t pos = 0; pos < copy.size(); pos += step) {
+        size_t len = std::min(step, copy.size() - pos);
+        size_t bodyLen = out.http.feed(&copy[pos], len);
+        out.body.append(&copy[pos], bodyLen);
+    }
+}
+
+// Feeds the response split in two at `split`
+static void parseSplit(Parsed& out, const std::string& response, size_t split) {
+    out.http.reset();
+    out.body.clear();
+    std::string copy = response;
+    size_t bodyLen = out.http.feed(&copy[0], split);
+    out.body.append(&copy[0], bodyLen);
+    bodyLen = out.http.feed(&copy[split], copy.size() - split);
+    out.body.append(&copy[split], bodyLen);
+}
+
+static const char* feedBody =
+    "[{\"pair\":\"BTCUSD\",\"price\":\"67012.35\",\"percentChange24h\":\"0.0154\"},"
+    "{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\"},"
+    "{\"pair\":\"ETHUSD\",\"price\":\"3521.9\",\"percentChange24h\":\"0.0032\"},"
+    "{\"pair\":\"LTCUSD\",\"price\":\"84.17\",\"percentChange24h\":\"-0.0005\"}]";
+
+TEST(chunkedBodyWhole) {
+    Parsed parsed;
+    parseInSteps(parsed, loadResponse("gemini_pricefeed.http"), 4096);
+    CHECK(parsed.http.isComplete());
+    CHECK_EQ(parsed.http.statusCode(), 200);
+    CHECK(parsed.http.keepAlive());
+    CHECK_STR(parsed.body.c_str(), feedBody);
+}
+
+TEST(chunkedBodyEverySplit) {
+    std::string response = loadResponse("gemini_pricefeed.http");
+    Parsed parsed;
+    for (size_t split = 1; split < response.size(); split++) {
+        parseSplit(parsed, response, split);
+        if (!parsed.http.isComplete() || parsed.body != feedBody) {
+            printf("  split at %zu\n", split);
+            CHECK(false);
+            return;
+        }
+    }
+}
+
+TEST(chunkedBodyByteByByte) {
+    Parsed parsed;
+    parseInSteps(parsed, loadResponse("gemini_pricefeed.http"), 1);
+    CHECK(parsed.http.isComplete());
+    CHECK_STR(parsed.body.c_str(), feedBody);
+}
+
+TEST(chunkSizeLineSplitAcrossFeeds) {
+    // "1a;name=value\r\n" arrives in three pieces
+    std::string response =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "1a;name=value\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\n";
+    size_t sizeLine = response.find("1a;");
+    Parsed parsed;
+    parsed.http.reset();
+    std::string copy = response;
+    size_t cuts[] = {0, sizeLine + 1, sizeLine + 5, sizeLine + 14, copy.size()};
+    for (int i = 0; i + 1 < 5; i++) {
+        size_t len = cuts[i + 1] - cuts[i];
+        size_t bodyLen = parsed.http.feed(&copy[cuts[i]], len);
+        parsed.body.append(&copy[cuts[i]], bodyLen);
+    }
+    CHECK(parsed.http.isComplete());
+    CHECK_STR(parsed.body.c_str(), "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST(badChunkSizeIsError) {
+    std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    CHECK(parsed.http.hasError());
+}
+
+// A size that would wrap the counter must not turn into a small length
+TEST(oversizedChunkIsError) {
+    std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n10000000000000005\r\nabcde\r\n0\r\n\r\n";
+    Parsed parsed;
+    parseInSteps(parsed, response, 1);
+    CHECK(parsed.http.hasError());
+    CHECK(parsed.body.empty());
+}
+
+TEST(largestChunkSizeAccepted) {
+    char response[96];
+    snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n%x\r\nab", HTTP_MAX_BODY);
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    CHECK(!parsed.http.hasError());
+    CHECK_STR(parsed.body.c_str(), "ab");
+}
+
+TEST(badContentLengthIsError) {
+    const char* lengths[] = {"99999999999999999999", "-5", "12abc", "", "1048577"};
+    for (const char* length : lengths) {
+        std::string response = std::string("HTTP/1.1 200 OK\r\nContent-Length: ") + length + "\r\n\r\nabc";
+        Parsed parsed;
+        parseInSteps(parsed, response, 4096);
+        CHECK(parsed.http.hasError());
+        CHECK(parsed.body.empty());
+    }
+}
+
+TEST(contentLengthBody) {
+    std::string response = loadResponse("coinbase_spot.http");
+    Parsed parsed;
+    for (size_t split = 1; split < response.size(); split++) {
+        parseSplit(parsed, response, split);
+        CHECK(parsed.http.isComplete());
+    }
+    CHECK_STR(parsed.body.c_str(), "{\"data\":{\"amount\":\"0.07131\",\"base\":\"DOGE\",\"currency\":\"USD\"}}");
+    CHECK(parsed.http.keepAlive());
+    CHECK(!parsed.http.endsAtClose());
+}
+
+TEST(bytesPastContentLengthIgnored) {
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabcHTTP/1.1";
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    CHECK(parsed.http.isComplete());
+    CHECK_STR(parsed.body.c_str(), "abc");
+}
+
+TEST(connectionCloseBody) {
+    Parsed parsed;
+    parseInSteps(parsed, loadResponse("close_delimited.http"), 7);
+    CHECK(!parsed.http.isComplete());
+    CHECK(parsed.http.endsAtClose());
+    CHECK(!parsed.http.keepAlive());
+    CHECK_STR(parsed.body.c_str(), "[{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\"}]");
+}
+
+TEST(connectionCloseWithLength) {
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok";
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    CHECK(parsed.http.isComplete());
+    CHECK(!parsed.http.keepAlive());
+}
+
+static long retryAfterOf(const char* header) {
+    std::string response = std::string("HTTP/1.1 429 Too Many Requests\r\n") + header + "Content-Length: 0\r\n\r\n";
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    return parsed.http.retryAfterSeconds();
+}
+
+TEST(retryAfter) {
+    Parsed parsed;
+    parseInSteps(parsed, loadResponse("rate_limited.http"), 3);
+    CHECK_EQ(parsed.http.statusCode(), 429);
+    CHECK_EQ(parsed.http.retryAfterSeconds(), 30);
+
+    CHECK_EQ(retryAfterOf("Retry-After: 120\r\n"), 120);
+    CHECK_EQ(retryAfterOf("retry-after:  7  \r\n"), 7);
+    CHECK_EQ(retryAfterOf("Retry-After: 0\r\n"), 0);
+    CHECK_EQ(retryAfterOf(""), -1);
+    CHECK_EQ(retryAfterOf("Retry-After:\r\n"), -1);
+    CHECK_EQ(retryAfterOf("Retry-After: -5\r\n"), -1);
+    CHECK_EQ(retryAfterOf("Retry-After: Wed, 21 Oct 2015 07:28:00 GMT\r\n"), -1);
+}
+
+TEST(headerLongerThanLineBuffer) {
+    // Longer than HTTP_LINE_BUFFER: kept up to the buffer, the rest dropped
+    std::string cookie = "Set-Cookie: " + std::string(200, 'x') + "\r\n";
+    std::string longLength = "Content-Length: 5" + std::string(HTTP_LINE_BUFFER, ' ') + "\r\n";
+    std::string response = "HTTP/1.1 200 OK with a reason phrase much longer than the line buffer\r\n" +
+                           cookie + longLength + cookie + "\r\nhello";
+    CHECK(longLength.size() > HTTP_LINE_BUFFER);
+
+    Parsed parsed;
+    for (size_t step : {1, 5, 47, 48, 49, 4096}) {
+        parseInSteps(parsed, response, step);
+        CHECK_EQ(parsed.http.statusCode(), 200);
+        CHECK(parsed.http.isComplete());
+        CHECK_STR(parsed.body.c_str(), "hello");
+    }
+}
+
+TEST(headerNameCutByLineBuffer) {
+    // The header name itself starts past the buffer, so it is not seen
+    std::string response = "HTTP/1.1 200 OK\r\nX-" + std::string(HTTP_LINE_BUFFER, 'a') +
+                           ": 1\r\nContent-Length: 2\r\n\r\nok";
+    Parsed parsed;
+    parseInSteps(parsed, response, 4096);
+    CHECK(parsed.http.isComplete());
+    CHECK_STR(parsed.body.c_str(), "ok");
+}
+
+TEST(notHttpIsError) {
+    Parsed parsed;
+    parseInSteps(parsed, "SSH-2.0-OpenSSH\r\n", 4096);
+    CHECK(parsed.http.hasError());
+}
+
+TEST(feedDoesNotAllocate) {
+    std::string response = loadResponse("gemini_pricefeed.http");
+    static char buffer[1024];
+    HttpResponseParser http;
+    unsigned long before = allocationCount();
+    for (int i = 0; i < 100; i++) {
+        // feed() moves body bytes in place, so each pass gets a fresh copy
+        memcpy(buffer, response.data(), response.size());
+        http.reset();
+        for (size_t pos = 0; pos < response.size(); pos += 13) {
+            http.feed(buffer + pos, std::min((size_t)13, response.size() - pos));
+        }
+    }
+    CHECK_EQ(allocationCount() - before, 0);
+    CHECK(http.isComplete());
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,85 @@
+// Heap allocations and time per price response: the incremental parsers
+// against a stand-in for the old String path. The old path read each
+// header with readStringUntil(), the body into one String, and parsed it
+// with a DynamicJsonDocument, so the stand-in does the same with
+// std::string and a heap buffer of the document's size. Both run the
+// same record parser so only the buffering differs.
+
+#include "host_test.h"
+#include "alloc_counter.h"
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include "http_parser.h"
+#include "price_feed_parser.h"
+
+#define BENCH_RUNS 20000
+
+struct BenchResult {
+    double allocations;     // Per response
+    double nanoseconds;
+};
+
+static char scratch[1024];
+
+static void onRecord(const char*, const Price&, float) {}
+
+// Incremental path, as SourceClient reads it in API_READ_CHUNK pieces
+static void parseIncremental(const std::string& response, PriceFeedParser& feed) {
+    memcpy(scratch, response.data(), response.size());
+    HttpResponseParser http;
+    http.reset();
+    feed.begin("DOGEUSD", onRecord);
+    for (size_t pos = 0; pos < response.size(); pos += 128) {
+        size_t len = std::min((size_t)128, response.size() - pos);
+        size_t bodyLen = http.feed(scratch + pos, len);
+        feed.feed(scratch + pos, bodyLen);
+    }
+}
+
+// Old path stand-in: every line a String, the body one String, then a
+// document buffer on the heap
+static void parseBuffered(const std::string& response, PriceFeedParser& feed) {
+    size_t pos = 0;
+    for (;;) {
+        size_t end = response.find('\n', pos);
+        std::string line = response.substr(pos, end - pos);
+        pos = end + 1;
+        if (line == "\r") break;
+    }
+    std::string body;
+    while (pos < response.size()) body += response[pos++];
+    char* document = new char[body.size() * 2];
+    memcpy(document, body.data(), body.size());
+    feed.begin("DOGEUSD", onRecord);
+    feed.feed(document, body.size());
+    delete[] document;
+}
+
+template <typename Parse>
+static BenchResult run(const std::string& response, Parse parse) {
+    PriceFeedParser feed;
+    unsigned long before = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_RUNS; i++) parse(response, feed);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    BenchResult result;
+    result.allocations = (double)(allocationCount() - before) / BENCH_RUNS;
+    result.nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_RUNS;
+    return result;
+}
+
+TEST(allocationsPerResponse) {
+    // Unchunked, so the old path's framing handling is not an issue
+    std::string response = loadResponse("close_delimited.http");
+    BenchResult incremental = run(response, parseIncremental);
+    BenchResult buffered = run(response, parseBuffered);
+
+    printf("{\"case\":\"incremental\",\"allocs\":%.1f,\"ns\":%.0f}\n", incremental.allocations, incremental.nanoseconds);
+    printf("{\"case\":\"string_stand_in\",\"allocs\":%.1f,\"ns\":%.0f}\n", buffered.allocations, buffered.nanoseconds);
+
+    CHECK(incremental.allocations == 0);
+    CHECK(buffered.allocations > 0);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,237 @@
+// PollScheduler replaying a synthetic trace: a flat price, a volatile
+// stretch, an outage and a recovery, fetching whenever the scheduler
+// says. Checks the interval bounds, the backoff growth and jitter, and
+// what a pair change keeps. Then the price trace in
+// host/responses/doge_usd_4h.csv, adaptive against a fixed 30 s
+// schedule: fetches per hour and how long the shown price lags a 0.1%
+// move.
+
+#include "host_test.h"
+#include "poll_scheduler.h"
+
+#define FLAT_UNTIL 1200000UL        // Phases of the trace (ms)
+#define VOLATILE_UNTIL 2400000UL
+#define OUTAGE_UNTIL 3000000UL
+#define TRACE_END 4200000UL
+
+#define FIXED_INTERVAL 30000UL
+
+enum Phase { FLAT, VOLATILE, OUTAGE, RECOVERY };
+
+struct Fetch {
+    uint32_t at;
+    Phase phase;
+    uint32_t interval;
+    PollReason reason;
+};
+
+static Phase phaseAt(uint32_t t) {
+    if (t < FLAT_UNTIL) return FLAT;
+    if (t < VOLATILE_UNTIL) return VOLATILE;
+    if (t < OUTAGE_UNTIL) return OUTAGE;
+    return RECOVERY;
+}
+
+// Same sequence every run
+static float nextRandom() {
+    static uint32_t state = 12345;
+    state = state * 1103515245 + 12345;
+    return (state >> 8) / 16777216.0f;
+}
+
+static std::vector<Fetch> replay(PollScheduler& scheduler) {
+    std::vector<Fetch> fetches;
+    uint32_t t = 0;
+    int swing = 0;
+    while (t < TRACE_END) {
+        Phase phase = phaseAt(t);
+        if (phase == OUTAGE) {
+            scheduler.onUnreachable(nextRandom());
+        } else {
+            // Swings 1% every fetch while volatile
+            double price = phase == VOLATILE && (swing++ % 2) ? 0.0707 : 0.0700;
+            scheduler.onPrice(price, t);
+        }
+        fetches.push_back({t, phase, scheduler.getInterval(), scheduler.getReason()});
+        t += scheduler.getInterval();
+    }
+    return fetches;
+}
+
+TEST(intervalsStayInBounds) {
+    PollScheduler scheduler;
+    for (const Fetch& fetch : replay(scheduler)) {
+        CHECK(fetch.interval >= POLL_DEFAULT_MIN);
+        CHECK(fetch.interval <= POLL_DEFAULT_MAX);
+    }
+}
+
+TEST(flatPriceStretchesVolatileShortens) {
+    PollScheduler scheduler;
+    std::vector<Fetch> fetches = replay(scheduler);
+    const Fetch* lastFlat = nullptr;
+    const Fetch* lastVolatile = nullptr;
+    for (const Fetch& fetch : fetches) {
+        if (fetch.phase == FLAT) lastFlat = &fetch;
+        if (fetch.phase == VOLATILE) lastVolatile = &fetch;
+    }
+    CHECK(lastFlat != nullptr && lastVolatile != nullptr);
+    CHECK_EQ(lastFlat->interval, POLL_DEFAULT_MAX);
+    CHECK_EQ(lastFlat->reason, POLL_ADAPTIVE);
+    CHECK_EQ(lastVolatile->interval, POLL_DEFAULT_MIN);
+}
+
+TEST(outageBacksOffWithJitter) {
+    PollScheduler scheduler;
+    int failures = 0;
+    bool recovered = false;
+    for (const Fetch& fetch : replay(scheduler)) {
+        if (fetch.phase == OUTAGE) {
+            failures++;
+            CHECK_EQ(fetch.reason, POLL_BACKOFF);
+            double nominal = (double)POLL_DEFAULT_MIN * (1UL << std::min(failures, POLL_MAX_DOUBLINGS));
+            double low = std::min(nominal * (1 - POLL_JITTER), (double)POLL_DEFAULT_MAX);
+            double high = std::min(nominal * (1 + POLL_JITTER), (double)POLL_DEFAULT_MAX);
+            CHECK(fetch.interval >= (uint32_t)low);
+            CHECK(fetch.interval <= (uint32_t)high);
+        } else if (fetch.phase == RECOVERY && !recovered) {
+            // The first price after the outage ends the backoff
+            recovered = true;
+            CHECK_EQ(fetch.reason, POLL_ADAPTIVE);
+        }
+    }
+    CHECK(failures >= 2);
+    CHECK(recovered);
+}
+
+TEST(retryAfterIsAMinimum) {
+    PollScheduler scheduler;
+    for (int i = 0; i < 8; i++) {
+        float random01 = i / 8.0f;
+        uint32_t interval = scheduler.onRateLimited(60000, random01);
+        CHECK(interval >= 60000);
+        CHECK(interval <= 60000 * (1 + POLL_JITTER));
+        CHECK_EQ(scheduler.getReason(), POLL_RETRY_AFTER);
+    }
+}
+
+TEST(pairChangeKeepsInterval) {
+    PollScheduler scheduler;
+    scheduler.onPrice(0.0700, 0);
+    scheduler.onPrice(0.0700, 30000);
+    CHECK_EQ(scheduler.getInterval(), POLL_DEFAULT_MAX);
+
+    scheduler.resetBackoff();
+    CHECK_EQ(scheduler.getInterval(), POLL_DEFAULT_MAX);
+    CHECK_EQ(scheduler.getReason(), POLL_ADAPTIVE);
+
+    // The new pair's first price is not a move from the old pair's
+    scheduler.onPrice(64000.0, 60000);
+    CHECK_EQ(scheduler.getInterval(), POLL_DEFAULT_MAX);
+}
+
+TEST(pairChangeRestartsBackoff) {
+    PollScheduler scheduler;
+    for (int i = 0; i < 4; i++) scheduler.onUnreachable(0.5f);
+    scheduler.resetBackoff();
+    CHECK_EQ(scheduler.onUnreachable(0.5f), POLL_DEFAULT_MIN * 2);
+}
+
+struct TracePoint {
+    uint32_t at;                // ms from the first sample
+    double price;
+};
+
+// "unix_seconds,price" lines, # starts a comment
+static std::vector<TracePoint> loadTrace(const char* name) {
+    std::vector<TracePoint> trace;
+    std::string text = loadResponse(name);
+    unsigned long first = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        unsigned long seconds;
+        double price;
+        if (line.empty() || line[0] == '#' || sscanf(line.c_str(), "%lu,%lf", &seconds, &price) != 2) continue;
+        if (trace.empty()) first = seconds;
+        trace.push_back({(uint32_t)((seconds - first) * 1000), price});
+    }
+    return trace;
+}
+
+struct TraceRun {
+    unsigned long fetches = 0;
+    double hours = 0;
+    unsigned long lags = 0;     // Moves of POLL_TARGET_MOVE the display caught up with
+    double lagTotalMs = 0;
+    uint32_t lagMaxMs = 0;
+
+    double perHour() const { return fetches / hours; }
+    double meanLag() const { return lags > 0 ? lagTotalMs / lags : 0; }
+};
+
+// Fetches when schedule(price, now) says, each seeing the newest sample.
+// A lag runs from the sample that first moved POLL_TARGET_MOVE away from
+// the shown price to the fetch that shows it.
+template <typename Schedule>
+static TraceRun replayTrace(const std::vector<TracePoint>& trace, Schedule schedule) {
+    TraceRun run;
+    double shown = 0;
+    uint32_t next = 0;
+    bool behind = false;
+    uint32_t behindSince = 0;
+
+    auto fetch = [&](double price, uint32_t now) {
+        run.fetches++;
+        shown = price;
+        if (behind) {
+            uint32_t lag = now - behindSince;
+            run.lags++;
+            run.lagTotalMs += lag;
+            if (lag > run.lagMaxMs) run.lagMaxMs = lag;
+            behind = false;
+        }
+        next = now + schedule(price, now);
+    };
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        while (i > 0 && next < trace[i].at) fetch(trace[i - 1].price, next);
+        if (next == trace[i].at) fetch(trace[i].price, next);
+        if (!behind && fabs(trace[i].price - shown) / shown >= POLL_TARGET_MOVE) {
+            behind = true;
+            behindSince = trace[i].at;
+        }
+    }
+    run.hours = trace.back().at / 3600000.0;
+    return run;
+}
+
+static void printRun(const char* name, const TraceRun& run) {
+    printf("  %-8s %5.1f fetches/h, %3lu moves, lag mean %5.1f s, max %5.1f s\n", name, run.perHour(), run.lags,
+           run.meanLag() / 1000, run.lagMaxMs / 1000.0);
+}
+
+TEST(priceTraceAgainstFixedSchedule) {
+    std::vector<TracePoint> trace = loadTrace("doge_usd_4h.csv");
+    CHECK(trace.size() > 1000);
+    if (trace.size() < 2) return;
+
+    TraceRun fixed = replayTrace(trace, [](double price, uint32_t now) -> uint32_t { return FIXED_INTERVAL; });
+    PollScheduler scheduler;
+    TraceRun adaptive = replayTrace(trace, [&](double price, uint32_t now) { return scheduler.onPrice(price, now); });
+    printRun("fixed", fixed);
+    printRun("adaptive", adaptive);
+
+    CHECK(fixed.perHour() > 119 && fixed.perHour() < 121);
+    // Fewer fetches over the quiet hours, and since the minimum is the
+    // old fixed interval, no move waits longer than a maximum interval
+    CHECK(adaptive.perHour() < fixed.perHour() * 0.8);
+    CHECK(adaptive.lagMaxMs <= POLL_DEFAULT_MAX);
+    CHECK(adaptive.meanLag() < fixed.meanLag() * 2);
+}
+
+HOST_TEST_MAIN()
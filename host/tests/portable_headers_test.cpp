@@ -0,0 +1,53 @@
+// The Arduino-free headers build on a desktop compiler and work
+// against the virtual clock and the canned responses.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "http_parser.h"
+#include "price.h"
+#include "price_aggregator.h"
+#include "poll_scheduler.h"
+#include "price_table.h"
+
+TEST(cannedResponseParses) {
+    std::string response = loadResponse("rate_limited.http");
+    HttpResponseParser http;
+    http.reset();
+    size_t bodyLen = http.feed(&response[0], response.size());
+    CHECK_EQ(bodyLen, 0);
+    CHECK(http.isComplete());
+    CHECK_EQ(http.statusCode(), 429);
+    CHECK_EQ(http.retryAfterSeconds(), 30);
+}
+
+TEST(priceRoundTrips) {
+    Price price;
+    CHECK(price.parse("0.07123"));
+    char text[16];
+    price.format(text, sizeof(text), 8, sizeof(text));
+    CHECK_STR(text, "0.07123");
+}
+
+TEST(priceTableAgesEntries) {
+    HostClock::set(1000);
+    PriceTable<COIN_COUNT, FIAT_COUNT> table;
+    Price price;
+    price.parse("0.07123");
+    table.store(COIN_DOGE, FIAT_USD, price, -0.02f);
+    delay(45000);
+
+    Price cached;
+    float change;
+    unsigned long age;
+    CHECK(table.peek(COIN_DOGE, FIAT_USD, cached, change, age));
+    CHECK(cached == price);
+    CHECK_EQ(age, 45000);
+}
+
+TEST(schedulerStartsAtMinimum) {
+    PollScheduler scheduler;
+    CHECK_EQ(scheduler.getInterval(), POLL_DEFAULT_MIN);
+    CHECK_EQ(scheduler.getReason(), POLL_START);
+}
+
+HOST_TEST_MAIN()
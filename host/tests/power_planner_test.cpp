@@ -0,0 +1,217 @@
+// PowerPlanner's choice of nap and sleep mode, PowerStats' duty cycle
+// and energy, and PowerScheduler cutting a nap short for a button press
+// made through the GPIO stand-in.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "power_policy.h"
+#include "power_scheduler.h"
+
+#define NOW 1000UL
+
+static bool near(float a, float b) {
+    return a > b - 0.001f && a < b + 0.001f;
+}
+
+TEST(idleNapsToMaxInLightSleep) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    PowerDecision decision = planner.decide();
+    CHECK_EQ(decision.mode, POWER_LIGHT_SLEEP);
+    CHECK_EQ(decision.napMs, POWER_MAX_NAP);
+}
+
+TEST(earliestWakeWins) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + 600);
+    planner.wakeBy(NOW + 250);
+    planner.wakeBy(NOW + 900);
+    CHECK_EQ(planner.decide().napMs, 250);
+}
+
+TEST(plannerFollowsVirtualClock) {
+    HostClock::set(NOW);
+    PowerPlanner planner;
+    planner.begin(millis());
+    planner.wakeBy(millis() + 250);
+    CHECK_EQ(planner.decide().napMs, 250);
+
+    // Due now, and overdue, both mean no nap
+    delay(250);
+    planner.begin(millis());
+    planner.wakeBy(NOW + 250);
+    CHECK_EQ(planner.decide().napMs, 0);
+    planner.wakeBy(NOW);
+    CHECK_EQ(planner.decide().napMs, 0);
+}
+
+TEST(stayAwakeNeverNaps) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + 500);
+    planner.stayAwake();
+    PowerDecision decision = planner.decide();
+    CHECK_EQ(decision.napMs, 0);
+    // The radio may still sleep between beacons
+    CHECK(decision.mode != POWER_AWAKE);
+}
+
+TEST(keepRadioHoldsRadioAwake) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + 500);
+    planner.keepRadio();
+    PowerDecision decision = planner.decide();
+    CHECK_EQ(decision.mode, POWER_AWAKE);
+    CHECK_EQ(decision.napMs, 0);
+
+    // Whatever else the pass asks for
+    planner.noLightSleep();
+    planner.serving();
+    CHECK_EQ(planner.decide().mode, POWER_AWAKE);
+}
+
+TEST(noLightSleepFallsBackToModem) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + 300);
+    planner.noLightSleep();
+    PowerDecision decision = planner.decide();
+    CHECK_EQ(decision.mode, POWER_MODEM_SLEEP);
+    CHECK_EQ(decision.napMs, 300);
+
+    // Only for the pass that asked
+    planner.begin(NOW);
+    CHECK_EQ(planner.decide().mode, POWER_LIGHT_SLEEP);
+}
+
+TEST(servingCapsNaps) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + POWER_MAX_NAP);
+    planner.serving();
+    CHECK_EQ(planner.decide().napMs, POWER_SERVING_NAP);
+
+    // A sooner wake is kept
+    planner.begin(NOW);
+    planner.wakeBy(NOW + 40);
+    planner.serving();
+    CHECK_EQ(planner.decide().napMs, 40);
+}
+
+TEST(shortGapsStayAwake) {
+    PowerPlanner planner;
+    planner.begin(NOW);
+    planner.wakeBy(NOW + POWER_MIN_NAP - 1);
+    CHECK_EQ(planner.decide().napMs, 0);
+
+    planner.begin(NOW);
+    planner.wakeBy(NOW + POWER_MIN_NAP);
+    CHECK_EQ(planner.decide().napMs, POWER_MIN_NAP);
+}
+
+TEST(wakeByAcrossMillisWrap) {
+    uint32_t now = UINT32_MAX - 100;
+    PowerPlanner planner;
+    planner.begin(now);
+    planner.wakeBy(now + 300);
+    CHECK_EQ(planner.decide().napMs, 300);
+
+    // Before and after the wrap, the one before is sooner
+    planner.begin(now);
+    planner.wakeBy(150);
+    planner.wakeBy(UINT32_MAX - 50);
+    CHECK_EQ(planner.decide().napMs, 50);
+
+    // Just before the wrap, seen after it, is overdue
+    planner.begin(100);
+    planner.wakeBy(UINT32_MAX - 10);
+    CHECK_EQ(planner.decide().napMs, 0);
+}
+
+TEST(statsDutyCycle) {
+    PowerStats stats;
+    CHECK(near(stats.getDutyCycle(), 1.0f));
+    CHECK(near(stats.getMilliwattHoursPerHour(), 0.0f));
+
+    stats.addBusy(POWER_MODEM_SLEEP, 100);
+    stats.addNap(POWER_MODEM_SLEEP, 300);
+    stats.addBusy(POWER_LIGHT_SLEEP, 100);
+    stats.addNap(POWER_LIGHT_SLEEP, 500);
+    CHECK_EQ(stats.getTotalMs(), 1000);
+    CHECK_EQ(stats.getNapMs(POWER_LIGHT_SLEEP), 500);
+    CHECK(near(stats.getDutyCycle(), 0.2f));
+
+    stats.reset();
+    CHECK_EQ(stats.getTotalMs(), 0);
+}
+
+TEST(statsEnergy) {
+    PowerStats awake;
+    awake.addBusy(POWER_AWAKE, 3600000);
+    CHECK(near(awake.getMilliwattHoursPerHour(), POWER_AWAKE_MA * POWER_VOLTAGE));
+
+    // Running in light sleep mode draws like modem sleep, only the naps
+    // reach light sleep
+    PowerStats light;
+    light.addBusy(POWER_LIGHT_SLEEP, 100);
+    light.addNap(POWER_LIGHT_SLEEP, 900);
+    CHECK(near(light.getMilliwattHoursPerHour(), (0.1f * POWER_MODEM_MA + 0.9f * POWER_LIGHT_MA) * POWER_VOLTAGE));
+
+    PowerStats modem;
+    modem.addBusy(POWER_MODEM_SLEEP, 100);
+    modem.addNap(POWER_MODEM_SLEEP, 900);
+    CHECK(near(modem.getMilliwattHoursPerHour(), POWER_MODEM_MA * POWER_VOLTAGE));
+    CHECK(light.getMilliwattHoursPerHour() < modem.getMilliwattHoursPerHour());
+}
+
+TEST(pressEndsModemNap) {
+    HostGpio::get().reset();
+    HostClock::set(NOW);
+    ButtonHandler button;
+    button.begin();
+    PowerScheduler power(&button);
+    power.begin();
+
+    power.plan(millis()).noLightSleep();
+    HostGpio::get().schedule(BUTTON_PIN, LOW, NOW + 300);
+    power.sleep();
+    CHECK_EQ(millis(), NOW + 300);
+    CHECK_EQ(power.getMode(), POWER_MODEM_SLEEP);
+    CHECK_EQ(WiFi.sleepMode, WIFI_MODEM_SLEEP);
+    CHECK_EQ(power.getStats().getNapMs(POWER_MODEM_SLEEP), 300);
+
+    // A pending edge skips the next nap
+    power.plan(millis()).noLightSleep();
+    power.sleep();
+    CHECK_EQ(millis(), NOW + 300);
+
+    HostGpio::get().schedule(BUTTON_PIN, HIGH, NOW + 400);
+    delay(100);
+    button.handle();
+    HostGpio::get().reset();
+}
+
+TEST(pressEndsLightNapWithinPoll) {
+    HostGpio::get().reset();
+    HostClock::set(NOW);
+    ButtonHandler button;
+    button.begin();
+    PowerScheduler power(&button);
+    power.begin();
+
+    power.plan(millis());
+    HostGpio::get().schedule(BUTTON_PIN, LOW, NOW + 330);
+    power.sleep();
+    CHECK_EQ(power.getMode(), POWER_LIGHT_SLEEP);
+    CHECK_EQ(WiFi.sleepMode, WIFI_LIGHT_SLEEP);
+    CHECK(millis() >= NOW + 330);
+    CHECK(millis() <= NOW + 330 + POWER_BUTTON_POLL);
+
+    // The interrupt is back for the next pass
+    CHECK(HostGpio::get().isr[BUTTON_PIN] != nullptr);
+    HostGpio::get().reset();
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,98 @@
+// PriceAggregator with one to four quotes: the median, outliers, the
+// two-source disagreement rule and where the 24h change comes from.
+
+#include "host_test.h"
+#include "price_aggregator.h"
+
+static Price price(const char* text) {
+    Price parsed;
+    parsed.parse(text);
+    return parsed;
+}
+
+TEST(noQuotesNoPrice) {
+    PriceAggregator aggregator;
+    CHECK(!aggregator.aggregate());
+    CHECK(!aggregator.add(price("0"), 0, false, 0));
+    CHECK(!aggregator.aggregate());
+}
+
+TEST(singleQuoteIsTaken) {
+    PriceAggregator aggregator;
+    aggregator.add(price("0.07131"), 0, false, 1);
+    CHECK(aggregator.aggregate());
+    CHECK_EQ(aggregator.getSource(), 1);
+    CHECK(!aggregator.hasChange());
+}
+
+TEST(twoAgreeingPreferFirst) {
+    PriceAggregator aggregator;
+    aggregator.add(price("0.07131"), 0, false, 1);
+    aggregator.add(price("0.07123"), -0.0211f, true, 0);
+    CHECK(aggregator.aggregate());
+    CHECK_EQ(aggregator.getSource(), 0);
+    CHECK_EQ(aggregator.getOutlierCount(), 0);
+    CHECK(aggregator.getChange() == -0.0211f);
+}
+
+TEST(twoDisagreeingRejectBoth) {
+    for (int order = 0; order < 2; order++) {
+        PriceAggregator aggregator;
+        aggregator.add(price(order == 0 ? "0.07123" : "0.08131"), 0, true, 0);
+        aggregator.add(price(order == 0 ? "0.08131" : "0.07123"), 0, false, 1);
+        CHECK(!aggregator.aggregate());
+        CHECK(aggregator.isOutlier(0));
+        CHECK(aggregator.isOutlier(1));
+        CHECK(!aggregator.hasChange());
+    }
+}
+
+TEST(thirdSourceOutvotesOutlier) {
+    // Whichever source is wrong, the other two win
+    const char* prices[3] = {"0.07123", "0.07131", "0.07127"};
+    for (int wrong = 0; wrong < 3; wrong++) {
+        PriceAggregator aggregator;
+        for (int i = 0; i < 3; i++) {
+            aggregator.add(price(i == wrong ? "0.08131" : prices[i]), 0.01f * (i + 1), true, i);
+        }
+        CHECK(aggregator.aggregate());
+        CHECK_EQ(aggregator.getOutlierCount(), 1);
+        CHECK(aggregator.isOutlier(wrong));
+        CHECK(aggregator.getSource() != wrong);
+        // Change from the preferred source that kept its quote
+        CHECK(aggregator.getChange() == (wrong == 0 ? 0.02f : 0.01f));
+    }
+}
+
+TEST(threeAgreeingTakeMedian) {
+    PriceAggregator aggregator;
+    aggregator.add(price("0.07123"), 0, false, 0);
+    aggregator.add(price("0.07131"), 0, false, 1);
+    aggregator.add(price("0.07127"), 0, false, 2);
+    CHECK(aggregator.aggregate());
+    CHECK_EQ(aggregator.getSource(), 2);
+    CHECK(aggregator.getPrice() == price("0.07127"));
+}
+
+TEST(changeSkipsSourcesWithout) {
+    PriceAggregator aggregator;
+    aggregator.add(price("0.07123"), 0, false, 0);
+    aggregator.add(price("0.07131"), 0, false, 1);
+    aggregator.add(price("0.07127"), -0.0195f, true, 2);
+    CHECK(aggregator.aggregate());
+    CHECK(aggregator.hasChange());
+    CHECK(aggregator.getChange() == -0.0195f);
+}
+
+TEST(resetClearsQuotes) {
+    PriceAggregator aggregator;
+    for (int i = 0; i < AGG_MAX_QUOTES; i++) {
+        CHECK(aggregator.add(price("0.07123"), 0, false, i));
+    }
+    CHECK(!aggregator.add(price("0.07123"), 0, false, AGG_MAX_QUOTES));
+    aggregator.reset();
+    CHECK_EQ(aggregator.getCount(), 0);
+    CHECK(!aggregator.aggregate());
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,106 @@
+// Price parse and format cost against the String path it replaced:
+// the text copied into a String, checked with toFloat(), then cut with
+// substring(0, 11) or cast to int for JPY. std::string and strtof stand
+// in for String and toFloat(). The host has an FPU, so the float side
+// is cheaper here than on the ESP8266; `bench` on the device has the
+// numbers that count. Short texts stay inside std::string, as they do
+// inside String up to 11 characters, so the difference is in time.
+
+#include "host_test.h"
+#include "alloc_counter.h"
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include "price.h"
+
+#define BENCH_RUNS 200000
+
+static const char* const samples[] = {"0.07123", "67012.35", "0.000012345678", "3521.9", "15234567.5"};
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+static volatile size_t sink;
+
+struct BenchResult {
+    double allocations;
+    double nanoseconds;
+};
+
+template <typename Body>
+static BenchResult run(const char* name, Body body) {
+    unsigned long before = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_RUNS; i++) body(samples[i % SAMPLE_COUNT]);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    BenchResult result;
+    result.allocations = (double)(allocationCount() - before) / BENCH_RUNS;
+    result.nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_RUNS;
+    printf("{\"case\":\"%s\",\"allocs\":%.2f,\"ns\":%.1f}\n", name, result.allocations, result.nanoseconds);
+    return result;
+}
+
+TEST(parse) {
+    BenchResult fixed = run("price_parse", [](const char* text) {
+        Price price;
+        sink = price.parse(text) ? (size_t)price.mantissa : 0;
+    });
+    run("string_tofloat", [](const char* text) {
+        std::string price = text;
+        sink = strtof(price.c_str(), nullptr) > 0 ? price.size() : 0;
+    });
+    CHECK(fixed.allocations == 0);
+}
+
+TEST(format) {
+    Price prices[SAMPLE_COUNT];
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) prices[i].parse(samples[i]);
+
+    size_t next = 0;
+    BenchResult fixed = run("price_format", [&](const char*) {
+        char text[16];
+        sink = prices[next++ % SAMPLE_COUNT].format(text, sizeof(text), 8, 11);
+    });
+    BenchResult fixedJpy = run("price_format_jpy", [&](const char*) {
+        char text[16];
+        sink = prices[next++ % SAMPLE_COUNT].format(text, sizeof(text), 0, 11);
+    });
+    run("string_substring", [](const char* text) {
+        std::string price = text;
+        sink = price.substr(0, 11).size();
+    });
+    run("string_jpy_cast", [](const char* text) {
+        std::string price = text;
+        sink = std::to_string((int)strtof(price.c_str(), nullptr)).size();
+    });
+    CHECK(fixed.allocations == 0);
+    CHECK(fixedJpy.allocations == 0);
+}
+
+// What the benchmark formats, so a faster but wrong routine can't pass
+TEST(formatResults) {
+    const char* expected[SAMPLE_COUNT][2] = {
+        {"0.07123", "0"},
+        {"67012.35", "67012"},
+        {"0.00001235", "0"},
+        {"3521.9", "3522"},
+        {"15234567.5", "15234568"},
+    };
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        Price price;
+        CHECK(price.parse(samples[i]));
+        char text[16];
+        price.format(text, sizeof(text), 8, 11);
+        CHECK_STR(text, expected[i][0]);
+        price.format(text, sizeof(text), 0, 11);
+        CHECK_STR(text, expected[i][1]);
+    }
+
+    // The float path loses the low digits the fixed-point one keeps
+    Price precise;
+    precise.parse("15234567.53");
+    char text[16];
+    precise.format(text, sizeof(text), 8, 11);
+    CHECK_STR(text, "15234567.53");
+    CHECK(strtof("15234567.53", nullptr) != 15234567.53);
+}
+
+HOST_TEST_MAIN()
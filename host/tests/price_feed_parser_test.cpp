@@ -0,0 +1,138 @@
+// PriceFeedParser on feed bodies split at every position, with records
+// past FEED_RECORD_SIZE.
+
+#include "host_test.h"
+#include "alloc_counter.h"
+#include <Arduino.h>
+#include "price_feed_parser.h"
+
+static const char* feedBody =
+    "[{\"pair\":\"BTCUSD\",\"price\":\"67012.35\",\"percentChange24h\":\"0.0154\"},"
+    "{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\"},"
+    "{\"pair\":\"ETHUSD\",\"price\":\"3521.9\",\"percentChange24h\":\"0.0032\"},"
+    "{\"pair\":\"LTCUSD\",\"price\":\"84.17\",\"percentChange24h\":\"-0.0005\"}]";
+
+static int records = 0;
+static char lastPair[FEED_PAIR_SIZE];
+
+static void onRecord(const char* pair, const Price&, float) {
+    records++;
+    snprintf(lastPair, sizeof(lastPair), "%s", pair);
+}
+
+static void feedSplit(PriceFeedParser& parser, const std::string& body, size_t split) {
+    parser.feed(body.data(), split);
+    parser.feed(body.data() + split, body.size() - split);
+}
+
+static bool isDoge(const PriceFeedParser& parser) {
+    char text[16];
+    parser.getPrice().format(text, sizeof(text), 8, sizeof(text));
+    return parser.found() && strcmp(text, "0.07123") == 0 && fabsf(parser.getChange() + 0.0211f) < 1e-6f;
+}
+
+TEST(findsPairAtEverySplit) {
+    std::string body = feedBody;
+    PriceFeedParser parser;
+    for (size_t split = 0; split <= body.size(); split++) {
+        parser.begin("DOGEUSD");
+        feedSplit(parser, body, split);
+        if (!isDoge(parser)) {
+            printf("  split at %zu\n", split);
+            CHECK(false);
+            return;
+        }
+    }
+}
+
+TEST(pairMatchIgnoresCase) {
+    PriceFeedParser parser;
+    parser.begin("dogeusd");
+    parser.feed(feedBody, strlen(feedBody));
+    CHECK(isDoge(parser));
+}
+
+TEST(missingPair) {
+    PriceFeedParser parser;
+    parser.begin("XRPUSD");
+    parser.feed(feedBody, strlen(feedBody));
+    CHECK(!parser.found());
+    CHECK(!parser.error());
+}
+
+TEST(batchReportsEveryRecord) {
+    std::string body = feedBody;
+    PriceFeedParser parser;
+    for (size_t split = 0; split <= body.size(); split += 7) {
+        records = 0;
+        parser.begin("DOGEUSD", onRecord);
+        feedSplit(parser, body, split);
+        CHECK_EQ(records, 4);
+        CHECK_STR(lastPair, "LTCUSD");
+        CHECK(isDoge(parser));
+    }
+}
+
+TEST(bracesInsideStrings) {
+    std::string body = "[{\"pair\":\"X}{Y\",\"price\":\"1\",\"percentChange24h\":\"0\"},"
+                       "{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\"}]";
+    PriceFeedParser parser;
+    records = 0;
+    parser.begin("DOGEUSD", onRecord);
+    parser.feed(body.data(), body.size());
+    CHECK_EQ(records, 2);
+    CHECK(isDoge(parser));
+}
+
+TEST(oversizedRecordsSkipped) {
+    // Just over the buffer, far over it, then a record that fits
+    std::string justOver = "{\"pair\":\"AAAUSD\",\"price\":\"1\",\"note\":\"";
+    justOver += std::string(FEED_RECORD_SIZE - justOver.size() - 1, 'n') + "\"}";
+    CHECK_EQ(justOver.size(), FEED_RECORD_SIZE + 1);
+    std::string farOver = "{\"pair\":\"BBBUSD\",\"price\":\"2\",\"note\":\"" + std::string(1000, 'n') + "\"}";
+    std::string body = "[" + justOver + "," + farOver + "," +
+                       "{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\"}]";
+
+    PriceFeedParser parser;
+    for (size_t split : {(size_t)1, justOver.size(), body.size() / 2, body.size() - 3}) {
+        records = 0;
+        parser.begin("DOGEUSD", onRecord);
+        feedSplit(parser, body, split);
+        CHECK_EQ(parser.getSkippedCount(), 2);
+        CHECK_EQ(records, 1);
+        CHECK(isDoge(parser));
+    }
+}
+
+TEST(recordAtLimitKept) {
+    std::string record = "{\"pair\":\"DOGEUSD\",\"price\":\"0.07123\",\"percentChange24h\":\"-0.0211\",\"x\":\"";
+    record += std::string(FEED_RECORD_SIZE - record.size() - 2, 'x') + "\"}";
+    CHECK_EQ(record.size(), FEED_RECORD_SIZE);
+    PriceFeedParser parser;
+    parser.begin("DOGEUSD");
+    parser.feed(record.data(), record.size());
+    CHECK_EQ(parser.getSkippedCount(), 0);
+    CHECK(isDoge(parser));
+}
+
+TEST(skippedCountResetsOnBegin) {
+    std::string body = "[{\"pair\":\"" + std::string(200, 'z') + "\"}]";
+    PriceFeedParser parser;
+    parser.begin("DOGEUSD");
+    parser.feed(body.data(), body.size());
+    CHECK_EQ(parser.getSkippedCount(), 1);
+    parser.begin("DOGEUSD");
+    CHECK_EQ(parser.getSkippedCount(), 0);
+}
+
+TEST(feedDoesNotAllocate) {
+    PriceFeedParser parser;
+    unsigned long before = allocationCount();
+    for (int i = 0; i < 100; i++) {
+        parser.begin("DOGEUSD", onRecord);
+        parser.feed(feedBody, strlen(feedBody));
+    }
+    CHECK_EQ(allocationCount() - before, 0);
+}
+
+HOST_TEST_MAIN()
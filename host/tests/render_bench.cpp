@@ -0,0 +1,123 @@
+// Render cost on the host: SparklinePlot drawing a new sample against a
+// plot recomputed from scratch, FrameFlusher sending a price tick
+// against a full frame, and DisplayHandler's price screen and coin
+// splash. bytes is what went over the mock I2C bus, whose log also
+// accounts for the allocations of the flush cases. Text is drawn with
+// the stand-in GFX's placeholder glyphs, so the text part of a redraw
+// is cheaper here than with the real fonts; `bench` on the device has
+// the numbers that count.
+
+#include "host_test.h"
+#include "host_bench.h"
+#include <Arduino.h>
+#include "display_handler.h"
+
+#define SAMPLE_MS SPARKLINE_MIN_SPACING
+
+static Price priceOf(int64_t mantissa) {
+    Price price;
+    price.mantissa = mantissa;
+    price.scale = 5;
+    return price;
+}
+
+// A period of the ring's length, so the window always holds one whole
+// cycle and the extremes drop out once per cycle each
+static int64_t wave(int i) {
+    return 7000000 + ((i * 37) % SPARKLINE_CAPACITY) * 10;
+}
+
+TEST(sparklinePlot) {
+    Adafruit_SSD1306 panel(128, 32, &Wire, -1);
+    SparklineBuffer buffer;
+    unsigned long now = 0;
+    for (int i = 0; i < SPARKLINE_CAPACITY; i++) {
+        buffer.add(priceOf(wave(i)), now);
+        now += SAMPLE_MS;
+    }
+
+    SparklinePlot kept;
+    BenchStats append = benchRun("sparkline_append", 1, [&](int run) -> size_t {
+        buffer.add(priceOf(wave(SPARKLINE_CAPACITY + run)), now);
+        now += SAMPLE_MS;
+        kept.draw(&panel, &buffer, 0, 9, 128, 23);
+        return buffer.size();
+    });
+    BenchStats full = benchRun("sparkline_recompute", 1, [&](int run) -> size_t {
+        SparklinePlot scratch;
+        scratch.draw(&panel, &buffer, 0, 9, 128, 23);
+        return buffer.size();
+    });
+
+    // Timings are printed, not checked, so a busy machine can't fail it
+    CHECK(append.allocations == 0);
+    CHECK(full.allocations == 0);
+}
+
+// Stand-in for the last digits of the price changing
+static void drawTick(Adafruit_SSD1306& panel, int run) {
+    panel.fillRect(80, 4, 30, 14, BLACK);
+    panel.setCursor(80, 4);
+    panel.setTextSize(1);
+    panel.print(run % 100);
+}
+
+TEST(frameFlush) {
+    Adafruit_SSD1306 panel(128, 32, &Wire, -1);
+    FrameFlusher flusher(&panel, &Wire, DISPLAY_I2C_ADDR);
+    panel.setTextColor(SSD1306_WHITE);
+    panel.setCursor(0, 4);
+    panel.print("$0.07123");
+    flusher.flush();
+
+    BenchStats tick = benchRun("frame_flush_tick", 1, [&](int run) -> size_t {
+        Wire.clear();
+        drawTick(panel, run);
+        flusher.flush();
+        return Wire.busBytes();
+    });
+    BenchStats full = benchRun("frame_flush_full", 1, [&](int run) -> size_t {
+        Wire.clear();
+        flusher.invalidate();
+        flusher.flush();
+        return Wire.busBytes();
+    });
+    CHECK(tick.bytes < full.bytes / 4);
+}
+
+TEST(displayScreens) {
+    Adafruit_SSD1306 panel(128, 32, &Wire, -1);
+    DisplayHandler display(&panel);
+    display.begin();
+
+    // Alternating pairs redraw the whole screen; a tick of one pair
+    // would start the roll animation instead
+    Price btc, doge;
+    btc.parse("29012.55");
+    doge.parse("0.07123");
+    benchRun("update_price", 1, [&](int run) -> size_t {
+        Wire.clear();
+        if (run % 2 == 0) display.updatePrice("BTC", "USD", btc, 0.02f);
+        else display.updatePrice("DOGE", "USD", doge, -0.01f);
+        return Wire.busBytes();
+    });
+
+    SparklineBuffer history;
+    for (int i = 0; i < SPARKLINE_CAPACITY; i++) history.add(priceOf(wave(i)), i * SAMPLE_MS);
+    benchRun("show_chart", 1, [&](int run) -> size_t {
+        Wire.clear();
+        display.showChart(run % 2 == 0 ? "BTC" : "DOGE", "USD", run % 2 == 0 ? btc : doge, &history);
+        return Wire.busBytes();
+    });
+
+    // The same logo again redraws the frame but sends nothing, another
+    // one would start a fade
+    BenchStats splash = benchRun("coin_splash", 1, [&](int run) -> size_t {
+        Wire.clear();
+        display.showCoinSplash("DOGE");
+        return Wire.busBytes();
+    });
+    CHECK_EQ(splash.bytes, 0);
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,133 @@
+// The whole sketch on the host stubs: setup(), then loop() passes until
+// the first price is on screen, with the canned price servers behind
+// the Wi-Fi stand-in. The cases run in order on the one booted sketch,
+// since its globals are built once per process.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+// Defined further down the sketch than their first use; the Arduino
+// builder adds these prototypes itself
+void pushStats(bool withTelemetry);
+bool showCachedPrice();
+void redrawPrice();
+
+#include "Dogecoin-Ticker.ino"
+
+#define HANDSHAKE_MS 300
+#define LATENCY_MS 800
+#define BOOT_LIMIT_MS 20000
+#define START_TIME 1700000000UL
+
+static HostServer& serve(const char* host, const char* response) {
+    HostServer& server = hostServers()[host];
+    server.handshakeMs = HANDSHAKE_MS;
+    server.latencyMs = LATENCY_MS;
+    server.response = loadResponse(response);
+    return server;
+}
+
+// Loop passes until the condition holds or the time is up
+template <typename Done>
+static unsigned long runLoop(Done done, unsigned long limitMs) {
+    unsigned long passes = 0;
+    unsigned long start = millis();
+    while (!done() && millis() - start < limitMs) {
+        loop();
+        delay(1);
+        passes++;
+    }
+    return passes;
+}
+
+static unsigned long litPixels() {
+    unsigned long lit = 0;
+    const uint8_t* buffer = display.getBuffer();
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT / 8; i++) lit += __builtin_popcount(buffer[i]);
+    return lit;
+}
+
+static const AsyncWebServerResponse* get(AsyncWebServerRequest& request) {
+    server.hostRequest(request);
+    return request.hostResponse();
+}
+
+TEST(bootsToFirstPrice) {
+    hostServers().clear();
+    HostHeap::freeBytes() = 40000;
+    serve("api.gemini.com", "gemini_pricefeed.http");
+    serve("api.coinbase.com", "coinbase_spot.http");
+    serve("www.bitstamp.net", "bitstamp_ticker.http");
+    HostClock::set(0);
+    HostClock::epoch() = START_TIME;
+    HostFs::format();
+
+    setup();
+    CHECK(server.started);
+    CHECK(tickerState.get().bootSplash);
+
+    unsigned long passes = runLoop([] { return firstPriceAt != 0; }, BOOT_LIMIT_MS);
+    printf("  first price after %lu ms, %lu loop passes, Wi-Fi up at %lu ms\n",
+           firstPriceAt, passes, wifiHandler.getConnectedAt());
+    CHECK(firstPriceAt != 0);
+    CHECK(!tickerState.get().bootSplash);
+    CHECK(!wifiHandler.wasFastJoin());
+    CHECK(litPixels() > 0);
+
+    // Kept for the next boot
+    CHECK(bootStore.has(BOOT_HAS_WIFI));
+    CHECK(bootStore.has(BOOT_HAS_PRICE));
+
+    // The batch feed filled the other pairs too
+    Price price;
+    float change;
+    unsigned long age;
+    CHECK(priceTable.peek(coinByName("BTC"), fiatByName("USD"), price, change, age));
+}
+
+TEST(servesTelemetry) {
+    AsyncWebServerRequest request(HTTP_GET, "/telemetry");
+    const AsyncWebServerResponse* response = get(request);
+    CHECK(response != nullptr);
+    if (response == nullptr) return;
+    CHECK_EQ(response->code, 200);
+    CHECK(response->body.size() > 2 && response->body[0] == '{');
+}
+
+TEST(servesHistory) {
+    // Samples reach the file on the next flush
+    runLoop([] { return historyStore.getPendingCount() == 0; }, HISTORY_FLUSH_INTERVAL + 1000);
+
+    AsyncWebServerRequest request(HTTP_GET, "/history?crypto=DOGE&fiat=USD");
+    const AsyncWebServerResponse* response = get(request);
+    CHECK(response != nullptr);
+    if (response == nullptr) return;
+    CHECK_EQ(response->code, 200);
+    CHECK(response->fillerCalls > 0);
+    CHECK(response->body.size() > 2 && response->body.front() == '[' && response->body.back() == ']');
+    CHECK(response->body.find("\"") != std::string::npos);
+
+    AsyncWebServerRequest unknown(HTTP_GET, "/history?crypto=XYZ");
+    CHECK_EQ(get(unknown)->code, 404);
+    AsyncWebServerRequest bad(HTTP_GET, "/history?from=yesterday");
+    CHECK_EQ(get(bad)->code, 400);
+}
+
+TEST(websocketGetsBinaryFrames) {
+    AsyncWebSocket* socket = server.hostSocket("/ws");
+    CHECK(socket != nullptr);
+    if (socket == nullptr) return;
+
+    AsyncWebSocketClient* client = socket->hostConnect();
+    socket->hostReceive(client, WS_HELLO_TEXT, strlen(WS_HELLO_TEXT), false);
+    runLoop([client] { return !client->sent.empty(); }, 1000);
+    CHECK(!client->sent.empty());
+    CHECK(webSocketHandler.hasBinaryClients());
+    for (const HostWsFrame& frame : client->sent) CHECK(frame.binary);
+
+    socket->hostDisconnect(client);
+    CHECK(!webSocketHandler.hasClients());
+}
+
+HOST_TEST_MAIN()
@@ -0,0 +1,178 @@
+// SparklineBuffer's ring and quantization, and SparklinePlot's
+// incremental redraw checked against a plot computed from scratch after
+// every sample: through the ring wrapping, an extreme dropping out of
+// the window and a flat series.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "sparkline.h"
+
+#define PLOT_X 0
+#define PLOT_Y 0
+#define PLOT_W 128
+#define PLOT_H 32
+#define SAMPLE_MS SPARKLINE_MIN_SPACING
+
+static Price priceOf(int64_t mantissa, uint8_t scale = 5) {
+    Price price;
+    price.mantissa = mantissa;
+    price.scale = scale;
+    return price;
+}
+
+// Draws with the plot kept across samples and with a fresh one, and
+// checks they agree
+struct PlotPair {
+    Adafruit_SSD1306 kept{PLOT_W, PLOT_H, &Wire, -1};
+    Adafruit_SSD1306 fresh{PLOT_W, PLOT_H, &Wire, -1};
+    SparklinePlot plot;
+    int mismatches = 0;
+
+    void draw(const SparklineBuffer& buffer) {
+        kept.clearDisplay();
+        plot.draw(&kept, &buffer, PLOT_X, PLOT_Y, PLOT_W, PLOT_H);
+        fresh.clearDisplay();
+        SparklinePlot scratch;
+        scratch.draw(&fresh, &buffer, PLOT_X, PLOT_Y, PLOT_W, PLOT_H);
+        if (memcmp(kept.getBuffer(), fresh.getBuffer(), PLOT_W * PLOT_H / 8) != 0) mismatches++;
+    }
+};
+
+static bool lit(Adafruit_SSD1306& display, int x, int y) {
+    return (display.getBuffer()[x + (y / 8) * PLOT_W] >> (y & 7)) & 1;
+}
+
+// Topmost lit row in column x, PLOT_H if none
+static int topIn(Adafruit_SSD1306& display, int x) {
+    for (int y = 0; y < PLOT_H; y++) {
+        if (lit(display, x, y)) return y;
+    }
+    return PLOT_H;
+}
+
+static bool rowLit(Adafruit_SSD1306& display, int y) {
+    for (int x = 0; x < PLOT_W; x++) {
+        if (lit(display, x, y)) return true;
+    }
+    return false;
+}
+
+TEST(ringWrapsAround) {
+    SparklineBuffer buffer;
+    unsigned long now = 0;
+    for (int i = 0; i < SPARKLINE_CAPACITY + 10; i++) {
+        CHECK(buffer.add(priceOf(7000000 + i), now));
+        now += SAMPLE_MS;
+    }
+    CHECK_EQ(buffer.size(), SPARKLINE_CAPACITY);
+    CHECK_EQ(buffer.at(0), 10);
+    CHECK_EQ(buffer.at(SPARKLINE_CAPACITY - 1), SPARKLINE_CAPACITY + 9);
+    for (int i = 1; i < buffer.size(); i++) CHECK_EQ(buffer.at(i) - buffer.at(i - 1), 1);
+}
+
+TEST(closeSamplesAreIgnored) {
+    SparklineBuffer buffer;
+    CHECK(buffer.add(priceOf(7000000), 0));
+    CHECK(!buffer.add(priceOf(7000100), SAMPLE_MS - 1));
+    CHECK(buffer.add(priceOf(7000100), SAMPLE_MS));
+    CHECK_EQ(buffer.size(), 2);
+    CHECK_EQ(buffer.getVersion(), 2);
+}
+
+TEST(wideSwingsRequantize) {
+    SparklineBuffer buffer;
+    buffer.add(priceOf(7000000), 0);
+    buffer.add(priceOf(7000000 + 100000), SAMPLE_MS);
+    CHECK(buffer.getShiftVersion() > 0);
+    // Halved until it fits, order kept
+    CHECK(buffer.at(1) > INT16_MAX / 2);
+    CHECK(buffer.at(0) == 0);
+
+    // A price at another scale lands on the same axis
+    buffer.add(priceOf(700000, 4), 2 * SAMPLE_MS);
+    CHECK_EQ(buffer.at(2), 0);
+}
+
+TEST(incrementalMatchesFullThroughWrap) {
+    SparklineBuffer buffer;
+    PlotPair plots;
+    unsigned long now = 0;
+    for (int i = 0; i < 3 * SPARKLINE_CAPACITY; i++) {
+        buffer.add(priceOf(7000000 + (i * 37) % 101), now);
+        plots.draw(buffer);
+        now += SAMPLE_MS;
+    }
+    CHECK_EQ(plots.mismatches, 0);
+}
+
+TEST(rangeShrinksWhenExtremeDropsOut) {
+    SparklineBuffer buffer;
+    PlotPair plots;
+    unsigned long now = 0;
+
+    // A spike first, then a gentle ramp
+    buffer.add(priceOf(7010000), now);
+    for (int i = 1; i < SPARKLINE_CAPACITY; i++) {
+        now += SAMPLE_MS;
+        buffer.add(priceOf(7000000 + i * 10), now);
+        plots.draw(buffer);
+    }
+    // The ramp is squeezed into the bottom rows under the spike
+    CHECK_EQ(topIn(plots.kept, 0), 0);
+    CHECK(topIn(plots.kept, PLOT_W - 1) >= PLOT_H - 3);
+
+    // The spike falls out of the window, the ramp takes the full height
+    now += SAMPLE_MS;
+    buffer.add(priceOf(7000000 + SPARKLINE_CAPACITY * 10), now);
+    plots.draw(buffer);
+    CHECK_EQ(topIn(plots.kept, PLOT_W - 1), 0);
+    CHECK(lit(plots.kept, 0, PLOT_H - 1));
+    CHECK_EQ(plots.mismatches, 0);
+
+    // Same when the low end drops out
+    SparklineBuffer dip;
+    PlotPair dipPlots;
+    now = 0;
+    dip.add(priceOf(6990000), now);
+    for (int i = 1; i <= SPARKLINE_CAPACITY; i++) {
+        now += SAMPLE_MS;
+        dip.add(priceOf(7000000 + i * 10), now);
+        dipPlots.draw(dip);
+    }
+    CHECK_EQ(topIn(dipPlots.kept, PLOT_W - 1), 0);
+    CHECK(lit(dipPlots.kept, 0, PLOT_H - 1));
+    CHECK_EQ(dipPlots.mismatches, 0);
+}
+
+TEST(flatSeriesIsCentred) {
+    SparklineBuffer buffer;
+    PlotPair plots;
+    unsigned long now = 0;
+    for (int i = 0; i < SPARKLINE_CAPACITY + 5; i++) {
+        buffer.add(priceOf(7000000), now);
+        plots.draw(buffer);
+        now += SAMPLE_MS;
+    }
+    CHECK_EQ(plots.mismatches, 0);
+    for (int y = 0; y < PLOT_H; y++) {
+        for (int x = 0; x < PLOT_W; x++) CHECK_EQ(lit(plots.kept, x, y), y == PLOT_H / 2);
+    }
+
+    // Leaving the flat line rescales from the middle to the edges
+    buffer.add(priceOf(7000500), now);
+    plots.draw(buffer);
+    CHECK(lit(plots.kept, PLOT_W - 1, 0));
+    CHECK(lit(plots.kept, 0, PLOT_H - 1));
+    CHECK_EQ(plots.mismatches, 0);
+}
+
+TEST(fewerThanTwoSamplesDrawNothing) {
+    SparklineBuffer buffer;
+    PlotPair plots;
+    plots.draw(buffer);
+    buffer.add(priceOf(7000000), 0);
+    plots.draw(buffer);
+    for (int y = 0; y < PLOT_H; y++) CHECK(!rowLit(plots.kept, y));
+}
+
+HOST_TEST_MAIN()
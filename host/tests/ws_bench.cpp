@@ -0,0 +1,110 @@
+// Websocket messages on the host, each JSON message against its binary
+// counterpart from ws_protocol.h: the pair, the price, the stats a
+// client is sent and the pair a client asks for. bytes is the frame's
+// payload size.
+
+#include "host_test.h"
+#include "host_bench.h"
+#include <Arduino.h>
+#include "websocket_handler.h"
+
+#define CHANGED_COUNTERS 4
+
+static const char* ageLabel(int bucket) {
+    static const char* const labels[] = {"<1s", "<5s", "<30s", "<2m", "old"};
+    return labels[bucket];
+}
+
+static const char CLIENT_STATE[] =
+    "{\"states\":[{\"sender\":\"client\",\"currentCurrency\":\"EUR\",\"currentCrypto\":\"BTC\"}]}";
+
+struct Handlers {
+    AsyncWebServer server{80};
+    TickerStateStore ticker{"DOGE", "USD"};
+    WebSocketHandler webSocket;
+
+    Handlers() {
+        webSocket.begin(&server, &ticker);
+        Price price;
+        price.parse("0.07123");
+        webSocket.sendPrice(price, -0.0123f, false);
+    }
+};
+
+TEST(stateAndPrice) {
+    Handlers handlers;
+    char json[WS_JSON_SIZE];
+    uint8_t frame[WS_MAX_FRAME];
+
+    BenchStats stateJson = benchRun("ws_state_json", 16, [&](int run) -> size_t {
+        return handlers.webSocket.formatStates(json, sizeof(json));
+    });
+    BenchStats stateBinary = benchRun("ws_state_binary", 16, [&](int run) -> size_t {
+        return WsProtocol::encodeState(frame, sizeof(frame), handlers.ticker.get());
+    });
+    CHECK(stateBinary.bytes < stateJson.bytes / 4);
+    CHECK(stateBinary.allocations == 0);
+
+    Price price;
+    price.parse("0.07123");
+    BenchStats priceJson = benchRun("ws_price_json", 16, [&](int run) -> size_t {
+        return handlers.webSocket.formatPrice(json, sizeof(json));
+    });
+    BenchStats priceBinary = benchRun("ws_price_binary", 16, [&](int run) -> size_t {
+        return WsProtocol::encodePrice(frame, sizeof(frame), handlers.ticker.getVersion(), price, -123, false);
+    });
+    CHECK(priceBinary.bytes < priceJson.bytes / 4);
+    CHECK(priceBinary.allocations == 0);
+}
+
+// The JSON message carries every stat each time, the binary one only
+// the counters that changed
+TEST(stats) {
+    Handlers handlers;
+    char json[WS_STATS_JSON_SIZE];
+    uint8_t frame[WS_MAX_FRAME];
+    unsigned long ages[WS_AGE_BUCKETS] = {812, 95, 14, 3, 1};
+
+    BenchStats statsJson = benchRun("ws_stats_json", 4, [&](int run) -> size_t {
+        return handlers.webSocket.formatStats(json, sizeof(json), 12, 3480 + run, 2, 3391 + run, 101, ages,
+                                              ageLabel, WS_AGE_BUCKETS);
+    });
+
+    uint32_t values[CTR_COUNT];
+    uint32_t lastSent[CTR_COUNT];
+    for (int id = 0; id < CTR_COUNT; id++) values[id] = lastSent[id] = 1000 + id;
+    BenchStats statsBinary = benchRun("ws_counters_delta", 4, [&](int run) -> size_t {
+        for (int id = 0; id < CHANGED_COUNTERS; id++) values[id]++;
+        uint64_t mask = WsProtocol::changedCounters(values, lastSent);
+        return WsProtocol::encodeCounters(frame, sizeof(frame), values, mask);
+    });
+    CHECK_EQ(statsBinary.bytes, 2 + 5 * CHANGED_COUNTERS);
+    CHECK(statsBinary.bytes < statsJson.bytes / 4);
+    CHECK(statsBinary.allocations == 0);
+}
+
+TEST(clientPair) {
+    Handlers handlers;
+    String crypto;
+    String currency;
+    BenchStats parsed = benchRun("ws_parse_json", 4, [&](int run) -> size_t {
+        handlers.webSocket.parseClientState(CLIENT_STATE, crypto, currency);
+        return sizeof(CLIENT_STATE) - 1;
+    });
+    CHECK_STR(crypto.c_str(), "BTC");
+    CHECK_STR(currency.c_str(), "EUR");
+
+    const uint8_t setPair[] = {WS_MSG_SET_PAIR, 3, 'B', 'T', 'C', 3, 'E', 'U', 'R'};
+    char cryptoOut[STATE_SYMBOL_SIZE];
+    char fiatOut[STATE_SYMBOL_SIZE];
+    BenchStats decoded = benchRun("ws_decode_binary", 16, [&](int run) -> size_t {
+        WsProtocol::decodeSetPair(setPair, sizeof(setPair), cryptoOut, fiatOut, sizeof(cryptoOut));
+        return sizeof(setPair);
+    });
+    CHECK_STR(cryptoOut, "BTC");
+    CHECK_STR(fiatOut, "EUR");
+    CHECK(decoded.bytes < parsed.bytes / 4);
+    CHECK(decoded.allocations == 0);
+}
+
+HOST_TEST_MAIN()
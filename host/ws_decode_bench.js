@@ -0,0 +1,149 @@
+#!/usr/bin/env node
+// Websocket messages as the web page decodes them, the JSON ones against
+// the binary protocol: bytes on the wire and decode time per message.
+// Runs the real onMessage from script.js with the DOM stubbed out, and
+// checks both paths show the same price, exactly, also for mantissas a
+// Number can't hold. Frames are built the way websocket_handler.h and
+// ws_protocol.h build them; ws_bench has the device side of the same
+// messages. Exits non-zero if binary stops being smaller or a price
+// comes out wrong, so it runs under ctest.
+
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+const vm = require("vm");
+
+const SCRIPT = path.join(__dirname, "..", "LittleFS Data", "data", "script.js");
+const ROUNDS = 20000;
+
+function loadPage() {
+    const shown = { prices: [], states: 0 };
+    const element = new Proxy(function () {}, { get: () => () => element, apply: () => element });
+    const context = {
+        window: { location: { hostname: "ticker.local" }, addEventListener() {} },
+        console: { log() {} },
+        $: () => element,
+        fetch: () => new Promise(() => {}),
+        ArrayBuffer, DataView, Uint8Array, BigInt, JSON, Math, Number, String, Promise,
+    };
+    vm.createContext(context);
+    vm.runInContext(fs.readFileSync(SCRIPT, "utf8"), context, { filename: SCRIPT });
+
+    // Keep what would be drawn, the rest of the page is stubbed
+    vm.runInContext("cryptoDictionary.push('DOGE')", context);
+    context.showPrice = (value, change, stale) => shown.prices.push(value);
+    context.showState = () => shown.states++;
+    return { context, shown };
+}
+
+function frame(bytes) {
+    return new Uint8Array(bytes).buffer;
+}
+
+function u16(value) {
+    return [value & 0xff, (value >> 8) & 0xff];
+}
+
+function u32(value) {
+    return [value & 0xff, (value >>> 8) & 0xff, (value >>> 16) & 0xff, (value >>> 24) & 0xff];
+}
+
+function symbol(text) {
+    return [text.length, ...Array.from(text, c => c.charCodeAt(0))];
+}
+
+function stateJson(crypto, fiat) {
+    return `{"states":[{"sender":"esp8266","currentCurrency":"${fiat}","currentCrypto":"${crypto}"}]}`;
+}
+
+function stateBinary(version, crypto, fiat) {
+    return frame([0x01, ...u16(version), 0, ...symbol(crypto), ...symbol(fiat)]);
+}
+
+function priceJson(version, value, change) {
+    return `{"price":{"version":${version},"value":"${value}","change":${change.toFixed(4)},"stale":false}}`;
+}
+
+function priceBinary(version, mantissa, scale, change) {
+    const bytes = [0x02, ...u16(version)];
+    const raw = BigInt.asUintN(64, mantissa);
+    for (let i = 0n; i < 8n; i++) bytes.push(Number((raw >> (8n * i)) & 0xffn));
+    bytes.push(scale, ...u16(Math.round(change * 10000) & 0xffff), 0);
+    return frame(bytes);
+}
+
+function statsJson(run) {
+    return `{"apiStats":{"handshakes":12,"reused":${3480 + run},"reconnects":2},` +
+        `"cacheStats":{"hits":${3391 + run},"misses":101,"ages":{"<30s":812,"<1m":95,"<2m":14,"<5m":3,">5m":1}},` +
+        `"wsStats":{"clients":1,"queued":0,"maxQueued":2,"coalesced":7,"dropped":0,"refused":0}}`;
+}
+
+// After the snapshot only what changed is sent, hits and a few others
+function countersBinary(ids, run) {
+    const bytes = [0x03, ids.length];
+    for (const id of ids) bytes.push(id, ...u32(1000 + id + run));
+    return frame(bytes);
+}
+
+function size(message) {
+    return typeof message === "string" ? Buffer.byteLength(message) : message.byteLength;
+}
+
+function time(page, messages) {
+    const start = process.hrtime.bigint();
+    for (let round = 0; round < ROUNDS; round++) {
+        for (const message of messages) page.context.onMessage({ data: message });
+    }
+    return Number(process.hrtime.bigint() - start) / ROUNDS / messages.length;
+}
+
+function report(name, messages, ns) {
+    const bytes = messages.reduce((total, message) => total + size(message), 0);
+    console.log(JSON.stringify({ bench: name, messages: messages.length, bytes, ns_per_message: Math.round(ns) }));
+    return bytes;
+}
+
+let failed = false;
+function check(ok, what) {
+    if (!ok) {
+        console.log("FAILED: " + what);
+        failed = true;
+    }
+}
+
+// One price update with the stats that go with it, as a client gets it
+// after connecting
+const jsonSession = [stateJson("DOGE", "USD"), priceJson(3, "0.07123", -0.0123), statsJson(1)];
+const binarySession = [
+    frame([0x00, 1]),
+    stateBinary(3, "DOGE", "USD"),
+    priceBinary(3, 7123n, 5, -0.0123),
+    countersBinary([16, 17, 18, 56], 1),
+];
+
+const jsonPage = loadPage();
+const jsonBytes = report("ws_decode_json", jsonSession, time(jsonPage, jsonSession));
+const binaryPage = loadPage();
+const binaryBytes = report("ws_decode_binary", binarySession, time(binaryPage, binarySession));
+check(binaryBytes * 3 < jsonBytes, "binary session not a third of the JSON one");
+check(jsonPage.shown.prices[0] === "0.07123" && binaryPage.shown.prices[0] === "0.07123",
+      "prices differ: " + jsonPage.shown.prices[0] + " " + binaryPage.shown.prices[0]);
+check(binaryPage.shown.states > 0, "binary state not shown");
+
+// Mantissas a Number rounds, and negative and whole ones
+const exact = loadPage();
+exact.context.onMessage({ data: frame([0x00, 1]) });
+const cases = [
+    [9007199254740993n, 8, "90071992.54740993"],
+    [-123456789012345678n, 10, "-12345678.9012345678"],
+    [5n, 6, "0.000005"],
+    [42n, 0, "42"],
+];
+for (const [mantissa, scale, expected] of cases) {
+    exact.context.onMessage({ data: priceBinary(1, mantissa, scale, 0) });
+    const shown = exact.shown.prices[exact.shown.prices.length - 1];
+    check(shown === expected, `${mantissa}e-${scale} shown as ${shown}, expected ${expected}`);
+}
+
+process.exit(failed ? 1 : 0);